@@ -0,0 +1,123 @@
+#ifndef HASH_HASH_FILE_HPP
+#define HASH_HASH_FILE_HPP
+
+/**
+ * @file HashFile.hpp
+ *
+ * This module declares the functions used to compute message digests of
+ * files, reading them in pieces so that memory use doesn't grow with the
+ * size of the file.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HmacContext.hpp"
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Hash {
+
+    /**
+     * This function reads the whole contents of the given file, giving
+     * them in order to the given function, one piece at a time.
+     *
+     * Regular files are mapped into memory a window at a time, with the
+     * operating system told they will be read sequentially, so that the
+     * pieces are given straight from the page cache, without copying.
+     * Other files, such as pipes and devices, or any file on platforms
+     * without memory mapping, are read into two fixed-size buffers by a
+     * separate thread, so that one buffer is filled while the other is
+     * given to the function.
+     *
+     * The size of a regular file is checked again before each window is
+     * mapped, and if the file has been truncated, reading stops and false
+     * is returned.  However, the file must not be truncated while the
+     * function is being given a mapped window of it, since touching a
+     * mapped page past the end of a file raises SIGBUS.  Files which may
+     * be truncated in place while they're read (such as logs rotated by
+     * truncation) should be hashed from a copy.
+     *
+     * If the function throws an exception, reading stops, the file is
+     * closed, and the exception is passed on.
+     *
+     * @param[in] path
+     *     This is the path of the file to read.
+     *
+     * @param[in] consumer
+     *     This is the function to call with each piece of the file.
+     *
+     * @return
+     *     An indication of whether or not the whole file was read
+     *     successfully is returned.
+     */
+    bool ReadFileInPieces(
+        const std::string& path,
+        const std::function< void(const uint8_t* data, size_t length) >& consumer
+    );
+
+    /**
+     * This function computes the message digest of the contents of the
+     * given file, using the hash function computed by the given context
+     * class (for example, Hash::Sha256Context), storing it in the given
+     * buffer.  The file is read with ReadFileInPieces, so it's never held
+     * in memory all at once.
+     *
+     * @param[in] path
+     *     This is the path of the file to hash.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for HashContextTraits< HashContext >::digestSize bytes.
+     *
+     * @return
+     *     An indication of whether or not the whole file was read, and
+     *     the digest stored, successfully is returned.
+     */
+    template< typename HashContext > bool HashFile(
+        const std::string& path,
+        uint8_t* digest
+    ) {
+        HashContext context;
+        const auto success = ReadFileInPieces(
+            path,
+            [&context](const uint8_t* data, size_t length) {
+                context.Update(data, length);
+            }
+        );
+        if (!success) {
+            return false;
+        }
+        context.Final(digest);
+        return true;
+    }
+
+    /**
+     * This function computes the message digest of the contents of the
+     * given file, using the hash function computed by the given context
+     * class (for example, Hash::Sha256Context).  The file is read with
+     * ReadFileInPieces, so it's never held in memory all at once.
+     *
+     * @param[in] path
+     *     This is the path of the file to hash.
+     *
+     * @return
+     *     The message digest is returned as a vector of bytes, or an
+     *     empty vector if the file couldn't be read.
+     */
+    template< typename HashContext > std::vector< uint8_t > HashFile(
+        const std::string& path
+    ) {
+        std::vector< uint8_t > digest(HashContextTraits< HashContext >::digestSize);
+        if (!HashFile< HashContext >(path, digest.data())) {
+            digest.clear();
+        }
+        return digest;
+    }
+
+}
+
+#endif /* HASH_HASH_FILE_HPP */
@@ -0,0 +1,106 @@
+#ifndef HASH_HEX_HPP
+#define HASH_HEX_HPP
+
+/**
+ * @file Hex.hpp
+ *
+ * This module declares the functions used to convert message digests and
+ * other binary data to and from strings of hexadecimal digits.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Hash {
+
+    /**
+     * This function converts the given data into lowercase hexadecimal
+     * digits, two for each byte, storing them in the given buffer.
+     *
+     * @param[in] data
+     *     This points to the data to convert.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] hex
+     *     This is where to store the hexadecimal digits.  It must have room
+     *     for length * 2 characters.  No null terminator is stored.
+     */
+    void EncodeHex(const void* data, size_t length, char* hex);
+
+    /**
+     * This function converts the given data into a string of lowercase
+     * hexadecimal digits, two for each byte.
+     *
+     * @param[in] data
+     *     This points to the data to convert.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The string of hexadecimal digits is returned.
+     */
+    std::string EncodeHex(const void* data, size_t length);
+
+    /**
+     * This function converts the given vector of bytes into a string of
+     * lowercase hexadecimal digits, two for each byte.
+     *
+     * @param[in] data
+     *     This is the data to convert.
+     *
+     * @return
+     *     The string of hexadecimal digits is returned.
+     */
+    std::string EncodeHex(const std::vector< uint8_t >& data);
+
+    /**
+     * This function converts the given hexadecimal digits into bytes,
+     * storing them in the given buffer.  Uppercase and lowercase digits
+     * are both accepted.
+     *
+     * @param[in] hex
+     *     This points to the hexadecimal digits to convert.
+     *
+     * @param[in] length
+     *     This is the number of hexadecimal digits.
+     *
+     * @param[out] data
+     *     This is where to store the converted bytes.  It must have room
+     *     for length / 2 bytes.
+     *
+     * @return
+     *     An indication of whether or not the conversion succeeded is
+     *     returned.  It fails if the number of digits is odd or any
+     *     character is not a hexadecimal digit, in which case the contents
+     *     of the buffer are unspecified.
+     */
+    bool DecodeHex(const char* hex, size_t length, uint8_t* data);
+
+    /**
+     * This function converts the given string of hexadecimal digits into
+     * a vector of bytes.  Uppercase and lowercase digits are both accepted.
+     *
+     * @param[in] hex
+     *     This is the string of hexadecimal digits to convert.
+     *
+     * @param[out] data
+     *     This is where to store the converted bytes.  It is cleared if the
+     *     conversion fails.
+     *
+     * @return
+     *     An indication of whether or not the conversion succeeded is
+     *     returned.  It fails if the number of digits is odd or any
+     *     character is not a hexadecimal digit.
+     */
+    bool DecodeHex(const std::string& hex, std::vector< uint8_t >& data);
+
+}
+
+#endif /* HASH_HEX_HPP */
@@ -7,6 +7,13 @@
  * This module declares functions which can be used to make HMAC-computing
  * functions based on given hash functions.
  *
+ * When given one of the hash functions of this library in any of its forms
+ * (for example, Hash::Sha256 or Hash::StringToString< Hash::Sha256 >),
+ * along with its own block size, the functions made compute HMAC codes
+ * directly with the hash function's context class, through the
+ * process-wide cache of prepared HMAC keys declared in HmacKeyCache.hpp.
+ * Any other hash function is called as given.
+ *
  * © 2018 by Richard Walters
  */
 
@@ -33,7 +40,10 @@ namespace Hash {
      * @return
      *     A function which computes HMAC codes using the given hash function,
      *     taking byte vectors as input and producing string output is
-     *     returned.
+     *     returned.  The hash function must produce pairs of hexadecimal
+     *     digits; if it doesn't, the returned function throws
+     *     std::invalid_argument rather than computing an HMAC code from
+     *     a digest it can't decode.
      */
     std::function<
         std::string(
@@ -60,7 +70,10 @@ namespace Hash {
      * @return
      *     A function which computes HMAC codes using the given hash function,
      *     taking strings as input and producing string output is
-     *     returned.
+     *     returned.  The hash function must produce pairs of hexadecimal
+     *     digits; if it doesn't, the returned function throws
+     *     std::invalid_argument rather than computing an HMAC code from
+     *     a digest it can't decode.
      */
     std::function<
         std::string(
@@ -72,6 +85,68 @@ namespace Hash {
         size_t blockSize
     );
 
+    /**
+     * This function is a factory which returns an HMAC function that takes two
+     * vectors of bytes as input and produces a string output, computing the
+     * HMAC code for a given key and message, using a given hash function
+     * which produces message digests as raw bytes (for example,
+     * Hash::Sha256).  Unlike MakeHmacBytesToStringFunction, no digest is
+     * converted to or from hexadecimal digits, except for the HMAC code
+     * itself, once at the end.
+     *
+     * @param[in] hashFunction
+     *     This is the hash function to use to compute digests in order to
+     *     generate HMAC codes.
+     *
+     * @param[in] blockSize
+     *     This is the block size of the given hash function, in bytes.
+     *
+     * @return
+     *     A function which computes HMAC codes using the given hash function,
+     *     taking byte vectors as input and producing string output is
+     *     returned.
+     */
+    std::function<
+        std::string(
+            const std::vector< uint8_t >&,
+            const std::vector< uint8_t >&
+        )
+    > MakeHmacBytesToStringFunctionFromRawHash(
+        std::function< std::vector< uint8_t >(const std::vector< uint8_t >&) > hashFunction,
+        size_t blockSize
+    );
+
+    /**
+     * This function is a factory which returns an HMAC function that takes two
+     * strings as input and produces a string output, computing the
+     * HMAC code for a given key and message, using a given hash function
+     * which produces message digests as raw bytes (for example,
+     * Hash::StringToBytes< Hash::Sha256 >).  Unlike
+     * MakeHmacStringToStringFunction, no digest is converted to or from
+     * hexadecimal digits, except for the HMAC code itself, once at the end.
+     *
+     * @param[in] hashFunction
+     *     This is the hash function to use to compute digests in order to
+     *     generate HMAC codes.
+     *
+     * @param[in] blockSize
+     *     This is the block size of the given hash function, in bytes.
+     *
+     * @return
+     *     A function which computes HMAC codes using the given hash function,
+     *     taking strings as input and producing string output is
+     *     returned.
+     */
+    std::function<
+        std::string(
+            const std::string&,
+            const std::string&
+        )
+    > MakeHmacStringToStringFunctionFromRawHash(
+        std::function< std::vector< uint8_t >(const std::string&) > hashFunction,
+        size_t blockSize
+    );
+
     /**
      * This function is a factory which returns an HMAC function that takes two
      * vectors of bytes as input and produces a byte vector output, computing
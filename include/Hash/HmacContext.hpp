@@ -0,0 +1,431 @@
+#ifndef HASH_HMAC_CONTEXT_HPP
+#define HASH_HMAC_CONTEXT_HPP
+
+/**
+ * @file HmacContext.hpp
+ *
+ * This module declares the Hash::HmacContext class template, which computes
+ * HMAC codes for many messages with the same key, without repeating the
+ * work which depends only on the key.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Md5.hpp"
+#include "Sha1.hpp"
+#include "Sha2.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace Hash {
+
+    /**
+     * This class template holds the sizes used by HMAC for the hash function
+     * computed by the given context class.  It's specialized for each
+     * context class provided by this library.
+     */
+    template< typename HashContext > struct HashContextTraits;
+
+    /**
+     * This is the base of the specializations of HashContextTraits.
+     */
+    template< size_t blockSizeInBytes, size_t digestSizeInBytes > struct HashContextSizes {
+        /**
+         * This is the block size of the hash function, in bytes.
+         */
+        static constexpr size_t blockSize = blockSizeInBytes;
+
+        /**
+         * This is the size of the message digest, in bytes.
+         */
+        static constexpr size_t digestSize = digestSizeInBytes;
+    };
+
+    template<> struct HashContextTraits< Md5Context >
+        : HashContextSizes< MD5_BLOCK_SIZE, MD5_DIGEST_LENGTH / 8 > {};
+    template<> struct HashContextTraits< Sha1Context >
+        : HashContextSizes< SHA1_BLOCK_SIZE, SHA1_DIGEST_LENGTH / 8 > {};
+    template<> struct HashContextTraits< Sha224Context >
+        : HashContextSizes< SHA224_BLOCK_SIZE, SHA224_DIGEST_LENGTH / 8 > {};
+    template<> struct HashContextTraits< Sha256Context >
+        : HashContextSizes< SHA256_BLOCK_SIZE, SHA256_DIGEST_LENGTH / 8 > {};
+    template<> struct HashContextTraits< Sha384Context >
+        : HashContextSizes< SHA512_BLOCK_SIZE, SHA384_DIGEST_LENGTH / 8 > {};
+    template<> struct HashContextTraits< Sha512Context >
+        : HashContextSizes< SHA512_BLOCK_SIZE, SHA512_DIGEST_LENGTH / 8 > {};
+    template<> struct HashContextTraits< Sha512t224Context >
+        : HashContextSizes< SHA512_BLOCK_SIZE, SHA512T224_DIGEST_LENGTH / 8 > {};
+    template<> struct HashContextTraits< Sha512t256Context >
+        : HashContextSizes< SHA512_BLOCK_SIZE, SHA512T256_DIGEST_LENGTH / 8 > {};
+
+    namespace Internal {
+
+        /**
+         * This function overwrites the given memory with zeroes, in a way
+         * the compiler won't leave out even though the memory isn't read
+         * again, so that no copy of a key or of anything derived from it
+         * is left behind.
+         *
+         * @param[out] data
+         *     This points to the memory to wipe.
+         *
+         * @param[in] length
+         *     This is the number of bytes to wipe.
+         */
+        inline void Wipe(void* data, size_t length) {
+#if defined(__GNUC__) || defined(__clang__)
+            // The empty assembly statement claims to read the memory, so
+            // the compiler must keep the memset, which it can then
+            // vectorize rather than storing one byte at a time.
+            (void)memset(data, 0, length);
+            __asm__ __volatile__("" : : "r"(data) : "memory");
+#else
+            volatile auto bytes = (volatile uint8_t*)data;
+            for (size_t i = 0; i < length; ++i) {
+                bytes[i] = 0;
+            }
+#endif
+        }
+
+    }
+
+    /**
+     * This class template computes HMAC codes with a fixed key, using the
+     * hash function computed by the given context class (for example,
+     * Hash::Sha256Context).
+     *
+     * The padded inner and outer key blocks are compressed once, when the
+     * key is given, and the resulting hash values (the "midstates") are
+     * kept.  Each message then begins from the inner midstate, and its
+     * inner digest is finished from the outer midstate, saving two
+     * compressions and all memory allocations per HMAC code.
+     *
+     * Messages are taken in pieces of any size, like the hash context
+     * classes.
+     *
+     * The midstates, and the hash state of any message being given, are
+     * wiped when the context is destroyed.
+     */
+    template< typename HashContext > class HmacContext {
+        // Public properties
+    public:
+        /**
+         * This is the block size of the hash function, in bytes.
+         */
+        static constexpr size_t blockSize = HashContextTraits< HashContext >::blockSize;
+
+        /**
+         * This is the size of the HMAC code, in bytes.
+         */
+        static constexpr size_t codeSize = HashContextTraits< HashContext >::digestSize;
+
+        // Lifecycle management
+    public:
+        ~HmacContext() noexcept {
+            Internal::Wipe(&innerKeyed_, sizeof(innerKeyed_));
+            Internal::Wipe(&outerKeyed_, sizeof(outerKeyed_));
+            Internal::Wipe(&inner_, sizeof(inner_));
+        }
+        HmacContext(const HmacContext&) = default;
+        HmacContext(HmacContext&&) = default;
+        HmacContext& operator=(const HmacContext&) = default;
+        HmacContext& operator=(HmacContext&&) = default;
+
+        /**
+         * This constructor prepares the context to compute HMAC codes
+         * with the given key.
+         *
+         * @param[in] key
+         *     This points to the key to use.
+         *
+         * @param[in] keyLength
+         *     This is the length of the key, in bytes.
+         */
+        HmacContext(const void* key, size_t keyLength) {
+            uint8_t keyBlock[blockSize] = {0};
+            if (keyLength > blockSize) {
+                HashContext keyHash;
+                keyHash.Update(key, keyLength);
+                keyHash.Final(keyBlock);
+                Internal::Wipe(&keyHash, sizeof(keyHash));
+            } else if (keyLength > 0) {
+                (void)memcpy(keyBlock, key, keyLength);
+            }
+            for (auto& b: keyBlock) {
+                b ^= 0x36;
+            }
+            innerKeyed_.Update(keyBlock, blockSize);
+            for (auto& b: keyBlock) {
+                b ^= (0x36 ^ 0x5C);
+            }
+            outerKeyed_.Update(keyBlock, blockSize);
+            inner_ = innerKeyed_;
+            Internal::Wipe(keyBlock, blockSize);
+        }
+
+        /**
+         * This constructor prepares the context to compute HMAC codes
+         * with the given key.
+         *
+         * @param[in] key
+         *     This is the key to use.
+         */
+        explicit HmacContext(const std::vector< uint8_t >& key)
+            : HmacContext(key.data(), key.size())
+        {
+        }
+
+        // Public methods
+    public:
+        /**
+         * This method discards any message data given so far and begins
+         * a new HMAC code computation with the same key.
+         */
+        void Reset() {
+            inner_ = innerKeyed_;
+        }
+
+        /**
+         * This method appends the given data to the message for which
+         * the HMAC code is being computed.
+         *
+         * @param[in] data
+         *     This points to the data to append to the message.
+         *
+         * @param[in] length
+         *     This is the number of bytes to append to the message.
+         */
+        void Update(const void* data, size_t length) {
+            inner_.Update(data, length);
+        }
+
+        /**
+         * This method appends the given data to the message for which
+         * the HMAC code is being computed.
+         *
+         * @param[in] data
+         *     This is the data to append to the message.
+         */
+        void Update(const std::vector< uint8_t >& data) {
+            inner_.Update(data.data(), data.size());
+        }
+
+        /**
+         * This method completes the HMAC code computation, storing the
+         * code in the given buffer, and then resets the context so that
+         * it may be used for another message with the same key.
+         *
+         * @param[out] code
+         *     This is where to store the HMAC code of all data given since
+         *     the context was constructed or last reset.  It must have room
+         *     for codeSize bytes.
+         */
+        void Final(uint8_t* code) {
+            Finish(inner_, code);
+            inner_ = innerKeyed_;
+        }
+
+        /**
+         * This method completes the HMAC code computation and then resets
+         * the context so that it may be used for another message with the
+         * same key.
+         *
+         * @return
+         *     The HMAC code of all data given since the context was
+         *     constructed or last reset is returned as a vector of bytes.
+         */
+        std::vector< uint8_t > Final() {
+            std::vector< uint8_t > code(codeSize);
+            Final(code.data());
+            return code;
+        }
+
+        /**
+         * This method computes the HMAC code of the given message in one
+         * step, storing the code in the given buffer.  The context isn't
+         * changed, so any message being given piece by piece isn't
+         * disturbed, and several threads may call this method at once.
+         *
+         * @param[in] message
+         *     This points to the message for which to compute the HMAC
+         *     code.
+         *
+         * @param[in] messageLength
+         *     This is the length of the message, in bytes.
+         *
+         * @param[out] code
+         *     This is where to store the HMAC code.  It must have room
+         *     for codeSize bytes.
+         */
+        void Compute(
+            const void* message,
+            size_t messageLength,
+            uint8_t* code
+        ) const {
+            auto inner = innerKeyed_;
+            inner.Update(message, messageLength);
+            Finish(inner, code);
+            Internal::Wipe(&inner, sizeof(inner));
+        }
+
+        // Private methods
+    private:
+        /**
+         * This method finishes the given inner hash and computes the
+         * outer hash of its digest, storing the HMAC code in the given
+         * buffer.
+         *
+         * @param[in,out] inner
+         *     This is the hash state of the message, which is finished.
+         *
+         * @param[out] code
+         *     This is where to store the HMAC code.  It must have room
+         *     for codeSize bytes.
+         */
+        void Finish(HashContext& inner, uint8_t* code) const {
+            uint8_t innerDigest[codeSize];
+            inner.Final(innerDigest);
+            auto outer = outerKeyed_;
+            outer.Update(innerDigest, codeSize);
+            outer.Final(code);
+            Internal::Wipe(innerDigest, codeSize);
+            Internal::Wipe(&outer, sizeof(outer));
+        }
+
+        // Private properties
+    private:
+        /**
+         * This holds the hash state after compressing the inner padded
+         * key block, from which every message begins.
+         */
+        HashContext innerKeyed_;
+
+        /**
+         * This holds the hash state after compressing the outer padded
+         * key block, from which every inner digest is finished.
+         */
+        HashContext outerKeyed_;
+
+        /**
+         * This holds the hash state of the message being given.
+         */
+        HashContext inner_;
+    };
+
+    template< size_t blockSizeInBytes, size_t digestSizeInBytes >
+    constexpr size_t HashContextSizes< blockSizeInBytes, digestSizeInBytes >::blockSize;
+    template< size_t blockSizeInBytes, size_t digestSizeInBytes >
+    constexpr size_t HashContextSizes< blockSizeInBytes, digestSizeInBytes >::digestSize;
+    template< typename HashContext > constexpr size_t HmacContext< HashContext >::blockSize;
+    template< typename HashContext > constexpr size_t HmacContext< HashContext >::codeSize;
+
+    /**
+     * This function computes the HMAC code of the given message with the
+     * given key, using the hash function computed by the given context
+     * class (for example, Hash::Sha256Context), storing it in the given
+     * buffer.  The hash function is called directly rather than through a
+     * function object, so no memory is allocated.
+     *
+     * @param[in] key
+     *     This points to the key to use.
+     *
+     * @param[in] keyLength
+     *     This is the length of the key, in bytes.
+     *
+     * @param[in] message
+     *     This points to the message for which to compute the HMAC code.
+     *
+     * @param[in] messageLength
+     *     This is the length of the message, in bytes.
+     *
+     * @param[out] code
+     *     This is where to store the HMAC code.  It must have room for
+     *     HmacContext< HashContext >::codeSize bytes.
+     */
+    template< typename HashContext > void ComputeHmac(
+        const void* key,
+        size_t keyLength,
+        const void* message,
+        size_t messageLength,
+        uint8_t* code
+    ) {
+        HmacContext< HashContext > hmac(key, keyLength);
+        hmac.Update(message, messageLength);
+        hmac.Final(code);
+    }
+
+    /**
+     * This function computes the HMAC code of the given message with the
+     * given key, using the hash function computed by the given context
+     * class (for example, Hash::Sha256Context).
+     *
+     * @param[in] key
+     *     This is the key to use.
+     *
+     * @param[in] message
+     *     This is the message for which to compute the HMAC code.
+     *
+     * @return
+     *     The HMAC code is returned as a vector of bytes.
+     */
+    template< typename HashContext > std::vector< uint8_t > ComputeHmac(
+        const std::vector< uint8_t >& key,
+        const std::vector< uint8_t >& message
+    ) {
+        std::vector< uint8_t > code(HmacContext< HashContext >::codeSize);
+        ComputeHmac< HashContext >(
+            key.data(),
+            key.size(),
+            message.data(),
+            message.size(),
+            code.data()
+        );
+        return code;
+    }
+
+    /**
+     * This is the HMAC context using MD5.
+     */
+    using HmacMd5Context = HmacContext< Md5Context >;
+
+    /**
+     * This is the HMAC context using SHA-1.
+     */
+    using HmacSha1Context = HmacContext< Sha1Context >;
+
+    /**
+     * This is the HMAC context using SHA-224.
+     */
+    using HmacSha224Context = HmacContext< Sha224Context >;
+
+    /**
+     * This is the HMAC context using SHA-256.
+     */
+    using HmacSha256Context = HmacContext< Sha256Context >;
+
+    /**
+     * This is the HMAC context using SHA-384.
+     */
+    using HmacSha384Context = HmacContext< Sha384Context >;
+
+    /**
+     * This is the HMAC context using SHA-512.
+     */
+    using HmacSha512Context = HmacContext< Sha512Context >;
+
+    /**
+     * This is the HMAC context using SHA-512/224.
+     */
+    using HmacSha512t224Context = HmacContext< Sha512t224Context >;
+
+    /**
+     * This is the HMAC context using SHA-512/256.
+     */
+    using HmacSha512t256Context = HmacContext< Sha512t256Context >;
+
+}
+
+#endif /* HASH_HMAC_CONTEXT_HPP */
@@ -0,0 +1,122 @@
+#ifndef HASH_HMAC_KEY_CACHE_HPP
+#define HASH_HMAC_KEY_CACHE_HPP
+
+/**
+ * @file HmacKeyCache.hpp
+ *
+ * This module declares the functions which control the process-wide cache
+ * of prepared HMAC keys, used by the HMAC factories declared in Hmac.hpp
+ * whenever they're given one of the hash functions of this library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hash {
+
+    /**
+     * This is the largest number of keys kept by the HMAC key cache unless
+     * it's configured otherwise.
+     */
+    constexpr size_t HMAC_KEY_CACHE_DEFAULT_CAPACITY = 1024;
+
+    /**
+     * This is the number of parts into which the HMAC key cache is split
+     * unless it's configured otherwise.
+     */
+    constexpr size_t HMAC_KEY_CACHE_DEFAULT_SHARDS = 16;
+
+    /**
+     * This holds counts which describe how well the HMAC key cache is
+     * working.
+     */
+    struct HmacKeyCacheStatistics {
+        /**
+         * This is the number of HMAC codes computed with keys found
+         * in the cache.
+         */
+        uint64_t hits = 0;
+
+        /**
+         * This is the number of HMAC codes computed with keys which
+         * weren't found in the cache.
+         */
+        uint64_t misses = 0;
+
+        /**
+         * This is the number of keys currently in the cache.
+         */
+        size_t size = 0;
+    };
+
+    /**
+     * This function sets the capacity of the process-wide cache of
+     * prepared HMAC keys, and the number of parts into which it's split,
+     * and then removes all keys from it.
+     *
+     * The HMAC functions returned by the factories declared in Hmac.hpp,
+     * when given one of the hash functions of this library (for example,
+     * Hash::Sha256 or Hash::StringToBytes< Hash::Sha256 >), keep the
+     * HMAC midstates of the most recently used keys in this cache: the hash
+     * states after the padded inner and outer keys are compressed.  A key
+     * found in the cache skips hashing a long key and compressing the
+     * padded keys.
+     *
+     * Keys aren't kept in the cache.  Instead, each key is found by a
+     * 128-bit SipHash digest of it, keyed with a secret chosen at random
+     * when the process starts, and the midstates of keys dropped from the
+     * cache are wiped.
+     *
+     * A key is added to the cache only the second time it's seen within
+     * a short while.  The first time, and whenever the cache is turned
+     * off, its HMAC code is computed with a Hash::HmacContext on the
+     * stack, which wipes the key's midstates when it's done.  Keys used
+     * only once, such as one-off secrets, therefore cost no memory
+     * allocation, and their midstates aren't kept.
+     *
+     * Each part of the cache has its own lock and its own
+     * least-recently-used order, so that threads using different keys
+     * rarely wait for each other.  The capacity is split exactly among
+     * the parts, with some parts holding one key more than others if it
+     * doesn't divide evenly, and the least recently used key in a part is
+     * dropped to make room for a new one.
+     *
+     * This is meant to be called when the program starts, although it's
+     * safe to call at any time.  HMAC codes being computed at the same
+     * time may still use the former settings.
+     *
+     * @param[in] capacity
+     *     This is the largest number of keys to keep.  If zero, keys aren't
+     *     cached at all.
+     *
+     * @param[in] numShards
+     *     This is the number of parts into which to split the cache.  It's
+     *     limited to between 1 and 64, and to no more than the capacity.
+     */
+    void ConfigureHmacKeyCache(
+        size_t capacity,
+        size_t numShards = HMAC_KEY_CACHE_DEFAULT_SHARDS
+    );
+
+    /**
+     * This function returns counts which describe how well the
+     * process-wide cache of prepared HMAC keys is working.
+     *
+     * @return
+     *     The numbers of hits and misses since the process started, and
+     *     the number of keys currently in the cache, are returned.
+     */
+    HmacKeyCacheStatistics GetHmacKeyCacheStatistics();
+
+    /**
+     * This function removes all keys from the process-wide cache of
+     * prepared HMAC keys, wiping their midstates.  The numbers of hits and
+     * misses are kept.
+     */
+    void ClearHmacKeyCache();
+
+}
+
+#endif /* HASH_HMAC_KEY_CACHE_HPP */
@@ -8,6 +8,7 @@
  * © 2019 by Richard Walters
  */
 
+#include <array>
 #include <stddef.h>
 #include <stdint.h>
 #include <vector>
@@ -25,6 +26,11 @@ namespace Hash {
      */
     constexpr size_t MD5_DIGEST_LENGTH = 128;
 
+    /**
+     * This is the type of a MD5 message digest.
+     */
+    using Md5Digest = std::array< uint8_t, MD5_DIGEST_LENGTH / 8 >;
+
     /**
      * This function computes the MD5 message digest of the given data.
      *
@@ -37,4 +43,169 @@ namespace Hash {
      */
     std::vector< uint8_t > Md5(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the MD5 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for MD5_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeMd5(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the MD5 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The MD5 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Md5Digest ComputeMd5(const void* data, size_t length);
+
+    /**
+     * This function computes the MD5 message digests of many independent
+     * messages at once.  Where the CPU supports it, the messages are hashed
+     * in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     This points to the first byte of each message.
+     *
+     * @param[in] lengths
+     *     These are the lengths, in bytes, of the messages.
+     *
+     * @param[in] numMessages
+     *     This is the number of messages.
+     *
+     * @param[out] digests
+     *     This is where to store the 16-byte MD5 message digests,
+     *     one after the other, in the same order as the messages.
+     *     It must have room for numMessages * 16 bytes.
+     */
+    void Md5Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    );
+
+    /**
+     * This function computes the MD5 message digests of many independent
+     * messages at once.  Where the CPU supports it, the messages are hashed
+     * in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     These are the messages for which to compute message digests.
+     *
+     * @return
+     *     The 16-byte MD5 message digests of the given messages are
+     *     returned one after the other, in the same order as the messages,
+     *     in a single vector of bytes.
+     */
+    std::vector< uint8_t > Md5Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    );
+
+    /**
+     * This class computes an MD5 message digest incrementally, taking
+     * the message in pieces of any size.  Only one partial block of the
+     * message is kept between updates, so memory use does not depend on the
+     * length of the message.
+     */
+    class Md5Context {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new MD5
+         * message digest computation.
+         */
+        Md5Context();
+
+        // Public methods
+    public:
+        /**
+         * This method discards any data given so far and begins a new
+         * message digest computation.
+         */
+        void Reset();
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This points to the data to append to the message.
+         *
+         * @param[in] length
+         *     This is the number of bytes to append to the message.
+         */
+        void Update(const void* data, size_t length);
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This is the data to append to the message.
+         */
+        void Update(const std::vector< uint8_t >& data);
+
+        /**
+         * This method completes the message digest computation and then
+         * resets the context so that it may be used for another message.
+         *
+         * @return
+         *     The message digest of all data given since the context
+         *     was constructed or last reset is returned as a vector of bytes.
+         */
+        std::vector< uint8_t > Final();
+
+        /**
+         * This method completes the message digest computation, storing
+         * the digest in the given buffer, and then resets the context so
+         * that it may be used for another message.
+         *
+         * @param[out] digest
+         *     This is where to store the message digest of all data given
+         *     since the context was constructed or last reset.  It must
+         *     have room for MD5_DIGEST_LENGTH / 8 bytes.
+         */
+        void Final(uint8_t* digest);
+
+        // Private properties
+    private:
+        /**
+         * These are the current hash values of the computation.
+         */
+        uint32_t state_[4];
+
+        /**
+         * This holds the part of the message not yet compressed, which
+         * is always less than one block.
+         */
+        uint8_t buffer_[MD5_BLOCK_SIZE];
+
+        /**
+         * This is the number of bytes currently held in the buffer.
+         */
+        size_t bufferLength_ = 0;
+
+        /**
+         * This is the number of bytes of the message given so far.
+         */
+        uint64_t messageLength_ = 0;
+    };
+
 }
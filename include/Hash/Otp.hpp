@@ -0,0 +1,291 @@
+#ifndef HASH_OTP_HPP
+#define HASH_OTP_HPP
+
+/**
+ * @file Otp.hpp
+ *
+ * This module declares the functions shared by everything in this library
+ * which generates or checks HOTP and TOTP one-time passwords, as defined in
+ * [RFC 4226](https://tools.ietf.org/html/rfc4226) and
+ * [RFC 6238](https://tools.ietf.org/html/rfc6238).
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha1.hpp"
+#include "Sha2.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hash {
+
+    /**
+     * This class template holds the functions which generate one-time
+     * passwords from the HMAC midstates of shared secrets, using HMAC
+     * with the hash function computed by the given context class.  The
+     * midstates are the hash values after the padded inner and outer keys
+     * have been compressed, and are all that's needed to compute HMAC
+     * codes with a key, so they're kept instead of the key.
+     *
+     * The midstates of a secret are stored in OtpMidstates::size bytes:
+     * the words of the inner hash value followed by the words of the
+     * outer hash value, each in little-endian byte order, so that they
+     * may be stored in files and shared between machines.
+     *
+     * It's specialized for Sha1Context, Sha256Context, and Sha512Context.
+     */
+    template< typename HashContext > struct OtpMidstates;
+
+    /**
+     * This holds the functions which generate one-time passwords from
+     * HMAC-SHA-1 midstates.
+     */
+    template<> struct OtpMidstates< Sha1Context > {
+        /**
+         * This is the size of the midstates of one secret, in bytes.
+         */
+        static constexpr size_t size = 40;
+
+        /**
+         * This function computes the midstates of the given secret.
+         *
+         * @param[in] secret
+         *     This points to the shared secret.
+         *
+         * @param[in] secretLength
+         *     This is the length of the shared secret, in bytes.
+         *
+         * @param[out] midstates
+         *     This is where to store the midstates.  It must have room for
+         *     size bytes.
+         */
+        static void Key(
+            const void* secret,
+            size_t secretLength,
+            uint8_t* midstates
+        );
+
+        /**
+         * This function generates the HOTP one-time password for the
+         * given counter value, from the given midstates.  It takes exactly
+         * two compressions and no memory allocations.
+         *
+         * @param[in] midstates
+         *     This points to the midstates of the shared secret.
+         *
+         * @param[in] count
+         *     This is the counter value to use to generate the one-time
+         *     password.
+         *
+         * @param[in] modulus
+         *     This is the number by which the truncated HMAC code is
+         *     reduced, as returned by OtpModulus.
+         *
+         * @return
+         *     The generated one-time password is returned.
+         */
+        static int Hotp(
+            const uint8_t* midstates,
+            uint64_t count,
+            uint32_t modulus
+        );
+    };
+
+    /**
+     * This holds the functions which generate one-time passwords from
+     * HMAC-SHA-256 midstates.  They're described in
+     * OtpMidstates< Sha1Context >.
+     */
+    template<> struct OtpMidstates< Sha256Context > {
+        static constexpr size_t size = 64;
+        static void Key(const void* secret, size_t secretLength, uint8_t* midstates);
+        static int Hotp(const uint8_t* midstates, uint64_t count, uint32_t modulus);
+    };
+
+    /**
+     * This holds the functions which generate one-time passwords from
+     * HMAC-SHA-512 midstates.  They're described in
+     * OtpMidstates< Sha1Context >.
+     */
+    template<> struct OtpMidstates< Sha512Context > {
+        static constexpr size_t size = 128;
+        static void Key(const void* secret, size_t secretLength, uint8_t* midstates);
+        static int Hotp(const uint8_t* midstates, uint64_t count, uint32_t modulus);
+    };
+
+    /**
+     * This function returns the number by which the truncated HMAC code is
+     * reduced to produce a one-time password of the given number of
+     * digits.  It's computed with integers, since the truncated code has
+     * at most ten digits, and ten to the power of ten doesn't fit in 32
+     * bits.
+     *
+     * @param[in] digits
+     *     This is the number of digits in the one-time password.
+     *
+     * @return
+     *     Ten to the power of the given number of digits is returned,
+     *     or zero if every truncated HMAC code already has no more
+     *     than that many digits.
+     */
+    inline uint32_t OtpModulus(size_t digits) {
+        uint32_t modulus = 1;
+        for (size_t i = 0; i < digits; ++i) {
+            if (modulus > 0x7FFFFFFF / 10) {
+                return 0;
+            }
+            modulus *= 10;
+        }
+        return modulus;
+    }
+
+    /**
+     * This function produces a one-time password from the given HMAC
+     * code, by dynamically truncating it to 31 bits and reducing it by
+     * the given modulus.
+     *
+     * @param[in] hs
+     *     This points to the HMAC code.
+     *
+     * @param[in] hsLength
+     *     This is the length of the HMAC code, in bytes.
+     *
+     * @param[in] modulus
+     *     This is the number by which the truncated code is reduced,
+     *     as returned by OtpModulus.
+     *
+     * @return
+     *     The one-time password is returned.
+     */
+    inline int OtpFromHmac(
+        const uint8_t* hs,
+        size_t hsLength,
+        uint32_t modulus
+    ) {
+        const auto offset = (size_t)(hs[hsLength - 1] & 0xF);
+        const auto snum = (
+            (((uint32_t)(hs[offset] & 0x7F)) << 24)
+            | (((uint32_t)hs[offset + 1]) << 16)
+            | (((uint32_t)hs[offset + 2]) << 8)
+            | ((uint32_t)hs[offset + 3])
+        );
+        return (int)((modulus == 0) ? snum : (snum % modulus));
+    }
+
+    /**
+     * This function checks the given HOTP one-time password against the
+     * counter values from the given one through the given number of
+     * values past it, as done by the "look-ahead" resynchronization
+     * described in RFC 4226 section 7.4.  Every value in the window is
+     * checked, rather than stopping at the first match, so that the time
+     * taken doesn't reveal which counter value matched.
+     *
+     * @param[in] hotp
+     *     This is the function to call to generate the one-time password
+     *     for a counter value.
+     *
+     * @param[in] password
+     *     This is the one-time password to check.
+     *
+     * @param[in] count
+     *     This is the next counter value expected.
+     *
+     * @param[in] lookAhead
+     *     This is the number of counter values past the expected one
+     *     to also check.
+     *
+     * @param[out] nextCount
+     *     If the password matches, this is set to the counter value
+     *     following the one which matched, which should be expected
+     *     next time.
+     *
+     * @return
+     *     An indication of whether or not the password matches any
+     *     counter value in the window is returned.
+     */
+    template< typename Generate > bool VerifyHotpWindow(
+        const Generate& hotp,
+        int password,
+        uint64_t count,
+        size_t lookAhead,
+        uint64_t& nextCount
+    ) {
+        bool matched = false;
+        for (uint64_t i = 0; i <= lookAhead; ++i) {
+            const auto found = (hotp(count + i) == password);
+            if (found && !matched) {
+                nextCount = count + i + 1;
+            }
+            matched = (matched || found);
+        }
+        return matched;
+    }
+
+    /**
+     * This function checks the given TOTP one-time password against the
+     * time steps within the given number of steps before or after the
+     * one containing the given UNIX time, to allow for clock drift.
+     * Every step in the window is checked, rather than stopping at the
+     * first match, so that the time taken doesn't reveal which step
+     * matched.
+     *
+     * @param[in] hotp
+     *     This is the function to call to generate the one-time password
+     *     for a time step.
+     *
+     * @param[in] password
+     *     This is the one-time password to check.
+     *
+     * @param[in] time
+     *     This is the UNIX time at which the password is checked.
+     *
+     * @param[in] base
+     *     This is the UNIX time to start counting time steps.
+     *
+     * @param[in] step
+     *     This is the time step in seconds.
+     *
+     * @param[in] window
+     *     This is the number of time steps before and after the
+     *     current one to also check.
+     *
+     * @param[out] drift
+     *     If the password matches, this is set to the number of time
+     *     steps from the current one to the one which matched, negative
+     *     if the matching step is earlier.  If several steps match,
+     *     the one closest to the current one is used.
+     *
+     * @return
+     *     An indication of whether or not the password matches any
+     *     time step in the window is returned.
+     */
+    template< typename Generate > bool VerifyTotpWindow(
+        const Generate& hotp,
+        int password,
+        uint64_t time,
+        uint64_t base,
+        uint64_t step,
+        size_t window,
+        int64_t& drift
+    ) {
+        const auto t = (time - base) / step;
+        const auto first = ((t < window) ? 0 : (t - window));
+        const auto last = t + window;
+        bool matched = false;
+        uint64_t closest = 0;
+        for (uint64_t count = first; count <= last; ++count) {
+            const auto distance = ((count < t) ? (t - count) : (count - t));
+            const auto found = (hotp(count) == password);
+            if (found && (!matched || (distance < closest))) {
+                closest = distance;
+                drift = ((count < t) ? -(int64_t)distance : (int64_t)distance);
+            }
+            matched = (matched || found);
+        }
+        return matched;
+    }
+
+}
+
+#endif /* HASH_OTP_HPP */
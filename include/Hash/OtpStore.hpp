@@ -0,0 +1,312 @@
+#ifndef HASH_OTP_STORE_HPP
+#define HASH_OTP_STORE_HPP
+
+/**
+ * @file OtpStore.hpp
+ *
+ * This module declares the Hash::OtpStore class, which generates and checks
+ * HOTP and TOTP one-time passwords for many shared secrets, using the HMAC
+ * key states of the secrets precomputed into a file which is mapped into
+ * memory (or, on Windows, read into memory).
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Hash {
+
+    /**
+     * These are the hash functions whose HMAC key states may be kept
+     * in a one-time password store.
+     */
+    enum class OtpStoreAlgorithm {
+        Sha1 = 1,
+        Sha256 = 2,
+        Sha512 = 3,
+    };
+
+    /**
+     * This class generates and checks one-time passwords for many shared
+     * secrets, according to the HOTP (HMAC-Based One-Time Password)
+     * algorithm defined in [RFC 4226](https://tools.ietf.org/html/rfc4226)
+     * and the TOTP (Time-Based One-Time Password) algorithm defined in
+     * [RFC 6238](https://tools.ietf.org/html/rfc6238).
+     *
+     * The secrets themselves aren't kept.  Instead, a store file, written
+     * by the Write function, holds the hash values of each secret's HMAC
+     * computation after the padded inner and outer keys have been
+     * compressed (the "midstates").  Opening the store maps the file into
+     * memory, so that the midstates are used directly from the page cache,
+     * and are shared by every process using the same file.  Each counter
+     * value checked then costs exactly two compressions.
+     *
+     * On Windows, a file which is mapped into memory can't be replaced
+     * until it's unmapped, which would keep Write from replacing the file
+     * of an open store.  So there, opening the store reads the whole file
+     * into memory private to the store instead, and the midstates aren't
+     * shared with other processes.
+     *
+     * The store file begins with a header identifying the format, its
+     * version, the hash function, the number of digits in each password,
+     * and the number of secrets, followed by one fixed-size record of
+     * midstates for each secret, in the order the secrets were given.
+     * All numbers in the file are stored in little-endian byte order.
+     *
+     * The methods which generate and check passwords may be called from
+     * any number of threads at once.
+     *
+     * A store which has been moved from is empty, as if closed, and may
+     * be opened again.
+     */
+    class OtpStore {
+        // Lifecycle management
+    public:
+        ~OtpStore() noexcept;
+        OtpStore(const OtpStore&) = delete;
+        OtpStore(OtpStore&&) noexcept;
+        OtpStore& operator=(const OtpStore&) = delete;
+        OtpStore& operator=(OtpStore&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor.  The store is empty until a
+         * store file is opened.
+         */
+        OtpStore();
+
+        /**
+         * This function writes a store file holding the HMAC midstates of
+         * the given shared secrets.
+         *
+         * The file is written under a temporary name in the same
+         * directory, synchronized to the device, and then renamed over
+         * any file already at the given path.  Stores which already have
+         * the old file open keep using it safely until they're reopened,
+         * and if writing fails, the old file is left as it was.
+         *
+         * @param[in] path
+         *     This is the path of the file to write.
+         *
+         * @param[in] algorithm
+         *     This is the hash function to use with HMAC.
+         *
+         * @param[in] digits
+         *     This is the number of digits in each one-time password.
+         *
+         * @param[in] secrets
+         *     These are the shared secrets, identified in the store by
+         *     their indexes in this vector.
+         *
+         * @return
+         *     An indication of whether or not the file was written
+         *     successfully is returned.
+         */
+        static bool Write(
+            const std::string& path,
+            OtpStoreAlgorithm algorithm,
+            size_t digits,
+            const std::vector< std::string >& secrets
+        );
+
+        /**
+         * This method opens the given store file, mapping it into memory
+         * (or, on Windows, reading it into memory), after closing any store
+         * file already open.
+         *
+         * @param[in] path
+         *     This is the path of the file to open.
+         *
+         * @return
+         *     An indication of whether or not the file was opened
+         *     successfully is returned.  It fails if the file can't be
+         *     read, isn't a store file, has an unsupported version, or
+         *     is too short to hold all its records.
+         */
+        bool Open(const std::string& path);
+
+        /**
+         * This method closes the store file, if one is open.
+         */
+        void Close();
+
+        /**
+         * This method returns the number of shared secrets in the store.
+         *
+         * @return
+         *     The number of shared secrets in the store is returned,
+         *     or zero if no store file is open.
+         */
+        size_t Size() const;
+
+        /**
+         * This method returns the hash function used with HMAC by the
+         * store.  It must not be called unless a store file is open.
+         *
+         * @return
+         *     The hash function used with HMAC by the store is returned.
+         */
+        OtpStoreAlgorithm GetAlgorithm() const;
+
+        /**
+         * This method returns the number of digits in each one-time
+         * password.  It must not be called unless a store file is open.
+         *
+         * @return
+         *     The number of digits in each one-time password is returned.
+         */
+        size_t GetDigits() const;
+
+        /**
+         * This method generates the HOTP one-time password of the given
+         * secret for the given counter value.
+         *
+         * @param[in] index
+         *     This is the index of the secret in the store.
+         *
+         * @param[in] count
+         *     This is the counter value to use to generate the one-time
+         *     password.
+         *
+         * @return
+         *     The generated one-time password is returned, or -1 if the
+         *     store isn't open or has no secret at the given index.
+         */
+        int Hotp(
+            size_t index,
+            uint64_t count
+        ) const;
+
+        /**
+         * This method generates the TOTP one-time password of the given
+         * secret for the given UNIX time.
+         *
+         * @param[in] index
+         *     This is the index of the secret in the store.
+         *
+         * @param[in] time
+         *     This is the UNIX time to use to generate the one-time password.
+         *
+         * @param[in] base
+         *     This is the UNIX time to start counting time steps.
+         *
+         * @param[in] step
+         *     This is the time step in seconds.
+         *
+         * @return
+         *     The generated one-time password is returned, or -1 if the
+         *     store isn't open or has no secret at the given index.
+         */
+        int Totp(
+            size_t index,
+            uint64_t time,
+            uint64_t base,
+            uint64_t step
+        ) const;
+
+        /**
+         * This method checks the given HOTP one-time password of the given
+         * secret against the counter values from the given one through the
+         * given number of values past it, in the same way as
+         * Hash::OtpVerifier::VerifyHotp.
+         *
+         * @param[in] index
+         *     This is the index of the secret in the store.
+         *
+         * @param[in] password
+         *     This is the one-time password to check.
+         *
+         * @param[in] count
+         *     This is the next counter value expected.
+         *
+         * @param[in] lookAhead
+         *     This is the number of counter values past the expected one
+         *     to also check.
+         *
+         * @param[out] nextCount
+         *     If the password matches, this is set to the counter value
+         *     following the one which matched, which should be expected
+         *     next time.
+         *
+         * @return
+         *     An indication of whether or not the password matches any
+         *     counter value in the window is returned.  If the store isn't
+         *     open or has no secret at the given index, false is returned.
+         */
+        bool VerifyHotp(
+            size_t index,
+            int password,
+            uint64_t count,
+            size_t lookAhead,
+            uint64_t& nextCount
+        ) const;
+
+        /**
+         * This method checks the given TOTP one-time password of the given
+         * secret against the time steps within the given number of steps
+         * before or after the one containing the given UNIX time, in the
+         * same way as Hash::OtpVerifier::VerifyTotp.
+         *
+         * @param[in] index
+         *     This is the index of the secret in the store.
+         *
+         * @param[in] password
+         *     This is the one-time password to check.
+         *
+         * @param[in] time
+         *     This is the UNIX time at which the password is checked.
+         *
+         * @param[in] base
+         *     This is the UNIX time to start counting time steps.
+         *
+         * @param[in] step
+         *     This is the time step in seconds.
+         *
+         * @param[in] window
+         *     This is the number of time steps before and after the
+         *     current one to also check.
+         *
+         * @param[out] drift
+         *     If the password matches, this is set to the number of time
+         *     steps from the current one to the one which matched, negative
+         *     if the matching step is earlier.  If several steps match,
+         *     the one closest to the current one is used.
+         *
+         * @return
+         *     An indication of whether or not the password matches any
+         *     time step in the window is returned.  If the store isn't
+         *     open or has no secret at the given index, false is returned.
+         */
+        bool VerifyTotp(
+            size_t index,
+            int password,
+            uint64_t time,
+            uint64_t base,
+            uint64_t step,
+            size_t window,
+            int64_t& drift
+        ) const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
+
+#endif /* HASH_OTP_STORE_HPP */
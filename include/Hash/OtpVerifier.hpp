@@ -0,0 +1,254 @@
+#ifndef HASH_OTP_VERIFIER_HPP
+#define HASH_OTP_VERIFIER_HPP
+
+/**
+ * @file OtpVerifier.hpp
+ *
+ * This module declares the Hash::OtpVerifier class template, which generates
+ * and checks HOTP and TOTP one-time passwords for one shared secret, without
+ * repeating the work which depends only on the secret.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HmacContext.hpp"
+#include "Otp.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Hash {
+
+    /**
+     * This class template generates and checks one-time passwords for one
+     * shared secret, according to the HOTP (HMAC-Based One-Time Password)
+     * algorithm defined in [RFC 4226](https://tools.ietf.org/html/rfc4226)
+     * and the TOTP (Time-Based One-Time Password) algorithm defined in
+     * [RFC 6238](https://tools.ietf.org/html/rfc6238), using HMAC with the
+     * hash function computed by the given context class (for example,
+     * Hash::Sha1Context).
+     *
+     * The HMAC midstates of the secret are computed once, when the
+     * verifier is constructed, so each counter value checked costs exactly
+     * two compressions and no memory allocations.  A window of counter
+     * values is checked in one pass, comparing against every value in the
+     * window rather than stopping at the first match, so that the time
+     * taken doesn't reveal which counter value matched.
+     *
+     * Generating and checking passwords doesn't change the verifier, so
+     * several threads may use one verifier at once.
+     */
+    template< typename HashContext > class OtpVerifier {
+        // Lifecycle management
+    public:
+        /**
+         * This constructor prepares the verifier to generate and check
+         * one-time passwords with the given shared secret.
+         *
+         * @param[in] secret
+         *     This points to the shared secret.
+         *
+         * @param[in] secretLength
+         *     This is the length of the shared secret, in bytes.
+         *
+         * @param[in] digits
+         *     This is the number of digits in each one-time password.
+         */
+        OtpVerifier(
+            const void* secret,
+            size_t secretLength,
+            size_t digits
+        )
+            : hmac_(secret, secretLength)
+            , modulus_(OtpModulus(digits))
+        {
+        }
+
+        /**
+         * This constructor prepares the verifier to generate and check
+         * one-time passwords with the given shared secret.
+         *
+         * @param[in] secret
+         *     This is the shared secret.
+         *
+         * @param[in] digits
+         *     This is the number of digits in each one-time password.
+         */
+        OtpVerifier(
+            const std::string& secret,
+            size_t digits
+        )
+            : OtpVerifier(secret.data(), secret.length(), digits)
+        {
+        }
+
+        // Public methods
+    public:
+        /**
+         * This method generates the HOTP one-time password for the given
+         * counter value.
+         *
+         * @param[in] count
+         *     This is the counter value to use to generate the one-time
+         *     password.
+         *
+         * @return
+         *     The generated one-time password is returned.
+         */
+        int Hotp(uint64_t count) const {
+            uint8_t countBytes[8];
+            for (size_t i = 0; i < 8; ++i) {
+                countBytes[i] = (uint8_t)(count >> (56 - i * 8));
+            }
+            uint8_t hs[HmacContext< HashContext >::codeSize];
+            hmac_.Compute(countBytes, sizeof(countBytes), hs);
+            return OtpFromHmac(hs, sizeof(hs), modulus_);
+        }
+
+        /**
+         * This method generates the TOTP one-time password for the given
+         * UNIX time.
+         *
+         * @param[in] time
+         *     This is the UNIX time to use to generate the one-time password.
+         *
+         * @param[in] base
+         *     This is the UNIX time to start counting time steps.
+         *
+         * @param[in] step
+         *     This is the time step in seconds.
+         *
+         * @return
+         *     The generated one-time password is returned.
+         */
+        int Totp(
+            uint64_t time,
+            uint64_t base,
+            uint64_t step
+        ) const {
+            return Hotp((time - base) / step);
+        }
+
+        /**
+         * This method checks the given HOTP one-time password against the
+         * counter values from the given one through the given number of
+         * values past it, as done by the "look-ahead" resynchronization
+         * described in RFC 4226 section 7.4.
+         *
+         * @param[in] password
+         *     This is the one-time password to check.
+         *
+         * @param[in] count
+         *     This is the next counter value expected.
+         *
+         * @param[in] lookAhead
+         *     This is the number of counter values past the expected one
+         *     to also check.
+         *
+         * @param[out] nextCount
+         *     If the password matches, this is set to the counter value
+         *     following the one which matched, which should be expected
+         *     next time.
+         *
+         * @return
+         *     An indication of whether or not the password matches any
+         *     counter value in the window is returned.
+         */
+        bool VerifyHotp(
+            int password,
+            uint64_t count,
+            size_t lookAhead,
+            uint64_t& nextCount
+        ) const {
+            return VerifyHotpWindow(
+                [this](uint64_t counter) { return Hotp(counter); },
+                password,
+                count,
+                lookAhead,
+                nextCount
+            );
+        }
+
+        /**
+         * This method checks the given TOTP one-time password against the
+         * time steps within the given number of steps before or after the
+         * one containing the given UNIX time, to allow for clock drift.
+         *
+         * @param[in] password
+         *     This is the one-time password to check.
+         *
+         * @param[in] time
+         *     This is the UNIX time at which the password is checked.
+         *
+         * @param[in] base
+         *     This is the UNIX time to start counting time steps.
+         *
+         * @param[in] step
+         *     This is the time step in seconds.
+         *
+         * @param[in] window
+         *     This is the number of time steps before and after the
+         *     current one to also check.
+         *
+         * @param[out] drift
+         *     If the password matches, this is set to the number of time
+         *     steps from the current one to the one which matched, negative
+         *     if the matching step is earlier.  If several steps match,
+         *     the one closest to the current one is used.
+         *
+         * @return
+         *     An indication of whether or not the password matches any
+         *     time step in the window is returned.
+         */
+        bool VerifyTotp(
+            int password,
+            uint64_t time,
+            uint64_t base,
+            uint64_t step,
+            size_t window,
+            int64_t& drift
+        ) const {
+            return VerifyTotpWindow(
+                [this](uint64_t counter) { return Hotp(counter); },
+                password,
+                time,
+                base,
+                step,
+                window,
+                drift
+            );
+        }
+
+        // Private properties
+    private:
+        /**
+         * This is used to compute HMAC codes with the shared secret.
+         */
+        HmacContext< HashContext > hmac_;
+
+        /**
+         * This is the number by which the truncated HMAC code is reduced
+         * to produce a one-time password, or zero if it isn't reduced.
+         */
+        uint32_t modulus_;
+    };
+
+    /**
+     * This is the one-time password verifier using HMAC-SHA-1.
+     */
+    using OtpSha1Verifier = OtpVerifier< Sha1Context >;
+
+    /**
+     * This is the one-time password verifier using HMAC-SHA-256.
+     */
+    using OtpSha256Verifier = OtpVerifier< Sha256Context >;
+
+    /**
+     * This is the one-time password verifier using HMAC-SHA-512.
+     */
+    using OtpSha512Verifier = OtpVerifier< Sha512Context >;
+
+}
+
+#endif /* HASH_OTP_VERIFIER_HPP */
@@ -10,18 +10,65 @@
  * © 2019 by Richard Walters
  */
 
+#include "HmacContext.hpp"
+
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 #include <vector>
 
 namespace Hash {
 
+    /**
+     * This is the type of function which may be given to the parallel
+     * PBKDF2 functions in order to compute the blocks of a derived key
+     * concurrently.  It must call the given task once for each index from
+     * zero up to, but not including, the given count, in any order and
+     * on any threads, and return only after every call has returned.
+     */
+    using Pbkdf2Executor = std::function<
+        void(
+            size_t count,
+            std::function< void(size_t index) > task
+        )
+    >;
+
+    /**
+     * This function is a Pbkdf2Executor which runs the given tasks on the
+     * calling thread along with the threads of a process-wide pool, which
+     * is started the first time it's needed and has one thread fewer than
+     * the number of hardware threads.
+     *
+     * @param[in] count
+     *     This is the number of tasks to run.
+     *
+     * @param[in] task
+     *     This is the function to call with the index of each task.
+     *
+     * @throw
+     *     If any task throws an exception, the tasks not yet started are
+     *     skipped, and the first exception is rethrown on the calling
+     *     thread once the tasks already started have finished.
+     */
+    void Pbkdf2ThreadExecutor(
+        size_t count,
+        std::function< void(size_t index) > task
+    );
+
     /**
      * This is an implementation of the PBKDF2 (Password-Based Key Derivation
      * Function 2), described here: https://en.wikipedia.org/wiki/PBKDF2.
      *
+     * If the pseudorandom function was made by MakeHmacBytesToBytesFunction
+     * from one of the hash functions of this library, the derived key is
+     * computed directly with the hash function, preparing the password
+     * only once, rather than calling the pseudorandom function for every
+     * iteration.
+     *
      * @param[in] prf
      *     This is a pseudorandom function of two parameters with output
      *     length hLen (e.g., a keyed HMAC)
@@ -59,6 +106,619 @@ namespace Hash {
         size_t dkLen
     );
 
+    /**
+     * This is an implementation of the PBKDF2 (Password-Based Key Derivation
+     * Function 2), which computes the blocks of the derived key using the
+     * given executor, so that they may be computed concurrently.  The
+     * pseudorandom function may be called from several threads at once.
+     *
+     * @param[in] prf
+     *     This is a pseudorandom function of two parameters with output
+     *     length hLen (e.g., a keyed HMAC)
+     *
+     * @param[in] hLen
+     *     This is the output length, in bits, of the PRF.
+     *
+     * @param[in] password
+     *     This is the master password from which a derived key is generated.
+     *
+     * @param[in] salt
+     *     This is a sequence of bits, known as a cryptographic salt
+     *     (https://en.wikipedia.org/wiki/Salt_(cryptography)).
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     *
+     * @return
+     *     The derived key is returned.
+     */
+    std::vector< uint8_t > Pbkdf2Parallel(
+        std::function<
+            std::vector< uint8_t >(
+                const std::vector< uint8_t >&,
+                const std::vector< uint8_t >&
+            )
+        > prf,
+        size_t hLen,
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor = Pbkdf2ThreadExecutor
+    );
+
+    /**
+     * This holds the inputs of one PBKDF2 derivation given to a batch
+     * PBKDF2 function, along with where to store the derived key.
+     */
+    struct Pbkdf2Job {
+        /**
+         * This points to the master password from which a derived key
+         * is generated.
+         */
+        const void* password;
+
+        /**
+         * This is the length of the password, in bytes.
+         */
+        size_t passwordLength;
+
+        /**
+         * This points to the cryptographic salt.
+         */
+        const void* salt;
+
+        /**
+         * This is the length of the salt, in bytes.
+         */
+        size_t saltLength;
+
+        /**
+         * This is the number of iterations desired.
+         */
+        size_t c;
+
+        /**
+         * This is where to store the derived key.
+         */
+        uint8_t* dk;
+
+        /**
+         * This is the desired byte-length of the derived key.
+         */
+        size_t dkLen;
+    };
+
+    /**
+     * This function computes PBKDF2 using HMAC-SHA-1 as the pseudorandom
+     * function.  It gives the same result as Pbkdf2 with an HMAC-SHA-1
+     * function, but compresses the padded password only once, and then
+     * computes each iteration with exactly two compressions and no memory
+     * allocation.
+     *
+     * @param[in] password
+     *     This points to the master password from which a derived key
+     *     is generated.
+     *
+     * @param[in] passwordLength
+     *     This is the length of the password, in bytes.
+     *
+     * @param[in] salt
+     *     This points to the cryptographic salt.
+     *
+     * @param[in] saltLength
+     *     This is the length of the salt, in bytes.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[out] dk
+     *     This is where to store the derived key.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     */
+    void Pbkdf2HmacSha1(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    );
+
+    /**
+     * This function computes PBKDF2 using HMAC-SHA-1 as the pseudorandom
+     * function, compressing the padded password only once.
+     *
+     * @param[in] password
+     *     This is the master password from which a derived key is generated.
+     *
+     * @param[in] salt
+     *     This is the cryptographic salt.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     *
+     * @return
+     *     The derived key is returned.
+     */
+    std::vector< uint8_t > Pbkdf2HmacSha1(
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    );
+
+    /**
+     * This function computes PBKDF2 using HMAC-SHA-256 as the pseudorandom
+     * function.  It gives the same result as Pbkdf2 with an HMAC-SHA-256
+     * function, but compresses the padded password only once, and then
+     * computes each iteration with exactly two compressions and no memory
+     * allocation.
+     *
+     * @param[in] password
+     *     This points to the master password from which a derived key
+     *     is generated.
+     *
+     * @param[in] passwordLength
+     *     This is the length of the password, in bytes.
+     *
+     * @param[in] salt
+     *     This points to the cryptographic salt.
+     *
+     * @param[in] saltLength
+     *     This is the length of the salt, in bytes.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[out] dk
+     *     This is where to store the derived key.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     */
+    void Pbkdf2HmacSha256(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    );
+
+    /**
+     * This function computes PBKDF2 using HMAC-SHA-256 as the pseudorandom
+     * function, compressing the padded password only once.
+     *
+     * @param[in] password
+     *     This is the master password from which a derived key is generated.
+     *
+     * @param[in] salt
+     *     This is the cryptographic salt.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     *
+     * @return
+     *     The derived key is returned.
+     */
+    std::vector< uint8_t > Pbkdf2HmacSha256(
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    );
+
+    /**
+     * This function computes PBKDF2 using HMAC-SHA-512 as the pseudorandom
+     * function.  It gives the same result as Pbkdf2 with an HMAC-SHA-512
+     * function, but compresses the padded password only once, and then
+     * computes each iteration with exactly two compressions and no memory
+     * allocation.
+     *
+     * @param[in] password
+     *     This points to the master password from which a derived key
+     *     is generated.
+     *
+     * @param[in] passwordLength
+     *     This is the length of the password, in bytes.
+     *
+     * @param[in] salt
+     *     This points to the cryptographic salt.
+     *
+     * @param[in] saltLength
+     *     This is the length of the salt, in bytes.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[out] dk
+     *     This is where to store the derived key.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     */
+    void Pbkdf2HmacSha512(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    );
+
+    /**
+     * This function computes PBKDF2 using HMAC-SHA-512 as the pseudorandom
+     * function, compressing the padded password only once.
+     *
+     * @param[in] password
+     *     This is the master password from which a derived key is generated.
+     *
+     * @param[in] salt
+     *     This is the cryptographic salt.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     *
+     * @return
+     *     The derived key is returned.
+     */
+    std::vector< uint8_t > Pbkdf2HmacSha512(
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    );
+
+    /**
+     * This function computes PBKDF2 using HMAC as the pseudorandom function,
+     * with the hash function computed by the given context class (for
+     * example, Hash::Sha256Context), for many independent derivations at
+     * once, each with its own password, salt, iteration count, and derived
+     * key length.  It's provided for each of the context classes of this
+     * library.
+     *
+     * For Hash::Sha1Context, Hash::Sha256Context, and Hash::Sha512Context,
+     * the derivations are split into chains of iterations, one for each
+     * block of each derived key, which share the lanes of a multi-buffer
+     * compression kernel, if there is one.  Each lane is given the next
+     * chain as soon as it finishes the one it has.  With SHA-256, eight
+     * chains of iterations run at once on CPUs with AVX2 but without the
+     * SHA extensions.  With SHA-512, four chains of iterations run at once
+     * with AVX2, or eight with AVX-512.  For the other context classes,
+     * the derivations are computed one after another with Pbkdf2Hmac.
+     *
+     * @param[in] jobs
+     *     These are the derivations to compute.
+     *
+     * @param[in] numJobs
+     *     This is the number of derivations to compute.
+     */
+    template< typename HashContext > void Pbkdf2HmacBatch(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    );
+
+    template<> void Pbkdf2HmacBatch< Sha1Context >(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    );
+
+    template<> void Pbkdf2HmacBatch< Sha256Context >(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    );
+
+    template<> void Pbkdf2HmacBatch< Sha512Context >(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    );
+
+    /**
+     * This holds the result of measuring how long PBKDF2 iterations take
+     * on the current machine.
+     */
+    struct Pbkdf2Calibration {
+        /**
+         * This is the largest number of iterations which compute one block
+         * of a derived key within the latency budget given for the
+         * calibration, or one if even one iteration takes longer.
+         */
+        size_t c;
+
+        /**
+         * This is the measured time taken by each iteration, for each
+         * block of a derived key, in nanoseconds.  Multiplying it by the
+         * number of iterations and the number of blocks in a derived key
+         * estimates how long the derivation takes on one thread.
+         */
+        double nanosecondsPerIteration;
+    };
+
+    /**
+     * This function measures how long PBKDF2 iterations take on the current
+     * machine using the given pseudorandom function, and determines how many
+     * iterations fit within the given latency budget.
+     *
+     * The iteration count used for the measurement is doubled until one
+     * block of a derived key takes a measurable amount of time, and then
+     * the fastest of a few timed derivations is used, so that the
+     * calibration itself takes roughly no more than the budget.
+     *
+     * @param[in] prf
+     *     This is a pseudorandom function of two parameters with output
+     *     length hLen (e.g., a keyed HMAC)
+     *
+     * @param[in] hLen
+     *     This is the output length, in bits, of the PRF.
+     *
+     * @param[in] budget
+     *     This is the time allowed for computing one block of a derived
+     *     key.
+     *
+     * @return
+     *     The iteration count which fits the budget, along with the
+     *     measured time per iteration, is returned.
+     */
+    Pbkdf2Calibration Pbkdf2Calibrate(
+        std::function<
+            std::vector< uint8_t >(
+                const std::vector< uint8_t >&,
+                const std::vector< uint8_t >&
+            )
+        > prf,
+        size_t hLen,
+        std::chrono::nanoseconds budget
+    );
+
+    /**
+     * This function measures how long PBKDF2 iterations take on the current
+     * machine using HMAC as the pseudorandom function, with the hash
+     * function computed by the given context class (for example,
+     * Hash::Sha256Context), computed by Pbkdf2Hmac with the fastest kernel
+     * the CPU supports, and determines how many iterations fit within the
+     * given latency budget.  It's provided for each of the context classes
+     * of this library.
+     *
+     * @param[in] budget
+     *     This is the time allowed for computing one block of a derived
+     *     key.
+     *
+     * @return
+     *     The iteration count which fits the budget, along with the
+     *     measured time per iteration, is returned.
+     */
+    template< typename HashContext > Pbkdf2Calibration Pbkdf2HmacCalibrate(
+        std::chrono::nanoseconds budget
+    );
+
+    /**
+     * This function computes PBKDF2 using HMAC as the pseudorandom function,
+     * with the hash function computed by the given context class (for
+     * example, Hash::Sha384Context).  It gives the same result as Pbkdf2
+     * with the matching HMAC function, but the pseudorandom function is
+     * called directly rather than through a function object, and the padded
+     * password is compressed only once.  Each block of the derived key
+     * begins from a copy of the prepared password.
+     *
+     * For Hash::Sha1Context, Hash::Sha256Context, and Hash::Sha512Context,
+     * it's the same as Pbkdf2HmacSha1, Pbkdf2HmacSha256, or
+     * Pbkdf2HmacSha512.
+     *
+     * @param[in] password
+     *     This points to the master password from which a derived key
+     *     is generated.
+     *
+     * @param[in] passwordLength
+     *     This is the length of the password, in bytes.
+     *
+     * @param[in] salt
+     *     This points to the cryptographic salt.
+     *
+     * @param[in] saltLength
+     *     This is the length of the salt, in bytes.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[out] dk
+     *     This is where to store the derived key.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     */
+    template< typename HashContext > void Pbkdf2Hmac(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    ) {
+        constexpr size_t hLen = HmacContext< HashContext >::codeSize;
+        const HmacContext< HashContext > preparedPrf(password, passwordLength);
+        const auto computeBlock = [&](size_t index) {
+            const auto i = index + 1;
+            const uint8_t blockIndex[4] = {
+                (uint8_t)(i >> 24),
+                (uint8_t)(i >> 16),
+                (uint8_t)(i >> 8),
+                (uint8_t)i,
+            };
+            auto prf = preparedPrf;
+            uint8_t u[hLen];
+            uint8_t t[hLen];
+            prf.Update(salt, saltLength);
+            prf.Update(blockIndex, sizeof(blockIndex));
+            prf.Final(u);
+            (void)memcpy(t, u, hLen);
+            for (size_t j = 1; j < c; ++j) {
+                prf.Update(u, hLen);
+                prf.Final(u);
+                for (size_t k = 0; k < hLen; ++k) {
+                    t[k] ^= u[k];
+                }
+            }
+            const auto offset = index * hLen;
+            (void)memcpy(dk + offset, t, std::min(dkLen - offset, hLen));
+            Internal::Wipe(u, hLen);
+            Internal::Wipe(t, hLen);
+        };
+        const size_t l = (dkLen + hLen - 1) / hLen;
+        if (
+            (l > 1)
+            && executor
+        ) {
+            executor(l, computeBlock);
+        } else {
+            for (size_t index = 0; index < l; ++index) {
+                computeBlock(index);
+            }
+        }
+    }
+
+    template<> inline void Pbkdf2Hmac< Sha1Context >(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        Pbkdf2HmacSha1(password, passwordLength, salt, saltLength, c, dk, dkLen, executor);
+    }
+
+    template<> inline void Pbkdf2Hmac< Sha256Context >(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        Pbkdf2HmacSha256(password, passwordLength, salt, saltLength, c, dk, dkLen, executor);
+    }
+
+    template<> inline void Pbkdf2Hmac< Sha512Context >(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        Pbkdf2HmacSha512(password, passwordLength, salt, saltLength, c, dk, dkLen, executor);
+    }
+
+    /**
+     * This function computes PBKDF2 using HMAC as the pseudorandom function,
+     * with the hash function computed by the given context class (for
+     * example, Hash::Sha384Context), calling the pseudorandom function
+     * directly rather than through a function object.
+     *
+     * @param[in] password
+     *     This is the master password from which a derived key is generated.
+     *
+     * @param[in] salt
+     *     This is the cryptographic salt.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     This is used to compute the blocks of the derived key.  If it's
+     *     empty, the blocks are computed one after another.
+     *
+     * @return
+     *     The derived key is returned.
+     */
+    template< typename HashContext > std::vector< uint8_t > Pbkdf2Hmac(
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor = nullptr
+    ) {
+        std::vector< uint8_t > dk(dkLen);
+        Pbkdf2Hmac< HashContext >(
+            password.data(),
+            password.size(),
+            salt.data(),
+            salt.size(),
+            c,
+            dk.data(),
+            dkLen,
+            executor
+        );
+        return dk;
+    }
+
 }
 
 #endif /* HASH_PBKDF2_HPP */
@@ -0,0 +1,161 @@
+#ifndef HASH_SEGMENTS_HPP
+#define HASH_SEGMENTS_HPP
+
+/**
+ * @file Segments.hpp
+ *
+ * This module declares the function templates used to compute message
+ * digests and HMAC codes of messages which are split into segments held in
+ * separate buffers, without first copying the segments together.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HmacContext.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Hash {
+
+    /**
+     * This describes one segment of a message held in a separate buffer,
+     * in the same way as the iovec structure used by scatter/gather I/O.
+     */
+    struct HashSegment {
+        /**
+         * This points to the bytes of the segment.
+         */
+        const void* data;
+
+        /**
+         * This is the number of bytes in the segment.
+         */
+        size_t length;
+    };
+
+    /**
+     * This function computes the message digest of the message made up of
+     * the given segments, one after another, using the hash function
+     * computed by the given context class (for example,
+     * Hash::Sha256Context), storing it in the given buffer.  Each segment
+     * is hashed where it is, and segments need not be whole blocks, so
+     * the message is never copied together.
+     *
+     * @param[in] segments
+     *     These are the segments of the message, in order.
+     *
+     * @param[in] numSegments
+     *     This is the number of segments in the message.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for HashContextTraits< HashContext >::digestSize bytes.
+     */
+    template< typename HashContext > void ComputeDigestOfSegments(
+        const HashSegment* segments,
+        size_t numSegments,
+        uint8_t* digest
+    ) {
+        HashContext context;
+        for (size_t i = 0; i < numSegments; ++i) {
+            context.Update(segments[i].data, segments[i].length);
+        }
+        context.Final(digest);
+    }
+
+    /**
+     * This function computes the message digest of the message made up of
+     * the given segments, one after another, using the hash function
+     * computed by the given context class (for example,
+     * Hash::Sha256Context), without copying the message together.
+     *
+     * @param[in] segments
+     *     These are the segments of the message, in order.
+     *
+     * @return
+     *     The message digest is returned as a vector of bytes.
+     */
+    template< typename HashContext > std::vector< uint8_t > ComputeDigestOfSegments(
+        const std::vector< HashSegment >& segments
+    ) {
+        std::vector< uint8_t > digest(HashContextTraits< HashContext >::digestSize);
+        ComputeDigestOfSegments< HashContext >(
+            segments.data(),
+            segments.size(),
+            digest.data()
+        );
+        return digest;
+    }
+
+    /**
+     * This function computes the HMAC code of the message made up of the
+     * given segments, one after another, with the given key, using the
+     * hash function computed by the given context class (for example,
+     * Hash::Sha256Context), storing it in the given buffer.  Neither the
+     * message nor the padded keys are ever copied together.
+     *
+     * @param[in] key
+     *     This points to the key to use.
+     *
+     * @param[in] keyLength
+     *     This is the length of the key, in bytes.
+     *
+     * @param[in] segments
+     *     These are the segments of the message, in order.
+     *
+     * @param[in] numSegments
+     *     This is the number of segments in the message.
+     *
+     * @param[out] code
+     *     This is where to store the HMAC code.  It must have room for
+     *     HmacContext< HashContext >::codeSize bytes.
+     */
+    template< typename HashContext > void ComputeHmacOfSegments(
+        const void* key,
+        size_t keyLength,
+        const HashSegment* segments,
+        size_t numSegments,
+        uint8_t* code
+    ) {
+        HmacContext< HashContext > hmac(key, keyLength);
+        for (size_t i = 0; i < numSegments; ++i) {
+            hmac.Update(segments[i].data, segments[i].length);
+        }
+        hmac.Final(code);
+    }
+
+    /**
+     * This function computes the HMAC code of the message made up of the
+     * given segments, one after another, with the given key, using the
+     * hash function computed by the given context class (for example,
+     * Hash::Sha256Context), without copying the message together.
+     *
+     * @param[in] key
+     *     This is the key to use.
+     *
+     * @param[in] segments
+     *     These are the segments of the message, in order.
+     *
+     * @return
+     *     The HMAC code is returned as a vector of bytes.
+     */
+    template< typename HashContext > std::vector< uint8_t > ComputeHmacOfSegments(
+        const std::vector< uint8_t >& key,
+        const std::vector< HashSegment >& segments
+    ) {
+        std::vector< uint8_t > code(HmacContext< HashContext >::codeSize);
+        ComputeHmacOfSegments< HashContext >(
+            key.data(),
+            key.size(),
+            segments.data(),
+            segments.size(),
+            code.data()
+        );
+        return code;
+    }
+
+}
+
+#endif /* HASH_SEGMENTS_HPP */
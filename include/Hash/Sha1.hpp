@@ -9,6 +9,7 @@
  * © 2016-2018 by Richard Walters
  */
 
+#include <array>
 #include <stddef.h>
 #include <stdint.h>
 #include <vector>
@@ -26,6 +27,11 @@ namespace Hash {
      */
     constexpr size_t SHA1_DIGEST_LENGTH = 160;
 
+    /**
+     * This is the type of a SHA-1 message digest.
+     */
+    using Sha1Digest = std::array< uint8_t, SHA1_DIGEST_LENGTH / 8 >;
+
     /**
      * This function computes the SHA-1 message digest of the given data.
      *
@@ -38,6 +44,128 @@ namespace Hash {
      */
     std::vector< uint8_t > Sha1(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the SHA-1 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for SHA1_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeSha1(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the SHA-1 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The SHA-1 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Sha1Digest ComputeSha1(const void* data, size_t length);
+
+    /**
+     * This class computes a SHA-1 message digest incrementally, taking
+     * the message in pieces of any size.  Only one partial block of the
+     * message is kept between updates, so memory use does not depend on the
+     * length of the message.
+     */
+    class Sha1Context {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new SHA-1
+         * message digest computation.
+         */
+        Sha1Context();
+
+        // Public methods
+    public:
+        /**
+         * This method discards any data given so far and begins a new
+         * message digest computation.
+         */
+        void Reset();
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This points to the data to append to the message.
+         *
+         * @param[in] length
+         *     This is the number of bytes to append to the message.
+         */
+        void Update(const void* data, size_t length);
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This is the data to append to the message.
+         */
+        void Update(const std::vector< uint8_t >& data);
+
+        /**
+         * This method completes the message digest computation and then
+         * resets the context so that it may be used for another message.
+         *
+         * @return
+         *     The message digest of all data given since the context
+         *     was constructed or last reset is returned as a vector of bytes.
+         */
+        std::vector< uint8_t > Final();
+
+        /**
+         * This method completes the message digest computation, storing
+         * the digest in the given buffer, and then resets the context so
+         * that it may be used for another message.
+         *
+         * @param[out] digest
+         *     This is where to store the message digest of all data given
+         *     since the context was constructed or last reset.  It must
+         *     have room for SHA1_DIGEST_LENGTH / 8 bytes.
+         */
+        void Final(uint8_t* digest);
+
+        // Private properties
+    private:
+        /**
+         * These are the current hash values of the computation.
+         */
+        uint32_t state_[5];
+
+        /**
+         * This holds the part of the message not yet compressed, which
+         * is always less than one block.
+         */
+        uint8_t buffer_[SHA1_BLOCK_SIZE];
+
+        /**
+         * This is the number of bytes currently held in the buffer.
+         */
+        size_t bufferLength_ = 0;
+
+        /**
+         * This is the number of bytes of the message given so far.
+         */
+        uint64_t messageLength_ = 0;
+    };
+
 }
 
 #endif /* HASH_SHA1_HPP */
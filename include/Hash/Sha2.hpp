@@ -9,6 +9,7 @@
  * © 2018 by Richard Walters
  */
 
+#include <array>
 #include <stddef.h>
 #include <stdint.h>
 #include <vector>
@@ -30,6 +31,72 @@ namespace Hash {
      */
     constexpr size_t SHA512_BLOCK_SIZE = 128;
 
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-224 hash
+     * function.
+     */
+    constexpr size_t SHA224_DIGEST_LENGTH = 224;
+
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-256 hash
+     * function.
+     */
+    constexpr size_t SHA256_DIGEST_LENGTH = 256;
+
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-384 hash
+     * function.
+     */
+    constexpr size_t SHA384_DIGEST_LENGTH = 384;
+
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-512/224 hash
+     * function.
+     */
+    constexpr size_t SHA512T224_DIGEST_LENGTH = 224;
+
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-512/256 hash
+     * function.
+     */
+    constexpr size_t SHA512T256_DIGEST_LENGTH = 256;
+
+    /**
+     * This is the size, in bits, of the digest produced by the SHA-512 hash
+     * function.
+     */
+    constexpr size_t SHA512_DIGEST_LENGTH = 512;
+
+    /**
+     * This is the type of a SHA-224 message digest.
+     */
+    using Sha224Digest = std::array< uint8_t, SHA224_DIGEST_LENGTH / 8 >;
+
+    /**
+     * This is the type of a SHA-256 message digest.
+     */
+    using Sha256Digest = std::array< uint8_t, SHA256_DIGEST_LENGTH / 8 >;
+
+    /**
+     * This is the type of a SHA-384 message digest.
+     */
+    using Sha384Digest = std::array< uint8_t, SHA384_DIGEST_LENGTH / 8 >;
+
+    /**
+     * This is the type of a SHA-512/224 message digest.
+     */
+    using Sha512t224Digest = std::array< uint8_t, SHA512T224_DIGEST_LENGTH / 8 >;
+
+    /**
+     * This is the type of a SHA-512/256 message digest.
+     */
+    using Sha512t256Digest = std::array< uint8_t, SHA512T256_DIGEST_LENGTH / 8 >;
+
+    /**
+     * This is the type of a SHA-512 message digest.
+     */
+    using Sha512Digest = std::array< uint8_t, SHA512_DIGEST_LENGTH / 8 >;
+
     /**
      * This function computes the SHA-224 message digest of the given data.
      *
@@ -42,6 +109,38 @@ namespace Hash {
      */
     std::vector< uint8_t > Sha224(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the SHA-224 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for SHA224_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeSha224(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the SHA-224 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The SHA-224 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Sha224Digest ComputeSha224(const void* data, size_t length);
+
     /**
      * This function computes the SHA-256 message digest of the given data.
      *
@@ -54,6 +153,38 @@ namespace Hash {
      */
     std::vector< uint8_t > Sha256(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the SHA-256 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for SHA256_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeSha256(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the SHA-256 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The SHA-256 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Sha256Digest ComputeSha256(const void* data, size_t length);
+
     /**
      * This function computes the SHA-384 message digest of the given data.
      *
@@ -66,6 +197,38 @@ namespace Hash {
      */
     std::vector< uint8_t > Sha384(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the SHA-384 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for SHA384_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeSha384(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the SHA-384 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The SHA-384 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Sha384Digest ComputeSha384(const void* data, size_t length);
+
     /**
      * This function computes the SHA-512/224 message digest of the given data.
      *
@@ -78,6 +241,38 @@ namespace Hash {
      */
     std::vector< uint8_t > Sha512t224(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the SHA-512/224 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for SHA512T224_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeSha512t224(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the SHA-512/224 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The SHA-512/224 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Sha512t224Digest ComputeSha512t224(const void* data, size_t length);
+
     /**
      * This function computes the SHA-512/256 message digest of the given data.
      *
@@ -90,6 +285,38 @@ namespace Hash {
      */
     std::vector< uint8_t > Sha512t256(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the SHA-512/256 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for SHA512T256_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeSha512t256(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the SHA-512/256 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The SHA-512/256 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Sha512t256Digest ComputeSha512t256(const void* data, size_t length);
+
     /**
      * This function computes the SHA-512 message digest of the given data.
      *
@@ -102,6 +329,556 @@ namespace Hash {
      */
     std::vector< uint8_t > Sha512(const std::vector< uint8_t >& data);
 
+    /**
+     * This function computes the SHA-512 message digest of the given data,
+     * storing it in the given buffer without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @param[out] digest
+     *     This is where to store the message digest.  It must have room
+     *     for SHA512_DIGEST_LENGTH / 8 bytes.
+     */
+    void ComputeSha512(const void* data, size_t length, uint8_t* digest);
+
+    /**
+     * This function computes the SHA-512 message digest of the given data,
+     * without allocating any memory.
+     *
+     * @param[in] data
+     *     This points to the data for which to compute the message digest.
+     *
+     * @param[in] length
+     *     This is the number of bytes of data.
+     *
+     * @return
+     *     The SHA-512 message digest of the given data is returned
+     *     as a fixed-size array of bytes.
+     */
+    Sha512Digest ComputeSha512(const void* data, size_t length);
+
+    /**
+     * This function computes the SHA-256 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     This points to the first byte of each message.
+     *
+     * @param[in] lengths
+     *     These are the lengths, in bytes, of the messages.
+     *
+     * @param[in] numMessages
+     *     This is the number of messages.
+     *
+     * @param[out] digests
+     *     This is where to store the 32-byte SHA-256 message digests,
+     *     one after the other, in the same order as the messages.
+     *     It must have room for numMessages * 32 bytes.
+     */
+    void Sha256Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    );
+
+    /**
+     * This function computes the SHA-256 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     These are the messages for which to compute message digests.
+     *
+     * @return
+     *     The 32-byte SHA-256 message digests of the given messages are
+     *     returned one after the other, in the same order as the messages,
+     *     in a single vector of bytes.
+     */
+    std::vector< uint8_t > Sha256Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    );
+
+    /**
+     * This function computes the SHA-384 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     This points to the first byte of each message.
+     *
+     * @param[in] lengths
+     *     These are the lengths, in bytes, of the messages.
+     *
+     * @param[in] numMessages
+     *     This is the number of messages.
+     *
+     * @param[out] digests
+     *     This is where to store the 48-byte SHA-384 message digests,
+     *     one after the other, in the same order as the messages.
+     *     It must have room for numMessages * 48 bytes.
+     */
+    void Sha384Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    );
+
+    /**
+     * This function computes the SHA-384 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     These are the messages for which to compute message digests.
+     *
+     * @return
+     *     The 48-byte SHA-384 message digests of the given messages are
+     *     returned one after the other, in the same order as the messages,
+     *     in a single vector of bytes.
+     */
+    std::vector< uint8_t > Sha384Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    );
+
+    /**
+     * This function computes the SHA-512 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     This points to the first byte of each message.
+     *
+     * @param[in] lengths
+     *     These are the lengths, in bytes, of the messages.
+     *
+     * @param[in] numMessages
+     *     This is the number of messages.
+     *
+     * @param[out] digests
+     *     This is where to store the 64-byte SHA-512 message digests,
+     *     one after the other, in the same order as the messages.
+     *     It must have room for numMessages * 64 bytes.
+     */
+    void Sha512Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    );
+
+    /**
+     * This function computes the SHA-512 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     These are the messages for which to compute message digests.
+     *
+     * @return
+     *     The 64-byte SHA-512 message digests of the given messages are
+     *     returned one after the other, in the same order as the messages,
+     *     in a single vector of bytes.
+     */
+    std::vector< uint8_t > Sha512Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    );
+
+    /**
+     * This function computes the SHA-512/224 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     This points to the first byte of each message.
+     *
+     * @param[in] lengths
+     *     These are the lengths, in bytes, of the messages.
+     *
+     * @param[in] numMessages
+     *     This is the number of messages.
+     *
+     * @param[out] digests
+     *     This is where to store the 28-byte SHA-512/224 message digests,
+     *     one after the other, in the same order as the messages.
+     *     It must have room for numMessages * 28 bytes.
+     */
+    void Sha512t224Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    );
+
+    /**
+     * This function computes the SHA-512/224 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     These are the messages for which to compute message digests.
+     *
+     * @return
+     *     The 28-byte SHA-512/224 message digests of the given messages are
+     *     returned one after the other, in the same order as the messages,
+     *     in a single vector of bytes.
+     */
+    std::vector< uint8_t > Sha512t224Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    );
+
+    /**
+     * This function computes the SHA-512/256 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     This points to the first byte of each message.
+     *
+     * @param[in] lengths
+     *     These are the lengths, in bytes, of the messages.
+     *
+     * @param[in] numMessages
+     *     This is the number of messages.
+     *
+     * @param[out] digests
+     *     This is where to store the 32-byte SHA-512/256 message digests,
+     *     one after the other, in the same order as the messages.
+     *     It must have room for numMessages * 32 bytes.
+     */
+    void Sha512t256Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    );
+
+    /**
+     * This function computes the SHA-512/256 message digests of many
+     * independent messages at once.  Where the CPU supports it, the
+     * messages are hashed in parallel, several at a time.
+     *
+     * @param[in] messages
+     *     These are the messages for which to compute message digests.
+     *
+     * @return
+     *     The 32-byte SHA-512/256 message digests of the given messages are
+     *     returned one after the other, in the same order as the messages,
+     *     in a single vector of bytes.
+     */
+    std::vector< uint8_t > Sha512t256Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    );
+
+    /**
+     * This class computes a SHA-256 message digest incrementally, taking
+     * the message in pieces of any size.  Only one partial block of the
+     * message is kept between updates, so memory use does not depend on the
+     * length of the message.
+     */
+    class Sha256Context {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new SHA-256
+         * message digest computation.
+         */
+        Sha256Context();
+
+        // Public methods
+    public:
+        /**
+         * This method discards any data given so far and begins a new
+         * message digest computation.
+         */
+        void Reset();
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This points to the data to append to the message.
+         *
+         * @param[in] length
+         *     This is the number of bytes to append to the message.
+         */
+        void Update(const void* data, size_t length);
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This is the data to append to the message.
+         */
+        void Update(const std::vector< uint8_t >& data);
+
+        /**
+         * This method completes the message digest computation and then
+         * resets the context so that it may be used for another message.
+         *
+         * @return
+         *     The message digest of all data given since the context
+         *     was constructed or last reset is returned as a vector of bytes.
+         */
+        std::vector< uint8_t > Final();
+
+        /**
+         * This method completes the message digest computation, storing
+         * the digest in the given buffer, and then resets the context so
+         * that it may be used for another message.
+         *
+         * @param[out] digest
+         *     This is where to store the message digest of all data given
+         *     since the context was constructed or last reset.  It must
+         *     have room for the digest size of the variant
+         *     (SHA256_DIGEST_LENGTH / 8 bytes for SHA-256, or
+         *     SHA224_DIGEST_LENGTH / 8 bytes for SHA-224).
+         */
+        void Final(uint8_t* digest);
+
+        // Protected methods
+    protected:
+        /**
+         * This constructor begins a new message digest computation of a
+         * variant of SHA-256, using the given initial hash values and
+         * producing a digest of the given size.
+         *
+         * @param[in] initialHashValues
+         *     These are the eight initial hash values of the variant.
+         *
+         * @param[in] digestSize
+         *     This is the number of bytes to output for the digest.
+         */
+        Sha256Context(
+            const uint32_t* initialHashValues,
+            size_t digestSize
+        );
+
+        // Private properties
+    private:
+        /**
+         * These are the initial hash values used to begin a computation.
+         */
+        uint32_t initialHashValues_[8];
+
+        /**
+         * These are the current hash values of the computation.
+         */
+        uint32_t state_[8];
+
+        /**
+         * This holds the part of the message not yet compressed, which
+         * is always less than one block.
+         */
+        uint8_t buffer_[SHA256_BLOCK_SIZE];
+
+        /**
+         * This is the number of bytes currently held in the buffer.
+         */
+        size_t bufferLength_ = 0;
+
+        /**
+         * This is the number of bytes of the message given so far.
+         */
+        uint64_t messageLength_ = 0;
+
+        /**
+         * This is the number of bytes to output for the digest.
+         */
+        size_t digestSize_;
+    };
+
+    /**
+     * This class computes a SHA-224 message digest incrementally, taking
+     * the message in pieces of any size.
+     */
+    class Sha224Context
+        : public Sha256Context
+    {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new SHA-224
+         * message digest computation.
+         */
+        Sha224Context();
+    };
+
+    /**
+     * This class computes a SHA-512 message digest incrementally, taking
+     * the message in pieces of any size.  Only one partial block of the
+     * message is kept between updates, so memory use does not depend on the
+     * length of the message.
+     */
+    class Sha512Context {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new SHA-512
+         * message digest computation.
+         */
+        Sha512Context();
+
+        // Public methods
+    public:
+        /**
+         * This method discards any data given so far and begins a new
+         * message digest computation.
+         */
+        void Reset();
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This points to the data to append to the message.
+         *
+         * @param[in] length
+         *     This is the number of bytes to append to the message.
+         */
+        void Update(const void* data, size_t length);
+
+        /**
+         * This method appends the given data to the message for which
+         * the digest is being computed.
+         *
+         * @param[in] data
+         *     This is the data to append to the message.
+         */
+        void Update(const std::vector< uint8_t >& data);
+
+        /**
+         * This method completes the message digest computation and then
+         * resets the context so that it may be used for another message.
+         *
+         * @return
+         *     The message digest of all data given since the context
+         *     was constructed or last reset is returned as a vector of bytes.
+         */
+        std::vector< uint8_t > Final();
+
+        /**
+         * This method completes the message digest computation, storing
+         * the digest in the given buffer, and then resets the context so
+         * that it may be used for another message.
+         *
+         * @param[out] digest
+         *     This is where to store the message digest of all data given
+         *     since the context was constructed or last reset.  It must
+         *     have room for the digest size of the variant
+         *     (for example, SHA512_DIGEST_LENGTH / 8 bytes for SHA-512).
+         */
+        void Final(uint8_t* digest);
+
+        // Protected methods
+    protected:
+        /**
+         * This constructor begins a new message digest computation of a
+         * variant of SHA-512, using the given initial hash values and
+         * producing a digest of the given size.
+         *
+         * @param[in] initialHashValues
+         *     These are the eight initial hash values of the variant.
+         *
+         * @param[in] digestSize
+         *     This is the number of bytes to output for the digest.
+         */
+        Sha512Context(
+            const uint64_t* initialHashValues,
+            size_t digestSize
+        );
+
+        // Private properties
+    private:
+        /**
+         * These are the initial hash values used to begin a computation.
+         */
+        uint64_t initialHashValues_[8];
+
+        /**
+         * These are the current hash values of the computation.
+         */
+        uint64_t state_[8];
+
+        /**
+         * This holds the part of the message not yet compressed, which
+         * is always less than one block.
+         */
+        uint8_t buffer_[SHA512_BLOCK_SIZE];
+
+        /**
+         * This is the number of bytes currently held in the buffer.
+         */
+        size_t bufferLength_ = 0;
+
+        /**
+         * This is the number of bytes of the message given so far.
+         */
+        uint64_t messageLength_ = 0;
+
+        /**
+         * This is the number of bytes to output for the digest.
+         */
+        size_t digestSize_;
+    };
+
+    /**
+     * This class computes a SHA-384 message digest incrementally, taking
+     * the message in pieces of any size.
+     */
+    class Sha384Context
+        : public Sha512Context
+    {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new SHA-384
+         * message digest computation.
+         */
+        Sha384Context();
+    };
+
+    /**
+     * This class computes a SHA-512/224 message digest incrementally, taking
+     * the message in pieces of any size.
+     */
+    class Sha512t224Context
+        : public Sha512Context
+    {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new SHA-512/224
+         * message digest computation.
+         */
+        Sha512t224Context();
+    };
+
+    /**
+     * This class computes a SHA-512/256 message digest incrementally, taking
+     * the message in pieces of any size.
+     */
+    class Sha512t256Context
+        : public Sha512Context
+    {
+        // Lifecycle management
+    public:
+        /**
+         * This is the default constructor, which begins a new SHA-512/256
+         * message digest computation.
+         */
+        Sha512t256Context();
+    };
+
 }
 
 #endif /* HASH_SHA2_HPP */
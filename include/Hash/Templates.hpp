@@ -10,13 +10,24 @@
  * © 2018 by Richard Walters
  */
 
-#include <iomanip>
-#include <sstream>
+#include "Hex.hpp"
+#include "Md5.hpp"
+#include "Sha1.hpp"
+#include "Sha2.hpp"
+
+#include <stddef.h>
 #include <stdint.h>
 #include <string>
 #include <string.h>
 #include <vector>
 
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+#define HASH_HAS_STRING_VIEW 1
+#include <string_view>
+#else
+#define HASH_HAS_STRING_VIEW 0
+#endif
+
 namespace Hash {
 
     /**
@@ -31,6 +42,98 @@ namespace Hash {
      */
     using HashFunction = std::vector< uint8_t >(*)(const std::vector< uint8_t >& message);
 
+    /**
+     * This class template is used to compute the message digest of data
+     * given as a pointer and length, using the given hash function.
+     *
+     * This general form works with any hash function, but has to copy the
+     * data into a vector first.  It is specialized below for the hash
+     * functions of this library, which hash the data in place.
+     */
+    template< HashFunction hash > struct InPlaceHash {
+        /**
+         * This function computes the message digest of the given data.
+         *
+         * @param[in] data
+         *     This points to the data for which to compute the message
+         *     digest.
+         *
+         * @param[in] length
+         *     This is the number of bytes of data.
+         *
+         * @return
+         *     The message digest of the given data is returned
+         *     as a vector of bytes.
+         */
+        static std::vector< uint8_t > Compute(const void* data, size_t length) {
+            const auto bytes = (const uint8_t*)data;
+            return hash(std::vector< uint8_t >(bytes, bytes + length));
+        }
+    };
+
+    /**
+     * This class template is the common base of the specializations of
+     * InPlaceHash for hash functions which have a pointer and length form
+     * producing a digest of fixed size.
+     */
+    template<
+        size_t digestSize,
+        void (*compute)(const void* data, size_t length, uint8_t* digest)
+    > struct FixedSizeInPlaceHash {
+        /**
+         * This function computes the message digest of the given data,
+         * without copying it.
+         *
+         * @param[in] data
+         *     This points to the data for which to compute the message
+         *     digest.
+         *
+         * @param[in] length
+         *     This is the number of bytes of data.
+         *
+         * @return
+         *     The message digest of the given data is returned
+         *     as a vector of bytes.
+         */
+        static std::vector< uint8_t > Compute(const void* data, size_t length) {
+            std::vector< uint8_t > digest(digestSize);
+            compute(data, length, digest.data());
+            return digest;
+        }
+    };
+
+    template<> struct InPlaceHash< Md5 >
+        : FixedSizeInPlaceHash< MD5_DIGEST_LENGTH / 8, ComputeMd5 > {};
+    template<> struct InPlaceHash< Sha1 >
+        : FixedSizeInPlaceHash< SHA1_DIGEST_LENGTH / 8, ComputeSha1 > {};
+    template<> struct InPlaceHash< Sha224 >
+        : FixedSizeInPlaceHash< SHA224_DIGEST_LENGTH / 8, ComputeSha224 > {};
+    template<> struct InPlaceHash< Sha256 >
+        : FixedSizeInPlaceHash< SHA256_DIGEST_LENGTH / 8, ComputeSha256 > {};
+    template<> struct InPlaceHash< Sha384 >
+        : FixedSizeInPlaceHash< SHA384_DIGEST_LENGTH / 8, ComputeSha384 > {};
+    template<> struct InPlaceHash< Sha512 >
+        : FixedSizeInPlaceHash< SHA512_DIGEST_LENGTH / 8, ComputeSha512 > {};
+    template<> struct InPlaceHash< Sha512t224 >
+        : FixedSizeInPlaceHash< SHA512T224_DIGEST_LENGTH / 8, ComputeSha512t224 > {};
+    template<> struct InPlaceHash< Sha512t256 >
+        : FixedSizeInPlaceHash< SHA512T256_DIGEST_LENGTH / 8, ComputeSha512t256 > {};
+
+    /**
+     * This function returns the given message digest as a string of
+     * hex digits.
+     *
+     * @param[in] digest
+     *     This is the message digest to convert.
+     *
+     * @return
+     *     The given message digest is returned as a string of
+     *     hexadecimal digits.
+     */
+    inline std::string DigestToString(const std::vector< uint8_t >& digest) {
+        return EncodeHex(digest);
+    }
+
     /**
      * This function template is used to compute the message digest of the
      * given data and return it as a string of hex digits.
@@ -43,13 +146,7 @@ namespace Hash {
      *     as a string of hexadecimal digits.
      */
     template< HashFunction hash > std::string BytesToString(const std::vector< uint8_t >& data) {
-        const auto digest = hash(data);
-        std::ostringstream digestStringBuilder;
-        digestStringBuilder << std::hex << std::setfill('0');
-        for (auto digestByte: digest) {
-            digestStringBuilder << std::setw(2) << (int)digestByte;
-        }
-        return digestStringBuilder.str();
+        return DigestToString(hash(data));
     }
 
     /**
@@ -64,11 +161,7 @@ namespace Hash {
      *     as a string of hexadecimal digits.
      */
     template< HashFunction hash > std::string StringToString(const std::string& data) {
-        std::vector< uint8_t > dataAsVector(data.length());
-        if (!dataAsVector.empty()) {
-            (void)memcpy(dataAsVector.data(), data.c_str(), dataAsVector.size());
-        }
-        return BytesToString< hash >(dataAsVector);
+        return DigestToString(InPlaceHash< hash >::Compute(data.data(), data.length()));
     }
 
     /**
@@ -83,12 +176,40 @@ namespace Hash {
      *     as a vector of bytes.
      */
     template< HashFunction hash > std::vector< uint8_t > StringToBytes(const std::string& data) {
-        std::vector< uint8_t > dataAsVector(data.length());
-        if (!dataAsVector.empty()) {
-            (void)memcpy(dataAsVector.data(), data.c_str(), dataAsVector.size());
-        }
-        return hash(dataAsVector);
+        return InPlaceHash< hash >::Compute(data.data(), data.length());
+    }
+
+#if HASH_HAS_STRING_VIEW
+    /**
+     * This function template is used to compute the message digest of the
+     * given string view data and return it as a string of hex digits.
+     *
+     * @param[in] data
+     *     This is the data for which to compute the message digest.
+     *
+     * @return
+     *     The message digest of the given data is returned
+     *     as a string of hexadecimal digits.
+     */
+    template< HashFunction hash > std::string StringViewToString(std::string_view data) {
+        return DigestToString(InPlaceHash< hash >::Compute(data.data(), data.length()));
+    }
+
+    /**
+     * This function template is used to compute the message digest of the
+     * given string view data and return it as a byte vector.
+     *
+     * @param[in] data
+     *     This is the data for which to compute the message digest.
+     *
+     * @return
+     *     The message digest of the given data is returned
+     *     as a vector of bytes.
+     */
+    template< HashFunction hash > std::vector< uint8_t > StringViewToBytes(std::string_view data) {
+        return InPlaceHash< hash >::Compute(data.data(), data.length());
     }
+#endif
 
 }
 
@@ -0,0 +1,479 @@
+#ifndef HASH_TOTP_TABLE_HPP
+#define HASH_TOTP_TABLE_HPP
+
+/**
+ * @file TotpTable.hpp
+ *
+ * This module declares the Hash::TotpTable class template, which keeps the
+ * current and next TOTP one-time passwords of many shared secrets, computed
+ * ahead of time on a background thread.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HmacContext.hpp"
+#include "Otp.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Hash {
+
+    /**
+     * This class template keeps a table of the TOTP one-time passwords, as
+     * defined in [RFC 6238](https://tools.ietf.org/html/rfc6238), of a
+     * fixed set of shared secrets, for the current and next time steps,
+     * using HMAC with the hash function computed by the given context
+     * class (for example, Hash::Sha1Context).
+     *
+     * Once started, a background thread computes the passwords of every
+     * secret for each time step shortly before the step begins, so that
+     * looking up a password takes no HMAC computations.  Lookups don't
+     * take any locks, and may be done from any number of threads at once.
+     *
+     * Each secret keeps the passwords of its four most recent time steps,
+     * so the previous step's password also remains available, to allow
+     * for clock drift.
+     *
+     * Only the HMAC midstates of each secret are kept (see OtpMidstates),
+     * so the table holds the given context class's OtpMidstates::size
+     * bytes plus 32 bytes of passwords for each secret, and each password
+     * computed costs exactly two compressions and no memory allocations.
+     * The context class must be one for which OtpMidstates is specialized.
+     *
+     * Instead of starting the background thread, the table may also be
+     * kept up to date by calling Advance on a schedule of the
+     * application's own.
+     */
+    template< typename HashContext > class TotpTable {
+        // Lifecycle management
+    public:
+        ~TotpTable() noexcept {
+            Stop();
+            Internal::Wipe(
+                midstates_.get(),
+                numSecrets_ * OtpMidstates< HashContext >::size
+            );
+        }
+        TotpTable(const TotpTable&) = delete;
+        TotpTable(TotpTable&&) = delete;
+        TotpTable& operator=(const TotpTable&) = delete;
+        TotpTable& operator=(TotpTable&&) = delete;
+
+        /**
+         * This constructor prepares the table for the given shared
+         * secrets.  No passwords are computed until the table is started,
+         * advanced, or refreshed.
+         *
+         * @param[in] secrets
+         *     These are the shared secrets, identified in the table by
+         *     their indexes in this vector.
+         *
+         * @param[in] base
+         *     This is the UNIX time to start counting time steps.
+         *
+         * @param[in] step
+         *     This is the time step in seconds.
+         *
+         * @param[in] digits
+         *     This is the number of digits in each one-time password.
+         */
+        TotpTable(
+            const std::vector< std::string >& secrets,
+            uint64_t base,
+            uint64_t step,
+            size_t digits
+        )
+            : base_(base)
+            , step_(step)
+            , modulus_(OtpModulus(digits))
+            , numSecrets_(secrets.size())
+            , midstates_(new uint8_t[secrets.size() * OtpMidstates< HashContext >::size])
+            , entries_(new std::atomic< uint64_t >[secrets.size() * STEPS_KEPT])
+        {
+            for (size_t i = 0; i < numSecrets_; ++i) {
+                OtpMidstates< HashContext >::Key(
+                    secrets[i].data(),
+                    secrets[i].length(),
+                    midstates_.get() + i * OtpMidstates< HashContext >::size
+                );
+            }
+            for (size_t i = 0; i < numSecrets_ * STEPS_KEPT; ++i) {
+                entries_[i].store(EMPTY, std::memory_order_relaxed);
+            }
+        }
+
+        // Public methods
+    public:
+        /**
+         * This method computes the passwords of every secret for the time
+         * step containing the given UNIX time and the step after it.
+         *
+         * @param[in] time
+         *     This is the UNIX time for which to compute passwords.
+         */
+        void Refresh(uint64_t time) {
+            const auto t = (time - base_) / step_;
+            ComputeStep(t);
+            ComputeStep(t + 1);
+        }
+
+        /**
+         * This method starts the background thread which keeps the table
+         * up to date, after first computing the passwords for the current
+         * and next time steps.  It does nothing if the thread is already
+         * running.
+         *
+         * @param[in] lead
+         *     This is how many seconds before the start of each time step
+         *     to compute the passwords for the step after it.
+         */
+        void Start(uint64_t lead = 1) {
+            std::lock_guard< std::mutex > lock(mutex_);
+            if (worker_.joinable()) {
+                return;
+            }
+            (void)Advance(Now(), lead);
+            stop_ = false;
+            worker_ = std::thread(&TotpTable::Worker, this, lead);
+        }
+
+        /**
+         * This method brings the table up to date for the given UNIX time,
+         * the way the background thread does each time it wakes: it
+         * computes the passwords for the time step after the one
+         * containing the given time, and once the given time is within the
+         * lead time of the next step, the passwords for the step after
+         * that.  If the time has jumped since the last call, the
+         * passwords for the steps around the given time are all computed
+         * again.  Steps whose passwords were already computed by an
+         * earlier call aren't computed again.
+         *
+         * @param[in] time
+         *     This is the current UNIX time.
+         *
+         * @param[in] lead
+         *     This is how many seconds before the start of each time step
+         *     to compute the passwords for the step after it.  It's
+         *     limited to one second less than the time step.
+         *
+         * @return
+         *     The UNIX time at which this method should next be called
+         *     is returned.
+         */
+        uint64_t Advance(
+            uint64_t time,
+            uint64_t lead = 1
+        ) {
+            if (lead >= step_) {
+                lead = step_ - 1;
+            }
+            std::lock_guard< std::mutex > lock(advanceMutex_);
+
+            // Determine the last time step whose passwords should be in the
+            // table by now.  Normally that's the step after the current
+            // one, but it's the one after that once we're within the lead
+            // time of the next step.
+            const auto t = (time - base_) / step_;
+            auto next = t + 1;
+            if (time + lead >= base_ + next * step_) {
+                ++next;
+            }
+            if (
+                !advanced_
+                || (next < computed_)
+                || (next - computed_ > 1)
+            ) {
+                // The table is new, or the clock jumped, so every step
+                // around the current one needs to be computed.
+                for (auto u = ((next < 2) ? 0 : (next - 2)); u < next; ++u) {
+                    ComputeStep(u);
+                }
+                ComputeStep(next);
+            } else if (next != computed_) {
+                ComputeStep(next);
+            }
+            advanced_ = true;
+            computed_ = next;
+            return base_ + next * step_ - lead;
+        }
+
+        /**
+         * This method stops the background thread, if it's running.
+         * Passwords already in the table remain available.
+         */
+        void Stop() {
+            std::unique_lock< std::mutex > lock(mutex_);
+            if (!worker_.joinable()) {
+                return;
+            }
+            stop_ = true;
+            wakeWorker_.notify_all();
+            lock.unlock();
+            worker_.join();
+        }
+
+        /**
+         * This method looks up the one-time password of the given secret
+         * for the given UNIX time in the table.  It may be called from any
+         * thread.
+         *
+         * @param[in] index
+         *     This is the index of the secret, as given to the constructor.
+         *
+         * @param[in] time
+         *     This is the UNIX time for which to look up the password.
+         *
+         * @param[out] password
+         *     If the password is in the table, it's stored here.
+         *
+         * @return
+         *     An indication of whether or not the password is in the table
+         *     is returned.  It's false if there is no secret in the table
+         *     at the given index.
+         */
+        bool TryLookup(
+            size_t index,
+            uint64_t time,
+            int& password
+        ) const {
+            if (index >= numSecrets_) {
+                return false;
+            }
+            const auto t = (time - base_) / step_;
+            const auto entry = entries_[index * STEPS_KEPT + t % STEPS_KEPT].load(
+                std::memory_order_acquire
+            );
+            if (
+                (entry == EMPTY)
+                || ((entry >> 32) != (uint32_t)t)
+            ) {
+                return false;
+            }
+            password = (int)(entry & 0xFFFFFFFF);
+            return true;
+        }
+
+        /**
+         * This method returns the one-time password of the given secret
+         * for the given UNIX time, from the table if it's there, or by
+         * computing it otherwise.  It may be called from any thread.
+         *
+         * @param[in] index
+         *     This is the index of the secret, as given to the constructor.
+         *
+         * @param[in] time
+         *     This is the UNIX time for which to return the password.
+         *
+         * @return
+         *     The one-time password is returned, or -1 if there is no
+         *     secret in the table at the given index.
+         */
+        int Lookup(
+            size_t index,
+            uint64_t time
+        ) const {
+            if (index >= numSecrets_) {
+                return -1;
+            }
+            int password;
+            if (TryLookup(index, time, password)) {
+                return password;
+            }
+            return OtpMidstates< HashContext >::Hotp(
+                midstates_.get() + index * OtpMidstates< HashContext >::size,
+                (time - base_) / step_,
+                modulus_
+            );
+        }
+
+        /**
+         * This method returns the number of shared secrets in the table.
+         *
+         * @return
+         *     The number of shared secrets in the table is returned.
+         */
+        size_t Size() const {
+            return numSecrets_;
+        }
+
+        // Private methods
+    private:
+        /**
+         * This function returns the current UNIX time.
+         *
+         * @return
+         *     The current UNIX time is returned.
+         */
+        static uint64_t Now() {
+            return (uint64_t)std::chrono::duration_cast< std::chrono::seconds >(
+                std::chrono::system_clock::now().time_since_epoch()
+            ).count();
+        }
+
+        /**
+         * This method computes the passwords of every secret for the given
+         * time step, and stores them in the table.
+         *
+         * @param[in] t
+         *     This is the time step for which to compute passwords.
+         */
+        void ComputeStep(uint64_t t) {
+            for (size_t i = 0; i < numSecrets_; ++i) {
+                const auto code = (uint32_t)OtpMidstates< HashContext >::Hotp(
+                    midstates_.get() + i * OtpMidstates< HashContext >::size,
+                    t,
+                    modulus_
+                );
+                entries_[i * STEPS_KEPT + t % STEPS_KEPT].store(
+                    ((uint64_t)(uint32_t)t << 32) | code,
+                    std::memory_order_release
+                );
+            }
+        }
+
+        /**
+         * This method is run by the background thread.  It advances the
+         * table shortly before each time step begins, until the table is
+         * stopped.
+         *
+         * @param[in] lead
+         *     This is how many seconds before the start of each time step
+         *     to compute the passwords for the step after it.
+         */
+        void Worker(uint64_t lead) {
+            std::unique_lock< std::mutex > lock(mutex_);
+            while (!stop_) {
+                lock.unlock();
+                const auto wake = Advance(Now(), lead);
+                lock.lock();
+                if (stop_) {
+                    break;
+                }
+                (void)wakeWorker_.wait_until(
+                    lock,
+                    std::chrono::system_clock::time_point(
+                        std::chrono::seconds(wake)
+                    )
+                );
+            }
+        }
+
+        // Private properties
+    private:
+        /**
+         * This is the number of time steps for which each secret's
+         * passwords are kept.
+         */
+        static constexpr size_t STEPS_KEPT = 4;
+
+        /**
+         * This is the value of a table entry in which no password has been
+         * stored yet.  It can't be mistaken for a stored password,
+         * because passwords have at most 31 bits.
+         */
+        static constexpr uint64_t EMPTY = 0xFFFFFFFFFFFFFFFF;
+
+        /**
+         * This is the UNIX time to start counting time steps.
+         */
+        const uint64_t base_;
+
+        /**
+         * This is the time step in seconds.
+         */
+        const uint64_t step_;
+
+        /**
+         * This is the number by which the truncated HMAC code is reduced
+         * to produce a password, or zero if it isn't reduced.
+         */
+        const uint32_t modulus_;
+
+        /**
+         * This is the number of shared secrets in the table.
+         */
+        const size_t numSecrets_;
+
+        /**
+         * This holds the HMAC midstates of each secret, one after another.
+         * They're never modified after construction, and are wiped when
+         * the table is destroyed.
+         */
+        std::unique_ptr< uint8_t[] > midstates_;
+
+        /**
+         * This holds STEPS_KEPT entries for each secret, indexed by time
+         * step modulo STEPS_KEPT.  Each entry holds the lower 32 bits of
+         * its time step in its upper half, and the password in its lower
+         * half, so that it's read and written as a whole.
+         */
+        std::unique_ptr< std::atomic< uint64_t >[] > entries_;
+
+        /**
+         * This is used to synchronize advancing the table.
+         */
+        std::mutex advanceMutex_;
+
+        /**
+         * This indicates whether or not the table has been advanced yet.
+         */
+        bool advanced_ = false;
+
+        /**
+         * This is the last time step whose passwords were computed when
+         * the table was last advanced.
+         */
+        uint64_t computed_ = 0;
+
+        /**
+         * This is used to synchronize starting and stopping the background
+         * thread.
+         */
+        std::mutex mutex_;
+
+        /**
+         * This is used to wake the background thread when it's stopped.
+         */
+        std::condition_variable wakeWorker_;
+
+        /**
+         * This indicates whether or not the background thread should stop.
+         */
+        bool stop_ = false;
+
+        /**
+         * This is the background thread which keeps the table up to date.
+         */
+        std::thread worker_;
+    };
+
+    template< typename HashContext > constexpr size_t TotpTable< HashContext >::STEPS_KEPT;
+    template< typename HashContext > constexpr uint64_t TotpTable< HashContext >::EMPTY;
+
+    /**
+     * This is the TOTP table using HMAC-SHA-1.
+     */
+    using TotpSha1Table = TotpTable< Sha1Context >;
+
+    /**
+     * This is the TOTP table using HMAC-SHA-256.
+     */
+    using TotpSha256Table = TotpTable< Sha256Context >;
+
+    /**
+     * This is the TOTP table using HMAC-SHA-512.
+     */
+    using TotpSha512Table = TotpTable< Sha512Context >;
+
+}
+
+#endif /* HASH_TOTP_TABLE_HPP */
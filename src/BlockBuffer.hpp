@@ -0,0 +1,185 @@
+#ifndef HASH_BLOCK_BUFFER_HPP
+#define HASH_BLOCK_BUFFER_HPP
+
+/**
+ * @file BlockBuffer.hpp
+ *
+ * This module declares function templates used by the incremental hash
+ * contexts to carry partial blocks of input between updates and to apply
+ * the Merkle–Damgård padding shared by MD5, SHA-1, and SHA-2.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This function absorbs the given data into a hash computation,
+         * compressing as many whole blocks as possible and keeping any
+         * remainder in the given buffer for the next update.
+         *
+         * @param[in,out] buffer
+         *     This is the buffer holding a partial block of input which has
+         *     not yet been compressed.
+         *
+         * @param[in,out] bufferLength
+         *     This is the number of bytes currently held in the buffer.
+         *
+         * @param[in] data
+         *     This is the data to absorb.
+         *
+         * @param[in] length
+         *     This is the number of bytes of data to absorb.
+         *
+         * @param[in] compress
+         *     This is the function to call with a pointer to one or more
+         *     whole blocks and the number of blocks, in order to compress
+         *     them into the hash state.
+         */
+        template< size_t blockSize, typename Compress > void AbsorbData(
+            uint8_t* buffer,
+            size_t& bufferLength,
+            const uint8_t* data,
+            size_t length,
+            Compress compress
+        ) {
+            if (bufferLength > 0) {
+                const auto fill = (
+                    (length < blockSize - bufferLength)
+                    ? length
+                    : blockSize - bufferLength
+                );
+                (void)memcpy(buffer + bufferLength, data, fill);
+                bufferLength += fill;
+                data += fill;
+                length -= fill;
+                if (bufferLength < blockSize) {
+                    return;
+                }
+                compress(buffer, 1);
+                bufferLength = 0;
+            }
+            const auto numBlocks = length / blockSize;
+            if (numBlocks > 0) {
+                compress(data, numBlocks);
+                data += numBlocks * blockSize;
+                length -= numBlocks * blockSize;
+            }
+            if (length > 0) {
+                (void)memcpy(buffer, data, length);
+                bufferLength = length;
+            }
+        }
+
+        /**
+         * This function forms the final block or blocks of a hash
+         * computation by appending the padding and message length to the
+         * given remainder of the message.
+         *
+         * @param[out] finalBlocks
+         *     This is where to store the final blocks.  It must have room
+         *     for two blocks.
+         *
+         * @param[in] remainder
+         *     This points to the part of the message which does not fill
+         *     a whole block.
+         *
+         * @param[in] remainderLength
+         *     This is the number of bytes in the remainder of the message,
+         *     which must be less than one block.
+         *
+         * @param[in] messageLength
+         *     This is the total length of the message, in bytes.
+         *
+         * @return
+         *     The number of final blocks (either one or two) is returned.
+         */
+        template<
+            size_t blockSize,
+            size_t lengthFieldSize,
+            bool bigEndian
+        > size_t PadFinalBlocks(
+            uint8_t* finalBlocks,
+            const uint8_t* remainder,
+            size_t remainderLength,
+            uint64_t messageLength
+        ) {
+            const size_t numBlocks = (
+                (remainderLength + 1 > blockSize - lengthFieldSize)
+                ? 2
+                : 1
+            );
+            const auto finalLength = numBlocks * blockSize;
+            if (remainderLength > 0) {
+                (void)memcpy(finalBlocks, remainder, remainderLength);
+            }
+            finalBlocks[remainderLength] = 0x80;
+            (void)memset(
+                finalBlocks + remainderLength + 1,
+                0,
+                finalLength - remainderLength - 1
+            );
+            const uint64_t ml = messageLength * 8;
+            for (size_t i = 0; i < 8; ++i) {
+                const auto byte = (uint8_t)(ml >> (i * 8));
+                if (bigEndian) {
+                    finalBlocks[finalLength - 1 - i] = byte;
+                } else {
+                    finalBlocks[finalLength - lengthFieldSize + i] = byte;
+                }
+            }
+            return numBlocks;
+        }
+
+        /**
+         * This function appends the padding and message length to the
+         * partial block remaining in the given buffer, and compresses the
+         * final block or blocks of a hash computation.
+         *
+         * @param[in] buffer
+         *     This is the buffer holding a partial block of input which has
+         *     not yet been compressed.
+         *
+         * @param[in] bufferLength
+         *     This is the number of bytes currently held in the buffer.
+         *
+         * @param[in] messageLength
+         *     This is the total length of the message, in bytes.
+         *
+         * @param[in] compress
+         *     This is the function to call with a pointer to one or more
+         *     whole blocks and the number of blocks, in order to compress
+         *     them into the hash state.
+         */
+        template<
+            size_t blockSize,
+            size_t lengthFieldSize,
+            bool bigEndian,
+            typename Compress
+        > void PadAndCompress(
+            const uint8_t* buffer,
+            size_t bufferLength,
+            uint64_t messageLength,
+            Compress compress
+        ) {
+            uint8_t finalBlocks[blockSize * 2];
+            const auto numBlocks = PadFinalBlocks< blockSize, lengthFieldSize, bigEndian >(
+                finalBlocks,
+                buffer,
+                bufferLength,
+                messageLength
+            );
+            compress(finalBlocks, numBlocks);
+        }
+
+    }
+
+}
+
+#endif /* HASH_BLOCK_BUFFER_HPP */
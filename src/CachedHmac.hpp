@@ -0,0 +1,132 @@
+#ifndef HASH_CACHED_HMAC_HPP
+#define HASH_CACHED_HMAC_HPP
+
+/**
+ * @file CachedHmac.hpp
+ *
+ * This module declares the function template and function object used by
+ * the HMAC factories to compute HMAC codes through the process-wide cache
+ * of prepared HMAC keys, when given one of the hash functions of this
+ * library.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <Hash/HmacContext.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This function computes the HMAC code of the given message with
+         * the given key, using the hash function computed by the given
+         * context class, and the midstates of the key from the
+         * process-wide cache of prepared HMAC keys if they're there, or
+         * preparing them and adding them to the cache otherwise.
+         *
+         * It's defined for each context class provided by this library.
+         *
+         * @param[in] key
+         *     This points to the key to use.
+         *
+         * @param[in] keyLength
+         *     This is the length of the key, in bytes.
+         *
+         * @param[in] message
+         *     This points to the message for which to compute the HMAC
+         *     code.
+         *
+         * @param[in] messageLength
+         *     This is the length of the message, in bytes.
+         *
+         * @param[out] code
+         *     This is where to store the HMAC code.  It must have room for
+         *     HmacContext< HashContext >::codeSize bytes.
+         */
+        template< typename HashContext > void CachedHmac(
+            const void* key,
+            size_t keyLength,
+            const void* message,
+            size_t messageLength,
+            uint8_t* code
+        );
+
+        /**
+         * This is the type of function which computes HMAC codes through
+         * the process-wide cache of prepared HMAC keys, with one of the
+         * hash functions of this library.
+         */
+        typedef void (*CachedHmacFunction)(
+            const void* key,
+            size_t keyLength,
+            const void* message,
+            size_t messageLength,
+            uint8_t* code
+        );
+
+        /**
+         * This is the function object returned by the HMAC factories when
+         * given one of the hash functions of this library.  Since it's a
+         * named type, other parts of the library (such as Pbkdf2) can
+         * recognize it and compute with the hash function directly.
+         */
+        struct LibraryHmac {
+            /**
+             * This is the function which computes HMAC codes, or nullptr
+             * if the hash function isn't one of the hash functions of
+             * this library.
+             */
+            CachedHmacFunction compute = nullptr;
+
+            /**
+             * This is the size of the HMAC code, in bytes.
+             */
+            size_t codeSize = 0;
+
+            /**
+             * This function returns the function object which computes
+             * HMAC codes through the cache, with the hash function
+             * computed by the given context class.
+             *
+             * @return
+             *     The function object is returned.
+             */
+            template< typename HashContext > static LibraryHmac Of() {
+                LibraryHmac libraryHmac;
+                libraryHmac.compute = CachedHmac< HashContext >;
+                libraryHmac.codeSize = HmacContext< HashContext >::codeSize;
+                return libraryHmac;
+            }
+
+            /**
+             * This method computes the HMAC code of the given message with
+             * the given key.
+             *
+             * @param[in] key
+             *     This is the key to use in computing the HMAC code.
+             *
+             * @param[in] message
+             *     This is the message for which to compute the HMAC code.
+             *
+             * @return
+             *     The HMAC code for the given key and message is returned.
+             */
+            template< typename Message > std::vector< uint8_t > operator()(
+                const Message& key,
+                const Message& message
+            ) const {
+                std::vector< uint8_t > code(codeSize);
+                compute(key.data(), key.size(), message.data(), message.size(), code.data());
+                return code;
+            }
+        };
+
+    }
+
+}
+
+#endif /* HASH_CACHED_HMAC_HPP */
@@ -0,0 +1,133 @@
+/**
+ * @file CpuFeatures.cpp
+ *
+ * This module contains the implementation of the function used to detect
+ * which optional instruction set extensions are supported by the CPU.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "CpuFeatures.hpp"
+
+#include <stdint.h>
+
+#if HASH_TARGET_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+#if HASH_TARGET_X86
+    /**
+     * This function executes the CPUID instruction for the given leaf
+     * and subleaf.
+     *
+     * @param[in] leaf
+     *     This is the CPUID leaf to query.
+     *
+     * @param[in] subleaf
+     *     This is the CPUID subleaf to query.
+     *
+     * @param[out] registers
+     *     This is where to store the EAX, EBX, ECX, and EDX registers
+     *     returned by the instruction.
+     */
+    void CpuId(
+        uint32_t leaf,
+        uint32_t subleaf,
+        uint32_t (&registers)[4]
+    ) {
+#ifdef _MSC_VER
+        int result[4];
+        __cpuidex(result, (int)leaf, (int)subleaf);
+        for (size_t i = 0; i < 4; ++i) {
+            registers[i] = (uint32_t)result[i];
+        }
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    /**
+     * This function returns the extended control register XCR0, which
+     * indicates which register sets the operating system saves and restores
+     * on context switches.
+     *
+     * @return
+     *     The value of XCR0 is returned.
+     */
+    uint64_t GetXcr0() {
+#ifdef _MSC_VER
+        return (uint64_t)_xgetbv(0);
+#else
+        uint32_t eax, edx;
+        __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return ((uint64_t)edx << 32) | eax;
+#endif
+    }
+#endif
+
+    /**
+     * This function detects which optional instruction set extensions
+     * are supported by the CPU.
+     *
+     * @return
+     *     The optional instruction set extensions supported by the CPU
+     *     are returned.
+     */
+    Hash::Internal::CpuFeatures DetectCpuFeatures() {
+        Hash::Internal::CpuFeatures features;
+#if HASH_TARGET_X86
+        uint32_t registers[4];
+        CpuId(0, 0, registers);
+        const auto maxLeaf = registers[0];
+        bool ymmSaved = false;
+        bool zmmSaved = false;
+        if (maxLeaf >= 1) {
+            CpuId(1, 0, registers);
+            features.ssse3 = ((registers[2] & (1 << 9)) != 0);
+            features.sse41 = ((registers[2] & (1 << 19)) != 0);
+            const auto osxsave = ((registers[2] & (1 << 27)) != 0);
+            const auto avx = ((registers[2] & (1 << 28)) != 0);
+            if (osxsave && avx) {
+                const auto xcr0 = GetXcr0();
+                ymmSaved = ((xcr0 & 0x6) == 0x6);
+                zmmSaved = ((xcr0 & 0xE6) == 0xE6);
+            }
+        }
+        if (maxLeaf >= 7) {
+            CpuId(7, 0, registers);
+            features.sha = ((registers[1] & (1 << 29)) != 0);
+            features.avx2 = (
+                ymmSaved
+                && ((registers[1] & (1 << 5)) != 0)
+            );
+            features.bmi2 = ((registers[1] & (1 << 8)) != 0);
+            features.avx512 = (
+                zmmSaved
+                && ((registers[1] & (1 << 16)) != 0)
+                && ((registers[1] & (1 << 30)) != 0)
+            );
+        }
+#endif
+        return features;
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        const CpuFeatures& GetCpuFeatures() {
+            static const auto features = DetectCpuFeatures();
+            return features;
+        }
+
+    }
+
+}
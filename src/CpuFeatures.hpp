@@ -0,0 +1,82 @@
+#ifndef HASH_CPU_FEATURES_HPP
+#define HASH_CPU_FEATURES_HPP
+
+/**
+ * @file CpuFeatures.hpp
+ *
+ * This module declares the function used to detect which optional
+ * instruction set extensions are supported by the CPU, so that the fastest
+ * available compression kernels may be selected at run time.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HASH_TARGET_X86 1
+#else
+#define HASH_TARGET_X86 0
+#endif
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This holds flags indicating which optional instruction set
+         * extensions are supported by the CPU and operating system.
+         */
+        struct CpuFeatures {
+            /**
+             * This indicates whether or not the SSSE3 instructions
+             * are supported.
+             */
+            bool ssse3 = false;
+
+            /**
+             * This indicates whether or not the SSE4.1 instructions
+             * are supported.
+             */
+            bool sse41 = false;
+
+            /**
+             * This indicates whether or not the Intel SHA extensions
+             * (SHA-NI) are supported.
+             */
+            bool sha = false;
+
+            /**
+             * This indicates whether or not the AVX2 instructions are
+             * supported, including saving of the YMM registers by the
+             * operating system.
+             */
+            bool avx2 = false;
+
+            /**
+             * This indicates whether or not the BMI2 instructions
+             * are supported.
+             */
+            bool bmi2 = false;
+
+            /**
+             * This indicates whether or not the AVX-512 foundation and
+             * byte/word instructions are supported, including saving of
+             * the ZMM registers by the operating system.
+             */
+            bool avx512 = false;
+        };
+
+        /**
+         * This function returns the optional instruction set extensions
+         * supported by the CPU, detecting them the first time it's called.
+         *
+         * @return
+         *     The optional instruction set extensions supported by the CPU
+         *     are returned.
+         */
+        const CpuFeatures& GetCpuFeatures();
+
+    }
+
+}
+
+#endif /* HASH_CPU_FEATURES_HPP */
@@ -0,0 +1,397 @@
+/**
+ * @file HashFile.cpp
+ *
+ * This module contains the implementation of the functions used to read
+ * files in pieces in order to compute their message digests.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <Hash/HashFile.hpp>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * This is the size of each of the two buffers into which files which
+     * can't be mapped into memory are read.
+     */
+    constexpr size_t READ_BUFFER_SIZE = 1024 * 1024;
+
+#ifndef _WIN32
+    /**
+     * This is the size of the window of a regular file which is mapped
+     * into memory at a time.  Mapping a window rather than the whole file
+     * keeps the address space used constant, and lets pages already
+     * hashed be released while the rest of the file is read.
+     */
+    constexpr size_t MAP_WINDOW_SIZE = 64 * 1024 * 1024;
+#endif
+
+    /**
+     * This is the type of function which reads up to the given number of
+     * bytes from a file into the given buffer.  It returns the number of
+     * bytes read, which is zero at the end of the file, or a negative
+     * number if an error occurs.
+     */
+    typedef std::function< long(uint8_t* buffer, size_t size) > ReadFunction;
+
+    /**
+     * This holds one of the buffers used to read a file on one thread
+     * while giving its contents to a function on another thread.
+     */
+    struct ReadBuffer {
+        /**
+         * This holds the bytes read from the file.
+         */
+        std::vector< uint8_t > data;
+
+        /**
+         * This is the number of bytes read into the buffer.
+         */
+        size_t length = 0;
+
+        /**
+         * This indicates whether or not the buffer holds bytes which
+         * haven't yet been given to the function.
+         */
+        bool full = false;
+    };
+
+    /**
+     * This function reads a file into two buffers in turn on a separate
+     * thread, giving the contents of each buffer to the given function as
+     * soon as it's filled, while the other buffer is being filled.
+     *
+     * @param[in] read
+     *     This is the function to call to read from the file.
+     *
+     * @param[in] consumer
+     *     This is the function to call with each piece of the file.
+     *
+     * @return
+     *     An indication of whether or not the whole file was read
+     *     successfully is returned.
+     */
+    bool ReadDoubleBuffered(
+        const ReadFunction& read,
+        const std::function< void(const uint8_t* data, size_t length) >& consumer
+    ) {
+        ReadBuffer buffers[2];
+        for (auto& buffer: buffers) {
+            buffer.data.resize(READ_BUFFER_SIZE);
+        }
+        std::mutex mutex;
+        std::condition_variable bufferChanged;
+        bool failed = false;
+        bool stop = false;
+        std::thread reader(
+            [&]{
+                for (size_t i = 0; ; i ^= 1) {
+                    auto& buffer = buffers[i];
+                    {
+                        std::unique_lock< std::mutex > lock(mutex);
+                        bufferChanged.wait(lock, [&]{ return !buffer.full || stop; });
+                        if (stop) {
+                            return;
+                        }
+                    }
+
+                    // Fill the buffer as far as possible, since pipes
+                    // may return less than was asked for.
+                    size_t length = 0;
+                    bool error = false;
+                    while (length < buffer.data.size()) {
+                        const auto amount = read(
+                            buffer.data.data() + length,
+                            buffer.data.size() - length
+                        );
+                        if (amount <= 0) {
+                            error = (amount < 0);
+                            break;
+                        }
+                        length += (size_t)amount;
+                    }
+                    std::lock_guard< std::mutex > lock(mutex);
+                    buffer.length = (error ? 0 : length);
+                    buffer.full = true;
+                    failed = error;
+                    bufferChanged.notify_all();
+                    if (
+                        error
+                        || (length < buffer.data.size())
+                    ) {
+                        return;
+                    }
+                }
+            }
+        );
+        try {
+            for (size_t i = 0; ; i ^= 1) {
+                auto& buffer = buffers[i];
+                {
+                    std::unique_lock< std::mutex > lock(mutex);
+                    bufferChanged.wait(lock, [&]{ return buffer.full; });
+                }
+                const auto length = buffer.length;
+                if (length > 0) {
+                    consumer(buffer.data.data(), length);
+                }
+                std::lock_guard< std::mutex > lock(mutex);
+                buffer.full = false;
+                bufferChanged.notify_all();
+                if (
+                    failed
+                    || (length < buffer.data.size())
+                ) {
+                    break;
+                }
+            }
+        } catch (...) {
+            // If the function throws, tell the reader to stop and wait for
+            // it, since it may be waiting for a buffer to be emptied, and
+            // a thread must be joined before it's destroyed.
+            {
+                std::lock_guard< std::mutex > lock(mutex);
+                stop = true;
+                bufferChanged.notify_all();
+            }
+            reader.join();
+            throw;
+        }
+        reader.join();
+        return !failed;
+    }
+
+#ifndef _WIN32
+    /**
+     * These are the ways in which reading a file by mapping it into memory
+     * may end.
+     */
+    enum class MapResult {
+        /**
+         * The whole file was given to the function.
+         */
+        Done,
+
+        /**
+         * Part of the file couldn't be mapped, so the rest of it should
+         * be read instead.
+         */
+        ReadRest,
+
+        /**
+         * The file was truncated while it was being read.
+         */
+        Truncated,
+    };
+
+    /**
+     * This function gives the contents of the given regular file to the
+     * given function, mapping the file into memory one window at a time.
+     *
+     * Touching a mapped page past the end of a file raises SIGBUS, so the
+     * size of the file is checked again before each window is mapped, and
+     * the file is given up on if it has been truncated.
+     *
+     * @param[in] fd
+     *     This is the descriptor of the file to read.
+     *
+     * @param[in] size
+     *     This is the size of the file, in bytes, when it was opened.
+     *
+     * @param[in] consumer
+     *     This is the function to call with each piece of the file.
+     *
+     * @param[out] offset
+     *     This is where to store the number of bytes of the file given
+     *     to the function.
+     *
+     * @return
+     *     An indication of how reading the file ended is returned.
+     */
+    MapResult ReadMapped(
+        int fd,
+        size_t size,
+        const std::function< void(const uint8_t* data, size_t length) >& consumer,
+        size_t& offset
+    ) {
+        for (offset = 0; offset < size; offset += MAP_WINDOW_SIZE) {
+            const auto length = std::min(size - offset, MAP_WINDOW_SIZE);
+            struct stat status;
+            if (fstat(fd, &status) != 0) {
+                return MapResult::ReadRest;
+            }
+            if ((size_t)status.st_size < offset + length) {
+                return MapResult::Truncated;
+            }
+            const auto window = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, (off_t)offset);
+            if (window == MAP_FAILED) {
+                return MapResult::ReadRest;
+            }
+            (void)madvise(window, length, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            // This only has an effect on file systems which support
+            // transparent huge pages in the page cache, and is harmless
+            // elsewhere.
+            (void)madvise(window, length, MADV_HUGEPAGE);
+#endif
+            try {
+                consumer((const uint8_t*)window, length);
+            } catch (...) {
+                (void)munmap(window, length);
+                throw;
+            }
+            (void)munmap(window, length);
+        }
+        return MapResult::Done;
+    }
+#endif
+
+#ifdef _WIN32
+    /**
+     * This function gives the contents of the given open file to the given
+     * function, one piece at a time.
+     *
+     * @param[in] file
+     *     This is the file to read.
+     *
+     * @param[in] consumer
+     *     This is the function to call with each piece of the file.
+     *
+     * @return
+     *     An indication of whether or not the whole file was read
+     *     successfully is returned.
+     */
+    bool ReadOpenFile(
+        FILE* file,
+        const std::function< void(const uint8_t* data, size_t length) >& consumer
+    ) {
+        return ReadDoubleBuffered(
+            [file](uint8_t* buffer, size_t size) -> long {
+                const auto amount = fread(buffer, 1, size, file);
+                if (
+                    (amount == 0)
+                    && ferror(file)
+                ) {
+                    return -1;
+                }
+                return (long)amount;
+            },
+            consumer
+        );
+    }
+#else
+    /**
+     * This function gives the contents of the given open file to the given
+     * function, one piece at a time.  Regular files are mapped into memory
+     * if possible, and other files are read.
+     *
+     * @param[in] fd
+     *     This is the descriptor of the file to read.
+     *
+     * @param[in] consumer
+     *     This is the function to call with each piece of the file.
+     *
+     * @return
+     *     An indication of whether or not the whole file was read
+     *     successfully is returned.
+     */
+    bool ReadOpenFile(
+        int fd,
+        const std::function< void(const uint8_t* data, size_t length) >& consumer
+    ) {
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            return false;
+        }
+
+        // Regular files reporting a size of zero may still have contents
+        // (as in /proc), so they're read rather than mapped.
+        if (
+            S_ISREG(status.st_mode)
+            && (status.st_size > 0)
+        ) {
+            size_t offset;
+            const auto result = ReadMapped(fd, (size_t)status.st_size, consumer, offset);
+            if (result != MapResult::ReadRest) {
+                return (result == MapResult::Done);
+            }
+
+            // If the file can't be mapped, read the rest of it instead.
+            if (lseek(fd, (off_t)offset, SEEK_SET) != (off_t)offset) {
+                return false;
+            }
+        }
+        return ReadDoubleBuffered(
+            [fd](uint8_t* buffer, size_t size) -> long {
+                for (;;) {
+                    const auto amount = read(fd, buffer, size);
+                    if (
+                        (amount < 0)
+                        && (errno == EINTR)
+                    ) {
+                        continue;
+                    }
+                    return (long)amount;
+                }
+            },
+            consumer
+        );
+    }
+#endif
+
+}
+
+namespace Hash {
+
+    bool ReadFileInPieces(
+        const std::string& path,
+        const std::function< void(const uint8_t* data, size_t length) >& consumer
+    ) {
+#ifdef _WIN32
+        const auto file = fopen(path.c_str(), "rb");
+        if (file == NULL) {
+            return false;
+        }
+        bool success;
+        try {
+            success = ReadOpenFile(file, consumer);
+        } catch (...) {
+            (void)fclose(file);
+            throw;
+        }
+        (void)fclose(file);
+        return success;
+#else
+        const auto fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        bool success;
+        try {
+            success = ReadOpenFile(fd, consumer);
+        } catch (...) {
+            (void)close(fd);
+            throw;
+        }
+        (void)close(fd);
+        return success;
+#endif
+    }
+
+}
@@ -0,0 +1,159 @@
+/**
+ * @file Hex.cpp
+ *
+ * This module contains the implementation of the functions used to convert
+ * message digests and other binary data to and from strings of hexadecimal
+ * digits.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HexKernels.hpp"
+
+#include <Hash/Hex.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the value used in the digit value table to mark characters
+     * which are not hexadecimal digits.
+     */
+    constexpr uint8_t NOT_A_DIGIT = 0xFF;
+
+    /**
+     * This is a short name for NOT_A_DIGIT, used to keep the digit value
+     * table readable.
+     */
+    constexpr uint8_t N = NOT_A_DIGIT;
+
+    /**
+     * This holds the value of every character as a hexadecimal digit,
+     * or NOT_A_DIGIT if the character is not a hexadecimal digit.  It's
+     * constant-initialized, so it may be used by static initializers in
+     * other modules.
+     */
+    constexpr uint8_t DIGIT_VALUES[256] = {
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  N,  N,  N,  N,  N,  N,
+         N, 10, 11, 12, 13, 14, 15,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N, 10, 11, 12, 13, 14, 15,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,
+         N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N,  N
+    };
+
+    /**
+     * This is the signature of a kernel which converts bytes into
+     * hexadecimal digits.
+     */
+    using EncodeKernel = void(*)(
+        const uint8_t* data,
+        size_t length,
+        char* hex
+    );
+
+    /**
+     * This function selects the fastest hexadecimal encoding kernel
+     * supported by the CPU.
+     *
+     * @return
+     *     The selected kernel is returned.
+     */
+    EncodeKernel SelectEncodeKernel() {
+#if HASH_TARGET_X86
+        if (Hash::Internal::GetCpuFeatures().ssse3) {
+            return Hash::Internal::EncodeHexSsse3;
+        }
+#endif
+        return Hash::Internal::EncodeHexScalar;
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void EncodeHexScalar(const uint8_t* data, size_t length, char* hex) {
+            // Each byte's two digits are looked up together, as one entry
+            // of a 512-character table, rather than one nibble at a time.
+            static const char pairs[] =
+                "000102030405060708090a0b0c0d0e0f"
+                "101112131415161718191a1b1c1d1e1f"
+                "202122232425262728292a2b2c2d2e2f"
+                "303132333435363738393a3b3c3d3e3f"
+                "404142434445464748494a4b4c4d4e4f"
+                "505152535455565758595a5b5c5d5e5f"
+                "606162636465666768696a6b6c6d6e6f"
+                "707172737475767778797a7b7c7d7e7f"
+                "808182838485868788898a8b8c8d8e8f"
+                "909192939495969798999a9b9c9d9e9f"
+                "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+                "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+                "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+                "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+                "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+                "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+            for (size_t i = 0; i < length; ++i) {
+                hex[i * 2] = pairs[data[i] * 2];
+                hex[i * 2 + 1] = pairs[data[i] * 2 + 1];
+            }
+        }
+
+    }
+
+    void EncodeHex(const void* data, size_t length, char* hex) {
+        static const auto kernel = SelectEncodeKernel();
+        kernel((const uint8_t*)data, length, hex);
+    }
+
+    std::string EncodeHex(const void* data, size_t length) {
+        std::string hex(length * 2, '\0');
+        if (length > 0) {
+            EncodeHex(data, length, &hex[0]);
+        }
+        return hex;
+    }
+
+    std::string EncodeHex(const std::vector< uint8_t >& data) {
+        return EncodeHex(data.data(), data.size());
+    }
+
+    bool DecodeHex(const char* hex, size_t length, uint8_t* data) {
+        if ((length % 2) != 0) {
+            return false;
+        }
+        // The digit values are combined with OR so that a single check
+        // at the end catches any invalid character.
+        uint8_t invalid = 0;
+        for (size_t i = 0; i < length / 2; ++i) {
+            const auto high = DIGIT_VALUES[(uint8_t)hex[i * 2]];
+            const auto low = DIGIT_VALUES[(uint8_t)hex[i * 2 + 1]];
+            invalid |= (high | low);
+            data[i] = (uint8_t)((high << 4) | (low & 0x0F));
+        }
+        return ((invalid & 0xF0) == 0);
+    }
+
+    bool DecodeHex(const std::string& hex, std::vector< uint8_t >& data) {
+        data.resize(hex.length() / 2);
+        if (!DecodeHex(hex.data(), hex.length(), data.data())) {
+            data.clear();
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,64 @@
+#ifndef HASH_HEX_KERNELS_HPP
+#define HASH_HEX_KERNELS_HPP
+
+/**
+ * @file HexKernels.hpp
+ *
+ * This module declares the kernels used to convert binary data into
+ * hexadecimal digits.  The portable kernel works everywhere, while the
+ * others require optional instruction set extensions and must only be
+ * called if the CPU supports them.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "CpuFeatures.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This function converts the given bytes into lowercase
+         * hexadecimal digits, using a lookup table.
+         *
+         * @param[in] data
+         *     This points to the bytes to convert.
+         *
+         * @param[in] length
+         *     This is the number of bytes to convert.
+         *
+         * @param[out] hex
+         *     This is where to store the length * 2 hexadecimal digits.
+         */
+        void EncodeHexScalar(const uint8_t* data, size_t length, char* hex);
+
+#if HASH_TARGET_X86
+        /**
+         * This function converts the given bytes into lowercase
+         * hexadecimal digits, sixteen bytes at a time, using SSSE3
+         * byte shuffles as the lookup table.
+         *
+         * @note
+         *     This requires the SSSE3 extensions.
+         *
+         * @param[in] data
+         *     This points to the bytes to convert.
+         *
+         * @param[in] length
+         *     This is the number of bytes to convert.
+         *
+         * @param[out] hex
+         *     This is where to store the length * 2 hexadecimal digits.
+         */
+        void EncodeHexSsse3(const uint8_t* data, size_t length, char* hex);
+#endif
+
+    }
+
+}
+
+#endif /* HASH_HEX_KERNELS_HPP */
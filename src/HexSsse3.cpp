@@ -0,0 +1,47 @@
+/**
+ * @file HexSsse3.cpp
+ *
+ * This module contains the implementation of the hexadecimal encoding
+ * kernel which uses SSSE3 to convert sixteen bytes at a time.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "HexKernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace Hash {
+
+    namespace Internal {
+
+        void EncodeHexSsse3(const uint8_t* data, size_t length, char* hex) {
+            const auto digits = _mm_setr_epi8(
+                '0', '1', '2', '3', '4', '5', '6', '7',
+                '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+            );
+            const auto lowNibble = _mm_set1_epi8(0x0F);
+            for (; length >= 16; length -= 16, data += 16, hex += 32) {
+                const auto bytes = _mm_loadu_si128((const __m128i*)data);
+                const auto high = _mm_shuffle_epi8(
+                    digits,
+                    _mm_and_si128(_mm_srli_epi16(bytes, 4), lowNibble)
+                );
+                const auto low = _mm_shuffle_epi8(
+                    digits,
+                    _mm_and_si128(bytes, lowNibble)
+                );
+                _mm_storeu_si128((__m128i*)hex, _mm_unpacklo_epi8(high, low));
+                _mm_storeu_si128((__m128i*)(hex + 16), _mm_unpackhi_epi8(high, low));
+            }
+            EncodeHexScalar(data, length, hex);
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
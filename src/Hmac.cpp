@@ -7,131 +7,160 @@
  * © 2018 by Richard Walters
  */
 
-#include <algorithm>
-#include <iomanip>
+#include "CachedHmac.hpp"
+#include "HmacPads.hpp"
+
+#include <Hash/Hex.hpp>
 #include <Hash/Hmac.hpp>
-#include <sstream>
-#include <string.h>
+#include <Hash/HmacContext.hpp>
+#include <Hash/Templates.hpp>
+#include <stddef.h>
+#include <stdexcept>
 #include <stdint.h>
+#include <string>
 #include <vector>
 
 namespace {
 
     /**
-     * This function returns a string of raw character codes that has the same
-     * data as the given vector of bytes.
+     * This function returns a vector of bytes that has the same data as the
+     * given string of hex digits.
      *
      * @param[in] input
-     *     This is the data to convert into a string of raw character codes.
+     *     This is the data (hex digits) to convert into a vector
+     *     of bytes.
      *
      * @return
-     *     A string of raw character codes equivalent to the given vector of
-     *     bytes is returned.
-     */
-    std::string BytesToRawString(const std::vector< uint8_t >& input) {
-        return std::string{
-            input.begin(),
-            input.end()
-        };
-    }
-
-    /**
-     * This function returns a string of hex digits that has the same
-     * data as the given vector of bytes.
-     *
-     * @param[in] input
-     *     This is the data to convert into a string of raw character codes.
+     *     A vector of bytes equivalent to the given string of hex digits
+     *     is returned.
      *
-     * @return
-     *     A string of hex digits  equivalent to the given vector of
-     *     bytes is returned.
+     * @throw std::invalid_argument
+     *     This is thrown if the string isn't made up of pairs of valid
+     *     hex digits.
      */
-    std::string BytesToHexString(const std::vector< uint8_t >& input) {
-        std::ostringstream codeStringBuilder;
-        codeStringBuilder << std::hex << std::setfill('0');
-        for (auto codeByte: input) {
-            codeStringBuilder << std::setw(2) << (int)codeByte;
+    std::vector< uint8_t > HexStringToBytes(const std::string& input) {
+        std::vector< uint8_t > dataAsVector;
+        if (!Hash::DecodeHex(input, dataAsVector)) {
+            throw std::invalid_argument("hash function output is not hexadecimal");
         }
-        return codeStringBuilder.str();
+        return dataAsVector;
     }
 
     /**
-     * This function returns a vector of bytes that has the same data as the
-     * given string of raw character codes.
+     * This function computes the HMAC code for the given key and message,
+     * using the given hash function, which produces the raw bytes of
+     * message digests.
      *
-     * @param[in] input
-     *     This is the data (raw character codes) to convert into a vector
-     *     of bytes.
+     * @param[in] hashFunction
+     *     This is the hash function to use to compute digests.
+     *
+     * @param[in] blockSize
+     *     This is the block size of the given hash function, in bytes.
+     *
+     * @param[in] key
+     *     This is the key to use in computing the HMAC code.
+     *
+     * @param[in] message
+     *     This is the message for which to compute the HMAC code.
      *
      * @return
-     *     A vector of bytes equivalent to the given string of raw character
-     *     codes is returned.
+     *     The HMAC code for the given key and message is returned.
      */
-    std::vector< uint8_t > RawStringToBytes(const std::string& input) {
-        std::vector< uint8_t > dataAsVector(input.length());
-        if (!dataAsVector.empty()) {
-            (void)memcpy(dataAsVector.data(), input.c_str(), dataAsVector.size());
-        }
-        return dataAsVector;
+    template< typename Message, typename HashFunction > std::vector< uint8_t > Hmac(
+        const HashFunction& hashFunction,
+        size_t blockSize,
+        const Message& key,
+        const Message& message
+    ) {
+        Message innerPad;
+        Message outerPad;
+        Hash::Internal::PadHmacKey(hashFunction, blockSize, key, innerPad, outerPad);
+        return Hash::Internal::HmacWithPads(hashFunction, innerPad, outerPad, message);
     }
 
     /**
-     * This function returns a vector of bytes that has the same data as the
-     * given string of hex digits.
-     *
-     * @param[in] input
-     *     This is the data (hex digits) to convert into a vector
-     *     of bytes.
-     *
-     * @return
-     *     A vector of bytes equivalent to the given string of hex digits
-     *     is returned.
+     * This class template gives the forms of the hash functions of this
+     * library which take and produce the given types, so that the hash
+     * functions given to the HMAC factories may be recognized.
      */
-    std::vector< uint8_t > HexStringToBytes(const std::string& input) {
-        std::vector< uint8_t > dataAsVector(input.length() / 2);
-        for (size_t i = 0; i < dataAsVector.size(); ++i) {
-            auto& byte = dataAsVector[i];
-            for (auto digit: input.substr(i * 2, 2)) {
-                byte <<= 4;
-                if ((digit >= '0') && (digit <= '9')) {
-                    byte += (uint8_t)(digit - '0');
-                } else if ((digit >= 'a') && (digit <= 'f')) {
-                    byte += (uint8_t)((digit - 'a') + 10);
-                }
-            }
+    template< typename Output, typename Input > struct LibraryHash;
+
+    template<> struct LibraryHash< std::vector< uint8_t >, std::vector< uint8_t > > {
+        template< Hash::HashFunction hash > static Hash::HashFunction Of() {
+            return hash;
         }
-        return dataAsVector;
-    }
+    };
+
+    template<> struct LibraryHash< std::vector< uint8_t >, std::string > {
+        template< Hash::HashFunction hash > static auto Of() -> std::vector< uint8_t >(*)(const std::string&) {
+            return Hash::StringToBytes< hash >;
+        }
+    };
+
+    template<> struct LibraryHash< std::string, std::vector< uint8_t > > {
+        template< Hash::HashFunction hash > static auto Of() -> std::string(*)(const std::vector< uint8_t >&) {
+            return Hash::BytesToString< hash >;
+        }
+    };
+
+    template<> struct LibraryHash< std::string, std::string > {
+        template< Hash::HashFunction hash > static auto Of() -> std::string(*)(const std::string&) {
+            return Hash::StringToString< hash >;
+        }
+    };
 
     /**
-     * This function concatenates together two vectors of bytes.
+     * This function checks to see if the given hash function is one of
+     * the hash functions of this library, given as a plain function (for
+     * example, Hash::Sha256 or Hash::StringToBytes< Hash::Sha256 >) with
+     * its own block size.  If so, HMAC codes may be computed with the
+     * hash function's context class, through the process-wide cache of
+     * prepared HMAC keys, rather than through the given function.
      *
-     * @param[in] lhs
-     *     This is the left-hand vector to concatenate.
+     * @param[in] hashFunction
+     *     This is the hash function given to an HMAC factory.
      *
-     * @param[in] rhs
-     *     This is the right-hand vector to concatenate.
+     * @param[in] blockSize
+     *     This is the block size given along with the hash function.
      *
      * @return
-     *     The vector formed by concatenating the two given vectors together
-     *     is returned.
+     *     The function object which computes HMAC codes through the cache
+     *     is returned, with a null compute function if the hash function
+     *     isn't recognized.
      */
-    std::vector< uint8_t > operator+ (
-        const std::vector< uint8_t >& lhs,
-        const std::vector< uint8_t >& rhs
+    template< typename Output, typename Input > Hash::Internal::LibraryHmac FindLibraryHmac(
+        const std::function< Output(const Input&) >& hashFunction,
+        size_t blockSize
     ) {
-        std::vector< uint8_t > result(lhs.size() + rhs.size());
-        std::copy(
-            lhs.begin(),
-            lhs.end(),
-            result.begin()
-        );
-        std::copy(
-            rhs.begin(),
-            rhs.end(),
-            result.begin() + lhs.size()
-        );
-        return result;
+        typedef Output (*Function)(const Input&);
+        typedef LibraryHash< Output, Input > Library;
+        const auto target = hashFunction.template target< Function >();
+        if (target == nullptr) {
+            return Hash::Internal::LibraryHmac();
+        }
+        const struct {
+            Function function;
+            size_t blockSize;
+            Hash::Internal::LibraryHmac libraryHmac;
+        } candidates[] = {
+            {Library::template Of< Hash::Md5 >(), Hash::MD5_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Md5Context >()},
+            {Library::template Of< Hash::Sha1 >(), Hash::SHA1_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Sha1Context >()},
+            {Library::template Of< Hash::Sha224 >(), Hash::SHA224_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Sha224Context >()},
+            {Library::template Of< Hash::Sha256 >(), Hash::SHA256_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Sha256Context >()},
+            {Library::template Of< Hash::Sha384 >(), Hash::SHA512_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Sha384Context >()},
+            {Library::template Of< Hash::Sha512 >(), Hash::SHA512_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Sha512Context >()},
+            {Library::template Of< Hash::Sha512t224 >(), Hash::SHA512_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Sha512t224Context >()},
+            {Library::template Of< Hash::Sha512t256 >(), Hash::SHA512_BLOCK_SIZE, Hash::Internal::LibraryHmac::Of< Hash::Sha512t256Context >()},
+        };
+        for (const auto& candidate: candidates) {
+            if (
+                (*target == candidate.function)
+                && (blockSize == candidate.blockSize)
+            ) {
+                return candidate.libraryHmac;
+            }
+        }
+        return Hash::Internal::LibraryHmac();
     }
 
 }
@@ -147,21 +176,21 @@ namespace Hash {
         std::function< std::string(const std::vector< uint8_t >&) > hashFunction,
         size_t blockSize
     ) {
-        const auto innerHash = [hashFunction](const std::vector< uint8_t >& input) {
-            const auto data = hashFunction(input);
-            return HexStringToBytes(data);
-        };
-        const auto innerHmac = MakeHmacBytesToBytesFunction(
-            innerHash,
+        const auto libraryHmac = FindLibraryHmac(hashFunction, blockSize);
+        if (libraryHmac.compute != nullptr) {
+            return [libraryHmac](
+                const std::vector< uint8_t >& key,
+                const std::vector< uint8_t >& message
+            ){
+                return EncodeHex(libraryHmac(key, message));
+            };
+        }
+        return MakeHmacBytesToStringFunctionFromRawHash(
+            [hashFunction](const std::vector< uint8_t >& input) {
+                return HexStringToBytes(hashFunction(input));
+            },
             blockSize
         );
-        return [innerHmac](
-            const std::vector< uint8_t >& key,
-            const std::vector< uint8_t >& message
-        ){
-            const auto code = innerHmac(key, message);
-            return BytesToHexString(code);
-        };
     }
 
     std::function<
@@ -173,23 +202,72 @@ namespace Hash {
         std::function< std::string(const std::string&) > hashFunction,
         size_t blockSize
     ) {
-        const auto innerHash = [hashFunction](const std::vector< uint8_t >& input) {
-            const auto inputAsString = BytesToRawString(input);
-            const auto data = hashFunction(inputAsString);
-            return HexStringToBytes(data);
-        };
-        const auto innerHmac = MakeHmacBytesToBytesFunction(
-            innerHash,
+        const auto libraryHmac = FindLibraryHmac(hashFunction, blockSize);
+        if (libraryHmac.compute != nullptr) {
+            return [libraryHmac](
+                const std::string& key,
+                const std::string& message
+            ){
+                return EncodeHex(libraryHmac(key, message));
+            };
+        }
+        return MakeHmacStringToStringFunctionFromRawHash(
+            [hashFunction](const std::string& input) {
+                return HexStringToBytes(hashFunction(input));
+            },
             blockSize
         );
-        return [innerHmac](
+    }
+
+    std::function<
+        std::string(
+            const std::vector< uint8_t >&,
+            const std::vector< uint8_t >&
+        )
+    > MakeHmacBytesToStringFunctionFromRawHash(
+        std::function< std::vector< uint8_t >(const std::vector< uint8_t >&) > hashFunction,
+        size_t blockSize
+    ) {
+        const auto libraryHmac = FindLibraryHmac(hashFunction, blockSize);
+        if (libraryHmac.compute != nullptr) {
+            return [libraryHmac](
+                const std::vector< uint8_t >& key,
+                const std::vector< uint8_t >& message
+            ){
+                return EncodeHex(libraryHmac(key, message));
+            };
+        }
+        return [hashFunction, blockSize](
+            const std::vector< uint8_t >& key,
+            const std::vector< uint8_t >& message
+        ){
+            return EncodeHex(Hmac(hashFunction, blockSize, key, message));
+        };
+    }
+
+    std::function<
+        std::string(
+            const std::string&,
+            const std::string&
+        )
+    > MakeHmacStringToStringFunctionFromRawHash(
+        std::function< std::vector< uint8_t >(const std::string&) > hashFunction,
+        size_t blockSize
+    ) {
+        const auto libraryHmac = FindLibraryHmac(hashFunction, blockSize);
+        if (libraryHmac.compute != nullptr) {
+            return [libraryHmac](
+                const std::string& key,
+                const std::string& message
+            ){
+                return EncodeHex(libraryHmac(key, message));
+            };
+        }
+        return [hashFunction, blockSize](
             const std::string& key,
             const std::string& message
         ){
-            const auto keyAsBytes = RawStringToBytes(key);
-            const auto messageAsBytes = RawStringToBytes(message);
-            const auto code = innerHmac(keyAsBytes, messageAsBytes);
-            return BytesToHexString(code);
+            return EncodeHex(Hmac(hashFunction, blockSize, key, message));
         };
     }
 
@@ -202,24 +280,15 @@ namespace Hash {
         std::function< std::vector< uint8_t >(const std::vector< uint8_t >&) > hashFunction,
         size_t blockSize
     ) {
+        const auto libraryHmac = FindLibraryHmac(hashFunction, blockSize);
+        if (libraryHmac.compute != nullptr) {
+            return libraryHmac;
+        }
         return [hashFunction, blockSize](
             const std::vector< uint8_t >& key,
             const std::vector< uint8_t >& message
         ) {
-            std::vector< uint8_t > normalizedKey(key);
-            if (normalizedKey.size() > blockSize) {
-                normalizedKey = hashFunction(normalizedKey);
-            }
-            normalizedKey.resize(blockSize);
-            std::vector< uint8_t > opad(normalizedKey);
-            for (auto& b: opad) {
-                b ^= 0x5C;
-            }
-            std::vector< uint8_t > ipad(normalizedKey);
-            for (auto& b: ipad) {
-                b ^= 0x36;
-            }
-            return hashFunction(opad + hashFunction(ipad + message));
+            return Hmac(hashFunction, blockSize, key, message);
         };
     }
 
@@ -232,23 +301,20 @@ namespace Hash {
         std::function< std::vector< uint8_t >(const std::string&) > hashFunction,
         size_t blockSize
     ) {
-        const auto innerHash = [hashFunction](const std::vector< uint8_t >& input) {
-            const auto inputAsString = BytesToRawString(input);
-            const auto data = hashFunction(inputAsString);
-            return data;
-        };
-        const auto innerHmac = MakeHmacBytesToBytesFunction(
-            innerHash,
-            blockSize
-        );
-        return [innerHmac](
+        const auto libraryHmac = FindLibraryHmac(hashFunction, blockSize);
+        if (libraryHmac.compute != nullptr) {
+            return [libraryHmac](
+                const std::string& key,
+                const std::string& message
+            ){
+                return libraryHmac(key, message);
+            };
+        }
+        return [hashFunction, blockSize](
             const std::string& key,
             const std::string& message
         ){
-            const auto keyAsBytes = RawStringToBytes(key);
-            const auto messageAsBytes = RawStringToBytes(message);
-            const auto code = innerHmac(keyAsBytes, messageAsBytes);
-            return code;
+            return Hmac(hashFunction, blockSize, key, message);
         };
     }
 
@@ -0,0 +1,541 @@
+/**
+ * @file HmacKeyCache.cpp
+ *
+ * This module contains the implementation of the process-wide cache of
+ * prepared HMAC keys.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "CachedHmac.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <Hash/HmacContext.hpp>
+#include <Hash/HmacKeyCache.hpp>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unordered_map>
+
+namespace {
+
+    /**
+     * This is the largest number of parts into which the cache may be
+     * split.
+     */
+    constexpr size_t MAX_SHARDS = 64;
+
+    /**
+     * This is the number of hash functions whose HMAC midstates may be
+     * kept in the cache.
+     */
+    constexpr size_t NUM_ALGORITHMS = 8;
+
+    /**
+     * This is the number of slots in each part of the cache which
+     * remember keys seen once but not yet kept.
+     */
+    constexpr size_t SEEN_SLOTS = 64;
+
+    /**
+     * This is the type of the digest by which each key is found in the
+     * cache.
+     */
+    typedef std::array< uint64_t, 2 > KeyId;
+
+    /**
+     * This is used to find keys in the cache by their digests, which are
+     * already uniformly distributed, so the first word of the digest is
+     * used as its hash.
+     */
+    struct KeyIdHash {
+        size_t operator()(const KeyId& keyId) const {
+            return (size_t)keyId[0];
+        }
+    };
+
+    /**
+     * This function rotates the bits of the given word to the left.
+     *
+     * @param[in] word
+     *     This is the word to rotate.
+     *
+     * @param[in] bits
+     *     This is the number of bits by which to rotate the word.
+     *
+     * @return
+     *     The rotated word is returned.
+     */
+    inline uint64_t RotateLeft(uint64_t word, int bits) {
+        return (word << bits) | (word >> (64 - bits));
+    }
+
+    /**
+     * This function applies one SipHash round to the given state.
+     *
+     * @param[in,out] v
+     *     This is the SipHash state to update.
+     */
+    inline void SipRound(uint64_t (&v)[4]) {
+        v[0] += v[1]; v[1] = RotateLeft(v[1], 13); v[1] ^= v[0]; v[0] = RotateLeft(v[0], 32);
+        v[2] += v[3]; v[3] = RotateLeft(v[3], 16); v[3] ^= v[2];
+        v[0] += v[3]; v[3] = RotateLeft(v[3], 21); v[3] ^= v[0];
+        v[2] += v[1]; v[1] = RotateLeft(v[1], 17); v[1] ^= v[2]; v[2] = RotateLeft(v[2], 32);
+    }
+
+    /**
+     * This function computes the 128-bit SipHash-2-4 digest of the given
+     * data, keyed with the given secret.  It's much cheaper than a
+     * cryptographic hash function such as SHA-256, while still keeping
+     * digests unpredictable to anyone who doesn't know the secret.
+     *
+     * @param[in] secret
+     *     This is the secret with which to key the digest.
+     *
+     * @param[in] data
+     *     This points to the data to digest.
+     *
+     * @param[in] length
+     *     This is the length of the data, in bytes.
+     *
+     * @return
+     *     The digest of the data is returned.
+     */
+    KeyId SipHash128(
+        const uint64_t (&secret)[2],
+        const void* data,
+        size_t length
+    ) {
+        uint64_t v[4] = {
+            secret[0] ^ 0x736f6d6570736575,
+            secret[1] ^ 0x646f72616e646f6d ^ 0xee,
+            secret[0] ^ 0x6c7967656e657261,
+            secret[1] ^ 0x7465646279746573,
+        };
+        const auto bytes = (const uint8_t*)data;
+        const auto end = bytes + (length & ~(size_t)7);
+        for (auto p = bytes; p < end; p += 8) {
+            uint64_t word;
+            (void)memcpy(&word, p, 8);
+            v[3] ^= word;
+            SipRound(v);
+            SipRound(v);
+            v[0] ^= word;
+        }
+        uint64_t last = (uint64_t)length << 56;
+        for (size_t i = 0; i < (length & 7); ++i) {
+            last |= (uint64_t)end[i] << (8 * i);
+        }
+        v[3] ^= last;
+        SipRound(v);
+        SipRound(v);
+        v[0] ^= last;
+        KeyId digest;
+        v[2] ^= 0xee;
+        for (size_t i = 0; i < 4; ++i) {
+            SipRound(v);
+        }
+        digest[0] = v[0] ^ v[1] ^ v[2] ^ v[3];
+        v[1] ^= 0xdd;
+        for (size_t i = 0; i < 4; ++i) {
+            SipRound(v);
+        }
+        digest[1] = v[0] ^ v[1] ^ v[2] ^ v[3];
+        return digest;
+    }
+
+    /**
+     * This class template numbers the hash functions whose HMAC midstates
+     * may be kept in the cache, so that the same key used with different
+     * hash functions is kept separately.
+     */
+    template< typename HashContext > struct AlgorithmNumber;
+    template<> struct AlgorithmNumber< Hash::Md5Context > { static constexpr uint8_t value = 0; };
+    template<> struct AlgorithmNumber< Hash::Sha1Context > { static constexpr uint8_t value = 1; };
+    template<> struct AlgorithmNumber< Hash::Sha224Context > { static constexpr uint8_t value = 2; };
+    template<> struct AlgorithmNumber< Hash::Sha256Context > { static constexpr uint8_t value = 3; };
+    template<> struct AlgorithmNumber< Hash::Sha384Context > { static constexpr uint8_t value = 4; };
+    template<> struct AlgorithmNumber< Hash::Sha512Context > { static constexpr uint8_t value = 5; };
+    template<> struct AlgorithmNumber< Hash::Sha512t224Context > { static constexpr uint8_t value = 6; };
+    template<> struct AlgorithmNumber< Hash::Sha512t256Context > { static constexpr uint8_t value = 7; };
+
+    /**
+     * This is the base class of the prepared forms of HMAC keys kept in
+     * the cache, which may be for any hash function.
+     */
+    class PreparedKey {
+    public:
+        virtual ~PreparedKey() noexcept = default;
+
+        /**
+         * This method computes the HMAC code of the given message with
+         * the prepared key, storing it in the given buffer.
+         *
+         * @param[in] message
+         *     This points to the message for which to compute the HMAC
+         *     code.
+         *
+         * @param[in] messageLength
+         *     This is the length of the message, in bytes.
+         *
+         * @param[out] code
+         *     This is where to store the HMAC code.
+         */
+        virtual void Compute(
+            const void* message,
+            size_t messageLength,
+            uint8_t* code
+        ) const = 0;
+    };
+
+    /**
+     * This holds the HMAC midstates of a key, for the hash function
+     * computed by the given context class, and wipes them when the key
+     * is dropped from the cache and no longer in use.
+     */
+    template< typename HashContext > class PreparedKeyOf
+        : public PreparedKey
+    {
+    public:
+        /**
+         * This constructor computes the HMAC midstates of the given key.
+         *
+         * @param[in] key
+         *     This points to the key to prepare.
+         *
+         * @param[in] keyLength
+         *     This is the length of the key, in bytes.
+         */
+        PreparedKeyOf(const void* key, size_t keyLength)
+            : hmac_(key, keyLength)
+        {
+        }
+
+        void Compute(
+            const void* message,
+            size_t messageLength,
+            uint8_t* code
+        ) const override {
+            hmac_.Compute(message, messageLength, code);
+        }
+
+    private:
+        /**
+         * This holds the HMAC midstates of the key, which it wipes when
+         * it's destroyed.
+         */
+        Hash::HmacContext< HashContext > hmac_;
+    };
+
+    /**
+     * This holds one part of the cache, with its own lock and its own
+     * least-recently-used order.
+     */
+    struct Shard {
+        /**
+         * This is the type of the list of keys in the shard, ordered from
+         * most recently used to least recently used.
+         */
+        typedef std::list<
+            std::pair< KeyId, std::shared_ptr< const PreparedKey > >
+        > Entries;
+
+        /**
+         * This is used to synchronize access to the shard.
+         */
+        std::mutex mutex;
+
+        /**
+         * These are the digests of the keys in the shard, along with
+         * their prepared forms, ordered from most recently used to least
+         * recently used.
+         */
+        Entries entries;
+
+        /**
+         * This is used to find the entry of each key in the shard.
+         */
+        std::unordered_map< KeyId, Entries::iterator, KeyIdHash > index;
+
+        /**
+         * These hold the second words of the digests of keys seen once
+         * but not yet kept, each forced odd so that zero marks an empty
+         * slot.  A key is kept in the shard only when it's seen a second
+         * time, so that keys used only once never cost an allocation and
+         * their midstates are never kept.
+         */
+        uint64_t seen[SEEN_SLOTS] = {0};
+
+        /**
+         * This is the largest number of keys to keep in the shard.
+         */
+        size_t capacity = 0;
+
+        /**
+         * This is the number of HMAC codes computed with keys found in
+         * the shard.
+         */
+        uint64_t hits = 0;
+
+        /**
+         * This is the number of HMAC codes computed with keys which
+         * weren't found in the shard.
+         */
+        uint64_t misses = 0;
+    };
+
+    /**
+     * This holds the process-wide cache of prepared HMAC keys.
+     */
+    struct Cache {
+        /**
+         * This is the number of shards currently in use.
+         */
+        std::atomic< size_t > numShards{1};
+
+        /**
+         * This is the largest number of keys to keep in all the shards
+         * together.
+         */
+        std::atomic< size_t > capacity{0};
+
+        /**
+         * These are the parts into which the cache is split.  Only the
+         * first numShards of them are used.
+         */
+        Shard shards[MAX_SHARDS];
+
+        /**
+         * These are the secrets, chosen at random, with which the keys
+         * used with each hash function are digested, so that the same
+         * key used with different hash functions is kept separately.
+         */
+        uint64_t secrets[NUM_ALGORITHMS][2];
+
+        /**
+         * This constructor sets up an empty cache, choosing the secrets
+         * with which keys are digested.
+         */
+        Cache() {
+            std::random_device randomDevice;
+            for (auto& secret: secrets) {
+                for (auto& word: secret) {
+                    word = ((uint64_t)randomDevice() << 32) | (uint64_t)randomDevice();
+                }
+            }
+            Configure(
+                Hash::HMAC_KEY_CACHE_DEFAULT_CAPACITY,
+                Hash::HMAC_KEY_CACHE_DEFAULT_SHARDS
+            );
+        }
+
+        /**
+         * This method sets the capacity of the cache and the number of
+         * shards into which it's split, and removes all keys from it.
+         * The capacity is split exactly among the shards, with the first
+         * shards holding one key more than the rest if it doesn't divide
+         * evenly, and fewer shards are used if the capacity is smaller
+         * than the number of shards.
+         *
+         * @param[in] newCapacity
+         *     This is the largest number of keys to keep, or zero to turn
+         *     the cache off.
+         *
+         * @param[in] newNumShards
+         *     This is the number of shards into which to split the cache.
+         */
+        void Configure(
+            size_t newCapacity,
+            size_t newNumShards
+        ) {
+            newNumShards = std::min(std::max(newNumShards, (size_t)1), MAX_SHARDS);
+            if (newCapacity > 0) {
+                newNumShards = std::min(newNumShards, newCapacity);
+            }
+            for (size_t i = 0; i < MAX_SHARDS; ++i) {
+                auto& shard = shards[i];
+                std::lock_guard< std::mutex > lock(shard.mutex);
+                if (i < newNumShards) {
+                    shard.capacity = (
+                        newCapacity / newNumShards
+                        + ((i < newCapacity % newNumShards) ? 1 : 0)
+                    );
+                } else {
+                    shard.capacity = 0;
+                }
+                shard.index.clear();
+                shard.entries.clear();
+                for (auto& seen: shard.seen) {
+                    seen = 0;
+                }
+            }
+            numShards = newNumShards;
+            capacity = newCapacity;
+        }
+
+        /**
+         * This method computes the HMAC code of the given message with
+         * the given key, using the midstates of the key from the cache if
+         * they're there.  Otherwise, the key is added to the cache if it
+         * was seen recently, or just remembered as seen if not, and the
+         * code is computed without the cache.
+         *
+         * @param[in] key
+         *     This points to the key.
+         *
+         * @param[in] keyLength
+         *     This is the length of the key, in bytes.
+         *
+         * @param[in] message
+         *     This points to the message for which to compute the HMAC
+         *     code.
+         *
+         * @param[in] messageLength
+         *     This is the length of the message, in bytes.
+         *
+         * @param[out] code
+         *     This is where to store the HMAC code.
+         */
+        template< typename HashContext > void Compute(
+            const void* key,
+            size_t keyLength,
+            const void* message,
+            size_t messageLength,
+            uint8_t* code
+        ) {
+            if (capacity.load() == 0) {
+                Hash::ComputeHmac< HashContext >(key, keyLength, message, messageLength, code);
+                return;
+            }
+            const auto keyId = SipHash128(
+                secrets[AlgorithmNumber< HashContext >::value],
+                key,
+                keyLength
+            );
+            auto& shard = shards[keyId[1] % numShards.load()];
+            std::shared_ptr< const PreparedKey > preparedKey;
+            bool admit = false;
+            {
+                std::lock_guard< std::mutex > lock(shard.mutex);
+                const auto entry = shard.index.find(keyId);
+                if (entry == shard.index.end()) {
+                    ++shard.misses;
+                    auto& seen = shard.seen[keyId[0] % SEEN_SLOTS];
+                    const auto tag = keyId[1] | 1;
+                    if (seen == tag) {
+                        seen = 0;
+                        admit = true;
+                    } else {
+                        seen = tag;
+                    }
+                } else {
+                    ++shard.hits;
+                    shard.entries.splice(
+                        shard.entries.begin(),
+                        shard.entries,
+                        entry->second
+                    );
+                    preparedKey = entry->second->second;
+                }
+            }
+            if (preparedKey == nullptr) {
+                if (!admit) {
+                    Hash::ComputeHmac< HashContext >(key, keyLength, message, messageLength, code);
+                    return;
+                }
+
+                // Prepare the key without holding the lock, since this may
+                // involve hashing a long key.
+                preparedKey.reset(new PreparedKeyOf< HashContext >(key, keyLength));
+                std::lock_guard< std::mutex > lock(shard.mutex);
+                if (
+                    (shard.capacity > 0)
+                    && (shard.index.find(keyId) == shard.index.end())
+                ) {
+                    while (shard.entries.size() >= shard.capacity) {
+                        (void)shard.index.erase(shard.entries.back().first);
+                        shard.entries.pop_back();
+                    }
+                    shard.entries.emplace_front(keyId, preparedKey);
+                    shard.index[keyId] = shard.entries.begin();
+                }
+            }
+            preparedKey->Compute(message, messageLength, code);
+        }
+    };
+
+    /**
+     * This function returns the process-wide cache of prepared HMAC keys,
+     * setting it up the first time it's called.
+     *
+     * @return
+     *     The process-wide cache of prepared HMAC keys is returned.
+     */
+    Cache& GetCache() {
+        static Cache cache;
+        return cache;
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        template< typename HashContext > void CachedHmac(
+            const void* key,
+            size_t keyLength,
+            const void* message,
+            size_t messageLength,
+            uint8_t* code
+        ) {
+            GetCache().Compute< HashContext >(key, keyLength, message, messageLength, code);
+        }
+
+        template void CachedHmac< Md5Context >(const void*, size_t, const void*, size_t, uint8_t*);
+        template void CachedHmac< Sha1Context >(const void*, size_t, const void*, size_t, uint8_t*);
+        template void CachedHmac< Sha224Context >(const void*, size_t, const void*, size_t, uint8_t*);
+        template void CachedHmac< Sha256Context >(const void*, size_t, const void*, size_t, uint8_t*);
+        template void CachedHmac< Sha384Context >(const void*, size_t, const void*, size_t, uint8_t*);
+        template void CachedHmac< Sha512Context >(const void*, size_t, const void*, size_t, uint8_t*);
+        template void CachedHmac< Sha512t224Context >(const void*, size_t, const void*, size_t, uint8_t*);
+        template void CachedHmac< Sha512t256Context >(const void*, size_t, const void*, size_t, uint8_t*);
+
+    }
+
+    void ConfigureHmacKeyCache(
+        size_t capacity,
+        size_t numShards
+    ) {
+        GetCache().Configure(capacity, numShards);
+    }
+
+    HmacKeyCacheStatistics GetHmacKeyCacheStatistics() {
+        HmacKeyCacheStatistics statistics;
+        for (auto& shard: GetCache().shards) {
+            std::lock_guard< std::mutex > lock(shard.mutex);
+            statistics.hits += shard.hits;
+            statistics.misses += shard.misses;
+            statistics.size += shard.entries.size();
+        }
+        return statistics;
+    }
+
+    void ClearHmacKeyCache() {
+        for (auto& shard: GetCache().shards) {
+            std::lock_guard< std::mutex > lock(shard.mutex);
+            shard.index.clear();
+            shard.entries.clear();
+            for (auto& seen: shard.seen) {
+                seen = 0;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,111 @@
+#ifndef HASH_HMAC_PADS_HPP
+#define HASH_HMAC_PADS_HPP
+
+/**
+ * @file HmacPads.hpp
+ *
+ * This module declares the function templates used to compute HMAC codes
+ * through hash functions which take whole messages, in two parts: forming
+ * the padded inner and outer keys, which depends only on the key, and
+ * hashing the padded keys with the message.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This function forms the padded inner and outer keys of an HMAC
+         * computation, hashing the key first if it's longer than a block.
+         *
+         * The key is never converted to another type; the padded keys are
+         * built in the same type.
+         *
+         * @param[in] hashFunction
+         *     This is the hash function to use to compute digests.
+         *
+         * @param[in] blockSize
+         *     This is the block size of the given hash function, in bytes.
+         *
+         * @param[in] key
+         *     This is the key to use in computing HMAC codes.
+         *
+         * @param[out] innerPad
+         *     This is where to store the padded inner key.
+         *
+         * @param[out] outerPad
+         *     This is where to store the padded outer key.
+         */
+        template< typename Message, typename HashFunction > void PadHmacKey(
+            const HashFunction& hashFunction,
+            size_t blockSize,
+            const Message& key,
+            Message& innerPad,
+            Message& outerPad
+        ) {
+            typedef typename Message::value_type Element;
+            Message normalizedKey(key);
+            if (normalizedKey.size() > blockSize) {
+                const auto keyDigest = hashFunction(normalizedKey);
+                normalizedKey.assign(keyDigest.begin(), keyDigest.end());
+            }
+            normalizedKey.resize(blockSize);
+            innerPad.clear();
+            innerPad.reserve(blockSize);
+            outerPad.clear();
+            outerPad.reserve(blockSize);
+            for (auto b: normalizedKey) {
+                innerPad.push_back((Element)(b ^ 0x36));
+                outerPad.push_back((Element)(b ^ 0x5C));
+            }
+        }
+
+        /**
+         * This function computes the HMAC code for the given message,
+         * using the given hash function, which produces the raw bytes of
+         * message digests, and the given padded keys.
+         *
+         * @param[in] hashFunction
+         *     This is the hash function to use to compute digests.
+         *
+         * @param[in] innerPad
+         *     This is the padded inner key.
+         *
+         * @param[in] outerPad
+         *     This is the padded outer key.
+         *
+         * @param[in] message
+         *     This is the message for which to compute the HMAC code.
+         *
+         * @return
+         *     The HMAC code for the given message is returned.
+         */
+        template< typename Message, typename HashFunction > std::vector< uint8_t > HmacWithPads(
+            const HashFunction& hashFunction,
+            const Message& innerPad,
+            const Message& outerPad,
+            const Message& message
+        ) {
+            Message inner;
+            inner.reserve(innerPad.size() + message.size());
+            inner.insert(inner.end(), innerPad.begin(), innerPad.end());
+            inner.insert(inner.end(), message.begin(), message.end());
+            const auto innerDigest = hashFunction(inner);
+            Message outer;
+            outer.reserve(outerPad.size() + innerDigest.size());
+            outer.insert(outer.end(), outerPad.begin(), outerPad.end());
+            outer.insert(outer.end(), innerDigest.begin(), innerDigest.end());
+            return hashFunction(outer);
+        }
+
+    }
+
+}
+
+#endif /* HASH_HMAC_PADS_HPP */
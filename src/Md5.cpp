@@ -2,11 +2,15 @@
  * @file Md5.cpp
  *
  * This module contains the implementation of the
- * Hash::Md5 function.
+ * Hash::Md5 function and context.
  *
  * © 2019 by Richard Walters
  */
 
+#include "BlockBuffer.hpp"
+#include "Md5Kernels.hpp"
+#include "MultiBuffer.hpp"
+
 #include <Hash/Md5.hpp>
 #include <string.h>
 #include <stdint.h>
@@ -34,21 +38,188 @@ namespace {
         );
     }
 
+    /**
+     * These are the per-round shift amounts of the MD5 hash function.
+     */
+    constexpr size_t s[64] = {
+        7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
+        5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,
+        4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,
+        6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21
+    };
+
+    /**
+     * This function returns the index of the message word used in the
+     * given step of MD5.
+     *
+     * @param[in] i
+     *     This is the index of the step.
+     *
+     * @return
+     *     The index of the message word used in the given step is returned.
+     */
+    constexpr size_t MessageIndex(size_t i) {
+        return (
+            (i < 16) ? i
+            : (i < 32) ? (5 * i + 1) % 16
+            : (i < 48) ? (3 * i + 5) % 16
+            : (7 * i) % 16
+        );
+    }
+
+    /**
+     * This function computes the auxiliary function of the given round
+     * of MD5 (F, G, H, or I).
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in] d
+     *     This is working variable D.
+     *
+     * @return
+     *     The result of the auxiliary function is returned.
+     */
+    template< size_t round > inline uint32_t Auxiliary(uint32_t b, uint32_t c, uint32_t d);
+
+    template<> inline uint32_t Auxiliary< 0 >(uint32_t b, uint32_t c, uint32_t d) {
+        return ((c ^ d) & b) ^ d;
+    }
+
+    template<> inline uint32_t Auxiliary< 1 >(uint32_t b, uint32_t c, uint32_t d) {
+        return ((b ^ c) & d) ^ c;
+    }
+
+    template<> inline uint32_t Auxiliary< 2 >(uint32_t b, uint32_t c, uint32_t d) {
+        return b ^ c ^ d;
+    }
+
+    template<> inline uint32_t Auxiliary< 3 >(uint32_t b, uint32_t c, uint32_t d) {
+        return c ^ (b | ~d);
+    }
+
+    /**
+     * This function performs one step of MD5.  The step number is a
+     * template parameter, so the auxiliary function, shift amount, round
+     * constant, and message index are all fixed at compile time.  Rather
+     * than shifting every working variable, the caller rotates the order
+     * in which it passes them.
+     *
+     * @param[in,out] a
+     *     This is working variable A, which becomes working variable B
+     *     for the next step.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in] d
+     *     This is working variable D.
+     *
+     * @param[in] m
+     *     These are the sixteen message words of the block.
+     */
+    template< size_t i > inline void Step(
+        uint32_t& a, uint32_t b, uint32_t c, uint32_t d,
+        const uint32_t* m
+    ) {
+        a = b + Rot(
+            a + Auxiliary< i / 16 >(b, c, d) + Hash::Internal::Md5K[i] + m[MessageIndex(i)],
+            s[i]
+        );
+    }
+
+    /**
+     * This function performs four consecutive steps of MD5, after which
+     * the working variables are back in their original places.
+     *
+     * @param[in,out] v
+     *     These are the four working variables.
+     *
+     * @param[in] m
+     *     These are the sixteen message words of the block.
+     */
+    template< size_t i > inline void FourSteps(uint32_t* v, const uint32_t* m) {
+        Step< i + 0 >(v[0], v[1], v[2], v[3], m);
+        Step< i + 1 >(v[3], v[0], v[1], v[2], m);
+        Step< i + 2 >(v[2], v[3], v[0], v[1], m);
+        Step< i + 3 >(v[1], v[2], v[3], v[0], m);
+    }
+
+    /**
+     * These are the initial hash values of the MD5 hash function.
+     */
+    const uint32_t MD5_INITIAL_HASH_VALUES[4] = {
+        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476
+    };
+
+    /**
+     * This function updates the given MD5 hash values by compressing the
+     * given message blocks into them.
+     *
+     * @param[in,out] state
+     *     These are the four hash values to update.
+     *
+     * @param[in] blocks
+     *     This points to the message blocks to compress.
+     *
+     * @param[in] numBlocks
+     *     This is the number of 64-byte message blocks to compress.
+     */
+    void Md5Compress(
+        uint32_t* state,
+        const uint8_t* blocks,
+        size_t numBlocks
+    ) {
+        uint32_t M[16];
+        uint32_t v[4];
+        for (; numBlocks > 0; --numBlocks, blocks += 64) {
+            for (size_t i = 0; i < 16; ++i) {
+                M[i] = (
+                    (uint32_t)blocks[i * 4 + 0]
+                    | ((uint32_t)blocks[i * 4 + 1] << 8)
+                    | ((uint32_t)blocks[i * 4 + 2] << 16)
+                    | ((uint32_t)blocks[i * 4 + 3] << 24)
+                );
+            }
+            (void)memcpy(v, state, sizeof(v));
+            FourSteps< 0 >(v, M);
+            FourSteps< 4 >(v, M);
+            FourSteps< 8 >(v, M);
+            FourSteps< 12 >(v, M);
+            FourSteps< 16 >(v, M);
+            FourSteps< 20 >(v, M);
+            FourSteps< 24 >(v, M);
+            FourSteps< 28 >(v, M);
+            FourSteps< 32 >(v, M);
+            FourSteps< 36 >(v, M);
+            FourSteps< 40 >(v, M);
+            FourSteps< 44 >(v, M);
+            FourSteps< 48 >(v, M);
+            FourSteps< 52 >(v, M);
+            FourSteps< 56 >(v, M);
+            FourSteps< 60 >(v, M);
+            for (size_t i = 0; i < 4; ++i) {
+                state[i] += v[i];
+            }
+        }
+    }
+
 }
 
 namespace Hash {
 
-    std::vector< uint8_t > Md5(const std::vector< uint8_t >& data) {
-        // This a straightforward implementation of the pseudocode
-        // found in the Wikipedia page for MD5
-        // (https://en.wikipedia.org/wiki/MD5).
-        static size_t s[64] = {
-            7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
-            5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,
-            4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,
-            6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21
-        };
-        static uint32_t K[64] = {
+    namespace Internal {
+
+        /**
+         * These are the per-round constants of the MD5 hash function.
+         */
+        const uint32_t Md5K[64] = {
             0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
             0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
             0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
@@ -66,92 +237,123 @@ namespace Hash {
             0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
             0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
         };
-        uint8_t chunk[64];
-        uint32_t M[16];
-        uint32_t a0 = 0x67452301;
-        uint32_t b0 = 0xEFCDAB89;
-        uint32_t c0 = 0x98BADCFE;
-        uint32_t d0 = 0x10325476;
-        uint64_t ml = (uint64_t)data.size() * 8;
-        for (size_t offset = 0; offset < data.size() + 9; offset += 64) {
-            if (offset + 64 <= data.size()) {
-                (void)memcpy(chunk, &data[offset], 64);
-            } else {
-                (void)memset(chunk, 0, 64);
-                if (offset < data.size()) {
-                    (void)memcpy(chunk, &data[offset], data.size() - offset);
-                }
-                if (offset <= data.size()) {
-                    chunk[data.size() - offset] = 0x80;
-                }
-                if (offset + 64 - data.size() >= 9) {
-                    chunk[56] = (uint8_t)ml;
-                    chunk[57] = (uint8_t)(ml >> 8);
-                    chunk[58] = (uint8_t)(ml >> 16);
-                    chunk[59] = (uint8_t)(ml >> 24);
-                    chunk[60] = (uint8_t)(ml >> 32);
-                    chunk[61] = (uint8_t)(ml >> 40);
-                    chunk[62] = (uint8_t)(ml >> 48);
-                    chunk[63] = (uint8_t)(ml >> 56);
-                }
-            }
-            for (size_t i = 0; i < 16; ++i) {
-                M[i] = (
-                    (uint32_t)chunk[i * 4 + 0]
-                    | ((uint32_t)chunk[i * 4 + 1] << 8)
-                    | ((uint32_t)chunk[i * 4 + 2] << 16)
-                    | ((uint32_t)chunk[i * 4 + 3] << 24)
-                );
+
+    }
+
+    Md5Context::Md5Context() {
+        Reset();
+    }
+
+    void Md5Context::Reset() {
+        (void)memcpy(state_, MD5_INITIAL_HASH_VALUES, sizeof(state_));
+        bufferLength_ = 0;
+        messageLength_ = 0;
+    }
+
+    void Md5Context::Update(const void* data, size_t length) {
+        messageLength_ += length;
+        Internal::AbsorbData< MD5_BLOCK_SIZE >(
+            buffer_,
+            bufferLength_,
+            (const uint8_t*)data,
+            length,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Md5Compress(state_, blocks, numBlocks);
             }
-            uint32_t A = a0;
-            uint32_t B = b0;
-            uint32_t C = c0;
-            uint32_t D = d0;
-            for (size_t i = 0; i < 64; ++i) {
-                uint32_t F;
-                size_t g;
-                if (i < 16) {
-                    F = (B & C) | ((~B) & D);
-                    g = i;
-                } else if (i < 32) {
-                    F = (D & B) | ((~D) & C);
-                    g = (5 * i + 1) % 16;
-                } else if (i < 48) {
-                    F = B ^ C ^ D;
-                    g = (3 * i + 5) % 16;
-                } else {
-                    F = C ^ (B | (~D));
-                    g = (7 * i) % 16;
-                }
-                F = F + A + K[i] + M[g];
-                A = D;
-                D = C;
-                C = B;
-                B = B + Rot(F, s[i]);
+        );
+    }
+
+    void Md5Context::Update(const std::vector< uint8_t >& data) {
+        Update(data.data(), data.size());
+    }
+
+    std::vector< uint8_t > Md5Context::Final() {
+        std::vector< uint8_t > digest(MD5_DIGEST_LENGTH / 8);
+        Final(digest.data());
+        return digest;
+    }
+
+    void Md5Context::Final(uint8_t* digest) {
+        Internal::PadAndCompress< MD5_BLOCK_SIZE, 8, false >(
+            buffer_,
+            bufferLength_,
+            messageLength_,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Md5Compress(state_, blocks, numBlocks);
             }
-            a0 += A;
-            b0 += B;
-            c0 += C;
-            d0 += D;
+        );
+        for (size_t i = 0; i < MD5_DIGEST_LENGTH / 8; ++i) {
+            digest[i] = (uint8_t)(state_[i / 4] >> ((i % 4) * 8));
         }
-        return {
-            (uint8_t)(a0 & 0xff),
-            (uint8_t)((a0 >> 8) & 0xff),
-            (uint8_t)((a0 >> 16) & 0xff),
-            (uint8_t)((a0 >> 24) & 0xff),
-            (uint8_t)(b0 & 0xff),
-            (uint8_t)((b0 >> 8) & 0xff),
-            (uint8_t)((b0 >> 16) & 0xff),
-            (uint8_t)((b0 >> 24) & 0xff),
-            (uint8_t)(c0 & 0xff),
-            (uint8_t)((c0 >> 8) & 0xff),
-            (uint8_t)((c0 >> 16) & 0xff),
-            (uint8_t)((c0 >> 24) & 0xff),
-            (uint8_t)(d0 & 0xff),
-            (uint8_t)((d0 >> 8) & 0xff),
-            (uint8_t)((d0 >> 16) & 0xff),
-            (uint8_t)((d0 >> 24) & 0xff),
-        };
+        Reset();
+    }
+
+    std::vector< uint8_t > Md5(const std::vector< uint8_t >& data) {
+        std::vector< uint8_t > digest(MD5_DIGEST_LENGTH / 8);
+        ComputeMd5(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeMd5(const void* data, size_t length, uint8_t* digest) {
+        Md5Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Md5Digest ComputeMd5(const void* data, size_t length) {
+        Md5Digest digest;
+        ComputeMd5(data, length, digest.data());
+        return digest;
+    }
+
+    void Md5Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    ) {
+#if HASH_TARGET_X86
+        const auto& features = Internal::GetCpuFeatures();
+        if (features.avx512) {
+            Internal::HashInLanes< uint32_t, 4, 16, MD5_BLOCK_SIZE, 8, false >(
+                messages,
+                lengths,
+                numMessages,
+                MD5_INITIAL_HASH_VALUES,
+                digests,
+                MD5_DIGEST_LENGTH / 8,
+                Internal::Md5CompressAvx512x16
+            );
+            return;
+        }
+        if (features.avx2) {
+            Internal::HashInLanes< uint32_t, 4, 8, MD5_BLOCK_SIZE, 8, false >(
+                messages,
+                lengths,
+                numMessages,
+                MD5_INITIAL_HASH_VALUES,
+                digests,
+                MD5_DIGEST_LENGTH / 8,
+                Internal::Md5CompressAvx2x8
+            );
+            return;
+        }
+#endif
+        Internal::HashOneAtATime< uint32_t, 4, MD5_BLOCK_SIZE, 8, false >(
+            messages,
+            lengths,
+            numMessages,
+            MD5_INITIAL_HASH_VALUES,
+            digests,
+            MD5_DIGEST_LENGTH / 8,
+            Md5Compress
+        );
+    }
+
+    std::vector< uint8_t > Md5Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    ) {
+        return Internal::BatchVectors(messages, MD5_DIGEST_LENGTH / 8, Md5Batch);
     }
 
 }
@@ -0,0 +1,78 @@
+#ifndef HASH_MD5_KERNELS_HPP
+#define HASH_MD5_KERNELS_HPP
+
+/**
+ * @file Md5Kernels.hpp
+ *
+ * This module declares the constants and multi-buffer block compression
+ * kernels of the MD5 hash function.  Each kernel updates the hash values
+ * of several independent messages by compressing one block of each message
+ * into them.  The kernels require optional instruction set extensions and
+ * must only be called if the CPU supports them.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "CpuFeatures.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * These are the per-round constants of the MD5 hash function.
+         */
+        extern const uint32_t Md5K[64];
+
+#if HASH_TARGET_X86
+        /**
+         * This function updates the MD5 hash values of eight independent
+         * messages by compressing one block of each message into them,
+         * using AVX2.
+         *
+         * @note
+         *     This requires the AVX2 extensions.
+         *
+         * @param[in,out] states
+         *     These are the hash values of the eight messages, stored
+         *     word-major (word i of message j is at index i * 8 + j).
+         *
+         * @param[in] blocks
+         *     These point to the 64-byte message blocks to compress,
+         *     one for each message.
+         */
+        void Md5CompressAvx2x8(
+            uint32_t* states,
+            const uint8_t* const* blocks
+        );
+
+        /**
+         * This function updates the MD5 hash values of sixteen independent
+         * messages by compressing one block of each message into them,
+         * using AVX-512.
+         *
+         * @note
+         *     This requires the AVX-512 foundation extensions.
+         *
+         * @param[in,out] states
+         *     These are the hash values of the sixteen messages, stored
+         *     word-major (word i of message j is at index i * 16 + j).
+         *
+         * @param[in] blocks
+         *     These point to the 64-byte message blocks to compress,
+         *     one for each message.
+         */
+        void Md5CompressAvx512x16(
+            uint32_t* states,
+            const uint8_t* const* blocks
+        );
+#endif
+
+    }
+
+}
+
+#endif /* HASH_MD5_KERNELS_HPP */
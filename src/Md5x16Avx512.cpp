@@ -0,0 +1,160 @@
+/**
+ * @file Md5x16Avx512.cpp
+ *
+ * This module contains the implementation of the multi-buffer MD5
+ * block compression kernel which uses AVX-512 to compress one block of each
+ * of sixteen independent messages at once.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Md5Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * These are the ternary logic immediates which select, bit by bit,
+     * the auxiliary function of each round of MD5 (F, G, H, and I),
+     * applied to working variables B, C, and D in that order.
+     */
+    enum : int {
+        AUXILIARY_F = 0xCA,
+        AUXILIARY_G = 0xE4,
+        AUXILIARY_H = 0x96,
+        AUXILIARY_I = 0x39,
+    };
+
+    /**
+     * This function performs four steps of a round of MD5 in all sixteen
+     * lanes.
+     *
+     * @param[in,out] a
+     *     This is working variable A.
+     *
+     * @param[in,out] b
+     *     This is working variable B.
+     *
+     * @param[in,out] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D.
+     *
+     * @param[in] m
+     *     These are the sixteen message words of the block.
+     *
+     * @param[in] i
+     *     This is the index of the first of the four steps.
+     */
+    template<
+        int round,
+        int auxiliary,
+        int s0, int s1, int s2, int s3
+    > inline void FourSteps(
+        __m512i& a, __m512i& b, __m512i& c, __m512i& d,
+        const __m512i* m,
+        size_t i
+    ) {
+        static const size_t multiplier[4] = {1, 5, 3, 7};
+        static const size_t offset[4] = {0, 1, 5, 0};
+        const auto mk = [m, i](size_t step){
+            const auto g = (multiplier[round] * (i + step) + offset[round]) % 16;
+            return _mm512_add_epi32(
+                m[g],
+                _mm512_set1_epi32((int)Hash::Internal::Md5K[i + step])
+            );
+        };
+        a = _mm512_add_epi32(b, _mm512_rol_epi32(_mm512_add_epi32(_mm512_add_epi32(a, _mm512_ternarylogic_epi32(b, c, d, auxiliary)), mk(0)), s0));
+        d = _mm512_add_epi32(a, _mm512_rol_epi32(_mm512_add_epi32(_mm512_add_epi32(d, _mm512_ternarylogic_epi32(a, b, c, auxiliary)), mk(1)), s1));
+        c = _mm512_add_epi32(d, _mm512_rol_epi32(_mm512_add_epi32(_mm512_add_epi32(c, _mm512_ternarylogic_epi32(d, a, b, auxiliary)), mk(2)), s2));
+        b = _mm512_add_epi32(c, _mm512_rol_epi32(_mm512_add_epi32(_mm512_add_epi32(b, _mm512_ternarylogic_epi32(c, d, a, auxiliary)), mk(3)), s3));
+    }
+
+    /**
+     * This function loads the sixteen little-endian 32-bit words of each
+     * of sixteen blocks and transposes them, so that each resulting
+     * vector holds the same word of all sixteen blocks.
+     *
+     * @param[in] blocks
+     *     These point to the blocks from which to load words.
+     *
+     * @param[out] w
+     *     This is where to store the sixteen transposed words.
+     */
+    inline void LoadTransposed(
+        const uint8_t* const* blocks,
+        __m512i* w
+    ) {
+        __m512i r[16];
+        for (size_t i = 0; i < 16; ++i) {
+            r[i] = _mm512_loadu_si512((const void*)blocks[i]);
+        }
+        __m512i t[16];
+        for (size_t i = 0; i < 8; ++i) {
+            t[i * 2] = _mm512_unpacklo_epi32(r[i * 2], r[i * 2 + 1]);
+            t[i * 2 + 1] = _mm512_unpackhi_epi32(r[i * 2], r[i * 2 + 1]);
+        }
+        __m512i u[16];
+        for (size_t i = 0; i < 4; ++i) {
+            u[i * 4 + 0] = _mm512_unpacklo_epi64(t[i * 4], t[i * 4 + 2]);
+            u[i * 4 + 1] = _mm512_unpackhi_epi64(t[i * 4], t[i * 4 + 2]);
+            u[i * 4 + 2] = _mm512_unpacklo_epi64(t[i * 4 + 1], t[i * 4 + 3]);
+            u[i * 4 + 3] = _mm512_unpackhi_epi64(t[i * 4 + 1], t[i * 4 + 3]);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            const auto even0 = _mm512_shuffle_i32x4(u[i], u[i + 4], 0x88);
+            const auto odd0 = _mm512_shuffle_i32x4(u[i], u[i + 4], 0xDD);
+            const auto even1 = _mm512_shuffle_i32x4(u[i + 8], u[i + 12], 0x88);
+            const auto odd1 = _mm512_shuffle_i32x4(u[i + 8], u[i + 12], 0xDD);
+            w[i] = _mm512_shuffle_i32x4(even0, even1, 0x88);
+            w[i + 8] = _mm512_shuffle_i32x4(even0, even1, 0xDD);
+            w[i + 4] = _mm512_shuffle_i32x4(odd0, odd1, 0x88);
+            w[i + 12] = _mm512_shuffle_i32x4(odd0, odd1, 0xDD);
+        }
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Md5CompressAvx512x16(
+            uint32_t* states,
+            const uint8_t* const* blocks
+        ) {
+            __m512i m[16];
+            LoadTransposed(blocks, m);
+            auto a = _mm512_loadu_si512((const void*)(states + 0));
+            auto b = _mm512_loadu_si512((const void*)(states + 16));
+            auto c = _mm512_loadu_si512((const void*)(states + 32));
+            auto d = _mm512_loadu_si512((const void*)(states + 48));
+            const auto a0 = a, b0 = b, c0 = c, d0 = d;
+            for (size_t i = 0; i < 16; i += 4) {
+                FourSteps< 0, AUXILIARY_F, 7, 12, 17, 22 >(a, b, c, d, m, i);
+            }
+            for (size_t i = 16; i < 32; i += 4) {
+                FourSteps< 1, AUXILIARY_G, 5, 9, 14, 20 >(a, b, c, d, m, i);
+            }
+            for (size_t i = 32; i < 48; i += 4) {
+                FourSteps< 2, AUXILIARY_H, 4, 11, 16, 23 >(a, b, c, d, m, i);
+            }
+            for (size_t i = 48; i < 64; i += 4) {
+                FourSteps< 3, AUXILIARY_I, 6, 10, 15, 21 >(a, b, c, d, m, i);
+            }
+            _mm512_storeu_si512((void*)(states + 0), _mm512_add_epi32(a, a0));
+            _mm512_storeu_si512((void*)(states + 16), _mm512_add_epi32(b, b0));
+            _mm512_storeu_si512((void*)(states + 32), _mm512_add_epi32(c, c0));
+            _mm512_storeu_si512((void*)(states + 48), _mm512_add_epi32(d, d0));
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
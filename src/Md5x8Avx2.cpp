@@ -0,0 +1,207 @@
+/**
+ * @file Md5x8Avx2.cpp
+ *
+ * This module contains the implementation of the multi-buffer MD5
+ * block compression kernel which uses AVX2 to compress one block of each
+ * of eight independent messages at once.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Md5Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function rotates each 32-bit element of the given vector left
+     * by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the vector whose elements to rotate.
+     *
+     * @return
+     *     The rotated vector is returned.
+     */
+    template< int bits > inline __m256i Rot(__m256i x) {
+        return _mm256_or_si256(
+            _mm256_slli_epi32(x, bits),
+            _mm256_srli_epi32(x, 32 - bits)
+        );
+    }
+
+    /**
+     * This function computes the auxiliary function of the given round
+     * of MD5 (F, G, H, or I) in all eight lanes.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in] d
+     *     This is working variable D.
+     *
+     * @return
+     *     The result of the auxiliary function is returned.
+     */
+    template< int round > inline __m256i Auxiliary(__m256i b, __m256i c, __m256i d);
+
+    template<> inline __m256i Auxiliary< 0 >(__m256i b, __m256i c, __m256i d) {
+        return _mm256_xor_si256(_mm256_and_si256(_mm256_xor_si256(c, d), b), d);
+    }
+
+    template<> inline __m256i Auxiliary< 1 >(__m256i b, __m256i c, __m256i d) {
+        return _mm256_xor_si256(_mm256_and_si256(_mm256_xor_si256(b, c), d), c);
+    }
+
+    template<> inline __m256i Auxiliary< 2 >(__m256i b, __m256i c, __m256i d) {
+        return _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+    }
+
+    template<> inline __m256i Auxiliary< 3 >(__m256i b, __m256i c, __m256i d) {
+        const auto notD = _mm256_xor_si256(d, _mm256_set1_epi32(-1));
+        return _mm256_xor_si256(c, _mm256_or_si256(b, notD));
+    }
+
+    /**
+     * This function performs four steps of the given round of MD5 in all
+     * eight lanes.
+     *
+     * @param[in,out] a
+     *     This is working variable A.
+     *
+     * @param[in,out] b
+     *     This is working variable B.
+     *
+     * @param[in,out] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D.
+     *
+     * @param[in] m
+     *     These are the sixteen message words of the block.
+     *
+     * @param[in] i
+     *     This is the index of the first of the four steps.
+     */
+    template<
+        int round,
+        int s0, int s1, int s2, int s3
+    > inline void FourSteps(
+        __m256i& a, __m256i& b, __m256i& c, __m256i& d,
+        const __m256i* m,
+        size_t i
+    ) {
+        static const size_t multiplier[4] = {1, 5, 3, 7};
+        static const size_t offset[4] = {0, 1, 5, 0};
+        const auto mk = [m, i](size_t step){
+            const auto g = (multiplier[round] * (i + step) + offset[round]) % 16;
+            return _mm256_add_epi32(
+                m[g],
+                _mm256_set1_epi32((int)Hash::Internal::Md5K[i + step])
+            );
+        };
+        a = _mm256_add_epi32(b, Rot< s0 >(_mm256_add_epi32(_mm256_add_epi32(a, Auxiliary< round >(b, c, d)), mk(0))));
+        d = _mm256_add_epi32(a, Rot< s1 >(_mm256_add_epi32(_mm256_add_epi32(d, Auxiliary< round >(a, b, c)), mk(1))));
+        c = _mm256_add_epi32(d, Rot< s2 >(_mm256_add_epi32(_mm256_add_epi32(c, Auxiliary< round >(d, a, b)), mk(2))));
+        b = _mm256_add_epi32(c, Rot< s3 >(_mm256_add_epi32(_mm256_add_epi32(b, Auxiliary< round >(c, d, a)), mk(3))));
+    }
+
+    /**
+     * This function loads eight consecutive little-endian 32-bit words
+     * from each of eight blocks and transposes them, so that each resulting
+     * vector holds the same word of all eight blocks.
+     *
+     * @param[in] blocks
+     *     These point to the blocks from which to load words.
+     *
+     * @param[in] offset
+     *     This is the offset, in bytes, of the first word to load
+     *     from each block.
+     *
+     * @param[out] w
+     *     This is where to store the eight transposed words.
+     */
+    inline void LoadTransposed(
+        const uint8_t* const* blocks,
+        size_t offset,
+        __m256i* w
+    ) {
+        __m256i r[8];
+        for (size_t i = 0; i < 8; ++i) {
+            r[i] = _mm256_loadu_si256((const __m256i*)(blocks[i] + offset));
+        }
+        const auto t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+        const auto t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        const auto t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+        const auto t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        const auto t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+        const auto t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        const auto t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+        const auto t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+        const auto u0 = _mm256_unpacklo_epi64(t0, t2);
+        const auto u1 = _mm256_unpackhi_epi64(t0, t2);
+        const auto u2 = _mm256_unpacklo_epi64(t1, t3);
+        const auto u3 = _mm256_unpackhi_epi64(t1, t3);
+        const auto u4 = _mm256_unpacklo_epi64(t4, t6);
+        const auto u5 = _mm256_unpackhi_epi64(t4, t6);
+        const auto u6 = _mm256_unpacklo_epi64(t5, t7);
+        const auto u7 = _mm256_unpackhi_epi64(t5, t7);
+        w[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        w[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        w[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        w[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        w[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        w[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        w[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        w[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Md5CompressAvx2x8(
+            uint32_t* states,
+            const uint8_t* const* blocks
+        ) {
+            __m256i m[16];
+            LoadTransposed(blocks, 0, m);
+            LoadTransposed(blocks, 32, m + 8);
+            auto a = _mm256_loadu_si256((const __m256i*)(states + 0));
+            auto b = _mm256_loadu_si256((const __m256i*)(states + 8));
+            auto c = _mm256_loadu_si256((const __m256i*)(states + 16));
+            auto d = _mm256_loadu_si256((const __m256i*)(states + 24));
+            const auto a0 = a, b0 = b, c0 = c, d0 = d;
+            for (size_t i = 0; i < 16; i += 4) {
+                FourSteps< 0, 7, 12, 17, 22 >(a, b, c, d, m, i);
+            }
+            for (size_t i = 16; i < 32; i += 4) {
+                FourSteps< 1, 5, 9, 14, 20 >(a, b, c, d, m, i);
+            }
+            for (size_t i = 32; i < 48; i += 4) {
+                FourSteps< 2, 4, 11, 16, 23 >(a, b, c, d, m, i);
+            }
+            for (size_t i = 48; i < 64; i += 4) {
+                FourSteps< 3, 6, 10, 15, 21 >(a, b, c, d, m, i);
+            }
+            _mm256_storeu_si256((__m256i*)(states + 0), _mm256_add_epi32(a, a0));
+            _mm256_storeu_si256((__m256i*)(states + 8), _mm256_add_epi32(b, b0));
+            _mm256_storeu_si256((__m256i*)(states + 16), _mm256_add_epi32(c, c0));
+            _mm256_storeu_si256((__m256i*)(states + 24), _mm256_add_epi32(d, d0));
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
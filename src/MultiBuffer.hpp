@@ -0,0 +1,308 @@
+#ifndef HASH_MULTI_BUFFER_HPP
+#define HASH_MULTI_BUFFER_HPP
+
+/**
+ * @file MultiBuffer.hpp
+ *
+ * This module declares the function templates used to compute the message
+ * digests of many independent messages at once, by feeding them through
+ * the lanes of a multi-buffer compression kernel.  Each lane hashes one
+ * message at a time, and is given the next message as soon as it finishes
+ * the one it has.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BlockBuffer.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This function stores the given hash values as a message digest.
+         *
+         * @param[in] state
+         *     These are the hash values to store.
+         *
+         * @param[in] stride
+         *     This is the distance between consecutive hash values.
+         *
+         * @param[out] digest
+         *     This is where to store the message digest.
+         *
+         * @param[in] digestSize
+         *     This is the size, in bytes, of the message digest.
+         */
+        template< typename Word, bool bigEndian > void StoreDigest(
+            const Word* state,
+            size_t stride,
+            uint8_t* digest,
+            size_t digestSize
+        ) {
+            for (size_t i = 0; i < digestSize; ++i) {
+                const auto word = state[(i / sizeof(Word)) * stride];
+                const auto shift = (
+                    bigEndian
+                    ? (sizeof(Word) - 1 - (i % sizeof(Word))) * 8
+                    : (i % sizeof(Word)) * 8
+                );
+                digest[i] = (uint8_t)(word >> shift);
+            }
+        }
+
+        /**
+         * This function computes the message digests of the given messages,
+         * one after another, using the given single-buffer compression
+         * kernel.  It's the fallback for CPUs which have no multi-buffer
+         * kernel, or for which the single-buffer kernel is faster.
+         *
+         * @param[in] messages
+         *     This points to the first byte of each message.
+         *
+         * @param[in] lengths
+         *     These are the lengths, in bytes, of the messages.
+         *
+         * @param[in] numMessages
+         *     This is the number of messages.
+         *
+         * @param[in] initialHashValues
+         *     These are the initial hash values of the hash function.
+         *
+         * @param[out] digests
+         *     This is where to store the message digests, one after
+         *     the other, in the same order as the messages.
+         *
+         * @param[in] digestSize
+         *     This is the size, in bytes, of each message digest.
+         *
+         * @param[in] compress
+         *     This is the single-buffer compression kernel to use.
+         */
+        template<
+            typename Word,
+            size_t stateWords,
+            size_t blockSize,
+            size_t lengthFieldSize,
+            bool bigEndian,
+            typename Compress
+        > void HashOneAtATime(
+            const uint8_t* const* messages,
+            const size_t* lengths,
+            size_t numMessages,
+            const Word* initialHashValues,
+            uint8_t* digests,
+            size_t digestSize,
+            Compress compress
+        ) {
+            Word state[stateWords];
+            uint8_t finalBlocks[blockSize * 2];
+            for (size_t i = 0; i < numMessages; ++i) {
+                (void)memcpy(state, initialHashValues, sizeof(state));
+                const auto wholeBlocks = lengths[i] / blockSize;
+                if (wholeBlocks > 0) {
+                    compress(state, messages[i], wholeBlocks);
+                }
+                const auto numFinalBlocks = PadFinalBlocks< blockSize, lengthFieldSize, bigEndian >(
+                    finalBlocks,
+                    messages[i] + wholeBlocks * blockSize,
+                    lengths[i] % blockSize,
+                    lengths[i]
+                );
+                compress(state, finalBlocks, numFinalBlocks);
+                StoreDigest< Word, bigEndian >(
+                    state,
+                    1,
+                    digests + i * digestSize,
+                    digestSize
+                );
+            }
+        }
+
+        /**
+         * This function computes the message digests of the given messages,
+         * using the given multi-buffer compression kernel.
+         *
+         * The kernel is called with the hash values of all lanes, stored
+         * word-major (word i of lane j is at index i * lanes + j), and an
+         * array holding a pointer to one block for each lane.  It must
+         * compress each lane's block into that lane's hash values.
+         *
+         * @param[in] messages
+         *     This points to the first byte of each message.
+         *
+         * @param[in] lengths
+         *     These are the lengths, in bytes, of the messages.
+         *
+         * @param[in] numMessages
+         *     This is the number of messages.
+         *
+         * @param[in] initialHashValues
+         *     These are the initial hash values of the hash function.
+         *
+         * @param[out] digests
+         *     This is where to store the message digests, one after
+         *     the other, in the same order as the messages.
+         *
+         * @param[in] digestSize
+         *     This is the size, in bytes, of each message digest.
+         *
+         * @param[in] kernel
+         *     This is the multi-buffer compression kernel to use.
+         */
+        template<
+            typename Word,
+            size_t stateWords,
+            size_t lanes,
+            size_t blockSize,
+            size_t lengthFieldSize,
+            bool bigEndian,
+            typename Kernel
+        > void HashInLanes(
+            const uint8_t* const* messages,
+            const size_t* lengths,
+            size_t numMessages,
+            const Word* initialHashValues,
+            uint8_t* digests,
+            size_t digestSize,
+            Kernel kernel
+        ) {
+            struct Lane {
+                bool active = false;
+                size_t message = 0;
+                const uint8_t* nextBlock = nullptr;
+                size_t blocksLeft = 0;
+                size_t finalBlocksLeft = 0;
+                uint8_t finalBlocks[blockSize * 2];
+            } lane[lanes];
+            Word states[stateWords * lanes];
+            const uint8_t* blocks[lanes];
+            const uint8_t idleBlock[blockSize] = {0};
+            size_t nextMessage = 0;
+            size_t activeLanes = 0;
+            const auto startNextMessage = [&](size_t j) {
+                auto& l = lane[j];
+                if (nextMessage >= numMessages) {
+                    l.active = false;
+                    return;
+                }
+                l.active = true;
+                l.message = nextMessage++;
+                const auto length = lengths[l.message];
+                l.nextBlock = messages[l.message];
+                l.blocksLeft = length / blockSize;
+                l.finalBlocksLeft = PadFinalBlocks< blockSize, lengthFieldSize, bigEndian >(
+                    l.finalBlocks,
+                    l.nextBlock + l.blocksLeft * blockSize,
+                    length % blockSize,
+                    length
+                );
+                if (l.blocksLeft == 0) {
+                    l.nextBlock = l.finalBlocks;
+                    l.blocksLeft = l.finalBlocksLeft;
+                    l.finalBlocksLeft = 0;
+                }
+                for (size_t i = 0; i < stateWords; ++i) {
+                    states[i * lanes + j] = initialHashValues[i];
+                }
+            };
+            for (size_t j = 0; j < lanes; ++j) {
+                startNextMessage(j);
+                if (lane[j].active) {
+                    ++activeLanes;
+                }
+            }
+            while (activeLanes > 0) {
+                for (size_t j = 0; j < lanes; ++j) {
+                    blocks[j] = (lane[j].active ? lane[j].nextBlock : idleBlock);
+                }
+                kernel(states, blocks);
+                for (size_t j = 0; j < lanes; ++j) {
+                    auto& l = lane[j];
+                    if (!l.active) {
+                        continue;
+                    }
+                    l.nextBlock += blockSize;
+                    if (--l.blocksLeft > 0) {
+                        continue;
+                    }
+                    if (l.finalBlocksLeft > 0) {
+                        l.nextBlock = l.finalBlocks;
+                        l.blocksLeft = l.finalBlocksLeft;
+                        l.finalBlocksLeft = 0;
+                        continue;
+                    }
+                    StoreDigest< Word, bigEndian >(
+                        states + j,
+                        lanes,
+                        digests + l.message * digestSize,
+                        digestSize
+                    );
+                    startNextMessage(j);
+                    if (!l.active) {
+                        --activeLanes;
+                    }
+                }
+            }
+        }
+
+        /**
+         * This is the signature of a public function which computes the
+         * message digests of many independent messages at once.
+         */
+        using BatchFunction = void(*)(
+            const uint8_t* const* messages,
+            const size_t* lengths,
+            size_t numMessages,
+            uint8_t* digests
+        );
+
+        /**
+         * This function adapts a batch hash function taking pointers and
+         * lengths to one taking a vector of messages.
+         *
+         * @param[in] messages
+         *     These are the messages for which to compute message digests.
+         *
+         * @param[in] digestSize
+         *     This is the size, in bytes, of each message digest.
+         *
+         * @param[in] batch
+         *     This is the batch hash function to call.
+         *
+         * @return
+         *     The message digests of the given messages are returned one
+         *     after the other, in the same order as the messages, in a
+         *     single vector of bytes.
+         */
+        inline std::vector< uint8_t > BatchVectors(
+            const std::vector< std::vector< uint8_t > >& messages,
+            size_t digestSize,
+            BatchFunction batch
+        ) {
+            std::vector< const uint8_t* > pointers(messages.size());
+            std::vector< size_t > lengths(messages.size());
+            for (size_t i = 0; i < messages.size(); ++i) {
+                pointers[i] = messages[i].data();
+                lengths[i] = messages[i].size();
+            }
+            std::vector< uint8_t > digests(messages.size() * digestSize);
+            batch(
+                pointers.data(),
+                lengths.data(),
+                messages.size(),
+                digests.data()
+            );
+            return digests;
+        }
+
+    }
+
+}
+
+#endif /* HASH_MULTI_BUFFER_HPP */
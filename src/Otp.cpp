@@ -0,0 +1,221 @@
+/**
+ * @file Otp.cpp
+ *
+ * This module contains the implementation of the functions which generate
+ * one-time passwords from the HMAC midstates of shared secrets.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Pbkdf2Hmac.hpp"
+#include "Sha1Kernels.hpp"
+#include "Sha2Kernels.hpp"
+
+#include <Hash/HmacContext.hpp>
+#include <Hash/Otp.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This holds the functions which compute HMAC using a particular hash
+     * function, starting from stored midstates.
+     */
+    template<
+        typename Word,
+        size_t stateWords,
+        size_t digestSize,
+        size_t blockSize,
+        size_t lengthFieldSize,
+        void (*compress)(Word*, const uint8_t*, size_t)
+    > struct MidstatesHmac {
+        /**
+         * This is the size of the stored midstates, in bytes.
+         */
+        static constexpr size_t size = 2 * stateWords * sizeof(Word);
+
+        /**
+         * This function computes the midstates of the given HMAC key,
+         * and stores them.
+         *
+         * @param[in] key
+         *     This points to the HMAC key.
+         *
+         * @param[in] keyLength
+         *     This is the length of the key, in bytes.
+         *
+         * @param[in] initialHashValues
+         *     These are the initial hash values of the hash function.
+         *
+         * @param[out] stored
+         *     This is where to store the midstates.
+         */
+        static void Key(
+            const void* key,
+            size_t keyLength,
+            const Word* initialHashValues,
+            uint8_t* stored
+        ) {
+            auto midstates = Hash::Internal::KeyHmac<
+                Word, stateWords, digestSize, blockSize, lengthFieldSize
+            >((const uint8_t*)key, keyLength, initialHashValues, compress);
+            constexpr size_t stateSize = stateWords * sizeof(Word);
+            Hash::Internal::StoreDigest< Word, false >(midstates.inner, 1, stored, stateSize);
+            Hash::Internal::StoreDigest< Word, false >(midstates.outer, 1, stored + stateSize, stateSize);
+            Hash::Internal::Wipe(&midstates, sizeof(midstates));
+        }
+
+        /**
+         * This function computes the HOTP one-time password for the given
+         * counter value, starting from the given stored midstates.
+         *
+         * @param[in] stored
+         *     This points to the stored midstates.
+         *
+         * @param[in] count
+         *     This is the counter value to use to generate the one-time
+         *     password.
+         *
+         * @param[in] modulus
+         *     This is the number by which the truncated HMAC code is
+         *     reduced.
+         *
+         * @return
+         *     The generated one-time password is returned.
+         */
+        static int Hotp(
+            const uint8_t* stored,
+            uint64_t count,
+            uint32_t modulus
+        ) {
+            Word inner[stateWords] = {0};
+            Word outer[stateWords] = {0};
+            for (size_t i = 0; i < stateWords * sizeof(Word); ++i) {
+                const auto shift = (i % sizeof(Word)) * 8;
+                inner[i / sizeof(Word)] |= ((Word)stored[i] << shift);
+                outer[i / sizeof(Word)] |= ((Word)stored[stateWords * sizeof(Word) + i] << shift);
+            }
+            uint8_t countBytes[8];
+            for (size_t i = 0; i < 8; ++i) {
+                countBytes[i] = (uint8_t)(count >> (56 - i * 8));
+            }
+            uint8_t hs[digestSize];
+            Hash::Internal::FinishHash< blockSize, lengthFieldSize >(
+                inner,
+                countBytes,
+                sizeof(countBytes),
+                blockSize,
+                compress
+            );
+            Hash::Internal::StoreDigest< Word, true >(inner, 1, hs, digestSize);
+            Hash::Internal::FinishHash< blockSize, lengthFieldSize >(
+                outer,
+                hs,
+                digestSize,
+                blockSize,
+                compress
+            );
+            Hash::Internal::StoreDigest< Word, true >(outer, 1, hs, digestSize);
+            Hash::Internal::Wipe(inner, sizeof(inner));
+            Hash::Internal::Wipe(outer, sizeof(outer));
+            return Hash::OtpFromHmac(hs, digestSize, modulus);
+        }
+    };
+
+    /**
+     * This computes HMAC-SHA-1 from stored midstates.
+     */
+    using Sha1MidstatesHmac = MidstatesHmac<
+        uint32_t, 5, Hash::SHA1_DIGEST_LENGTH / 8, Hash::SHA1_BLOCK_SIZE, 8,
+        Hash::Internal::Sha1Compress
+    >;
+
+    /**
+     * This computes HMAC-SHA-256 from stored midstates.
+     */
+    using Sha256MidstatesHmac = MidstatesHmac<
+        uint32_t, 8, Hash::SHA256_DIGEST_LENGTH / 8, Hash::SHA256_BLOCK_SIZE, 8,
+        Hash::Internal::Sha256Compress
+    >;
+
+    /**
+     * This computes HMAC-SHA-512 from stored midstates.
+     */
+    using Sha512MidstatesHmac = MidstatesHmac<
+        uint64_t, 8, Hash::SHA512_DIGEST_LENGTH / 8, Hash::SHA512_BLOCK_SIZE, 16,
+        Hash::Internal::Sha512Compress
+    >;
+
+    static_assert(
+        Sha1MidstatesHmac::size == Hash::OtpMidstates< Hash::Sha1Context >::size,
+        "size of HMAC-SHA-1 midstates"
+    );
+    static_assert(
+        Sha256MidstatesHmac::size == Hash::OtpMidstates< Hash::Sha256Context >::size,
+        "size of HMAC-SHA-256 midstates"
+    );
+    static_assert(
+        Sha512MidstatesHmac::size == Hash::OtpMidstates< Hash::Sha512Context >::size,
+        "size of HMAC-SHA-512 midstates"
+    );
+
+}
+
+namespace Hash {
+
+    constexpr size_t OtpMidstates< Sha1Context >::size;
+    constexpr size_t OtpMidstates< Sha256Context >::size;
+    constexpr size_t OtpMidstates< Sha512Context >::size;
+
+    void OtpMidstates< Sha1Context >::Key(
+        const void* secret,
+        size_t secretLength,
+        uint8_t* midstates
+    ) {
+        Sha1MidstatesHmac::Key(secret, secretLength, Internal::Sha1InitialHashValues, midstates);
+    }
+
+    int OtpMidstates< Sha1Context >::Hotp(
+        const uint8_t* midstates,
+        uint64_t count,
+        uint32_t modulus
+    ) {
+        return Sha1MidstatesHmac::Hotp(midstates, count, modulus);
+    }
+
+    void OtpMidstates< Sha256Context >::Key(
+        const void* secret,
+        size_t secretLength,
+        uint8_t* midstates
+    ) {
+        Sha256MidstatesHmac::Key(secret, secretLength, Internal::Sha256InitialHashValues, midstates);
+    }
+
+    int OtpMidstates< Sha256Context >::Hotp(
+        const uint8_t* midstates,
+        uint64_t count,
+        uint32_t modulus
+    ) {
+        return Sha256MidstatesHmac::Hotp(midstates, count, modulus);
+    }
+
+    void OtpMidstates< Sha512Context >::Key(
+        const void* secret,
+        size_t secretLength,
+        uint8_t* midstates
+    ) {
+        Sha512MidstatesHmac::Key(secret, secretLength, Internal::Sha512InitialHashValues, midstates);
+    }
+
+    int OtpMidstates< Sha512Context >::Hotp(
+        const uint8_t* midstates,
+        uint64_t count,
+        uint32_t modulus
+    ) {
+        return Sha512MidstatesHmac::Hotp(midstates, count, modulus);
+    }
+
+}
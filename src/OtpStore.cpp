@@ -0,0 +1,642 @@
+/**
+ * @file OtpStore.cpp
+ *
+ * This module contains the implementation of the Hash::OtpStore class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <Hash/HmacContext.hpp>
+#include <Hash/Otp.hpp>
+#include <Hash/OtpStore.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <string.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <fstream>
+#include <io.h>
+#include <iterator>
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * These are the bytes at the start of every store file.
+     */
+    constexpr uint8_t MAGIC[8] = {'H', 'a', 's', 'h', 'O', 'T', 'P', 'S'};
+
+    /**
+     * This is the version of the store file format written by this module.
+     */
+    constexpr uint32_t VERSION = 1;
+
+    /**
+     * This is the size of the header at the start of every store file.
+     * The records of midstates follow it.
+     *
+     * The header is laid out as follows:
+     * - bytes 0-7: MAGIC
+     * - bytes 8-11: VERSION
+     * - bytes 12-15: the hash function, as an OtpStoreAlgorithm value
+     * - bytes 16-19: the number of digits in each one-time password
+     * - bytes 20-23: the size of each record, in bytes
+     * - bytes 24-31: the number of records
+     * - bytes 32-63: reserved (zero)
+     */
+    constexpr size_t HEADER_SIZE = 64;
+
+    /**
+     * This is the number of records written to a store file at a time.
+     */
+    constexpr size_t RECORDS_PER_WRITE = 1024;
+
+    /**
+     * This function stores the given value in little-endian byte order.
+     *
+     * @param[in] value
+     *     This is the value to store.
+     *
+     * @param[out] bytes
+     *     This is where to store the value.
+     */
+    template< typename Word > void StoreLittleEndian(Word value, uint8_t* bytes) {
+        for (size_t i = 0; i < sizeof(Word); ++i) {
+            bytes[i] = (uint8_t)(value >> (i * 8));
+        }
+    }
+
+    /**
+     * This function loads a value stored in little-endian byte order.
+     *
+     * @param[in] bytes
+     *     This points to the value to load.
+     *
+     * @return
+     *     The loaded value is returned.
+     */
+    template< typename Word > Word LoadLittleEndian(const uint8_t* bytes) {
+        Word value = 0;
+        for (size_t i = 0; i < sizeof(Word); ++i) {
+            value |= ((Word)bytes[i] << (i * 8));
+        }
+        return value;
+    }
+
+    /**
+     * This function returns the size of each record of a store file using
+     * the given hash function.
+     *
+     * @param[in] algorithm
+     *     This is the hash function used with HMAC.
+     *
+     * @return
+     *     The size of each record, in bytes, is returned, or zero if the
+     *     hash function isn't supported.
+     */
+    size_t RecordSize(Hash::OtpStoreAlgorithm algorithm) {
+        switch (algorithm) {
+            case Hash::OtpStoreAlgorithm::Sha1: return Hash::OtpMidstates< Hash::Sha1Context >::size;
+            case Hash::OtpStoreAlgorithm::Sha256: return Hash::OtpMidstates< Hash::Sha256Context >::size;
+            case Hash::OtpStoreAlgorithm::Sha512: return Hash::OtpMidstates< Hash::Sha512Context >::size;
+            default: return 0;
+        }
+    }
+
+
+    /**
+     * This function creates a new, empty file in the same directory as the
+     * given file, so that it can later be renamed over the given file.
+     *
+     * @param[in] path
+     *     This is the path of the file which the new file is to replace.
+     *
+     * @param[out] temporaryPath
+     *     This is where to store the path of the new file.
+     *
+     * @return
+     *     The new file, opened for writing, is returned, or NULL if it
+     *     couldn't be created.
+     */
+    FILE* CreateTemporaryFile(
+        const std::string& path,
+        std::string& temporaryPath
+    ) {
+#ifdef _WIN32
+        temporaryPath = path + ".tmp";
+        return fopen(temporaryPath.c_str(), "wb");
+#else
+        std::vector< char > name(path.begin(), path.end());
+        const char suffix[] = ".XXXXXX";
+        name.insert(name.end(), suffix, suffix + sizeof(suffix));
+        const auto fd = mkstemp(name.data());
+        if (fd < 0) {
+            return NULL;
+        }
+        temporaryPath = name.data();
+
+        // The new file is created readable and writable only by its owner.
+        // If it's replacing a file, it takes on that file's permissions
+        // instead, so that every process which could read the old store
+        // can read the new one.
+        struct stat status;
+        if (stat(path.c_str(), &status) == 0) {
+            (void)fchmod(fd, status.st_mode & 07777);
+        }
+        const auto file = fdopen(fd, "wb");
+        if (file == NULL) {
+            (void)close(fd);
+            (void)remove(temporaryPath.c_str());
+        }
+        return file;
+#endif
+    }
+
+    /**
+     * This function makes sure everything written to the given file is
+     * stored on the device holding it.
+     *
+     * @param[in] file
+     *     This is the file to synchronize.  Everything written to it must
+     *     already have been flushed.
+     *
+     * @return
+     *     An indication of whether or not the file was synchronized
+     *     successfully is returned.
+     */
+    bool SyncFile(FILE* file) {
+#ifdef _WIN32
+        return (_commit(_fileno(file)) == 0);
+#else
+        return (fsync(fileno(file)) == 0);
+#endif
+    }
+
+    /**
+     * This function renames the given new file over the given old file,
+     * replacing it in one step, so that anything opening the old file's
+     * path finds either the whole old file or the whole new one.
+     *
+     * @param[in] newPath
+     *     This is the path of the new file.
+     *
+     * @param[in] oldPath
+     *     This is the path of the file to replace.
+     *
+     * @return
+     *     An indication of whether or not the file was replaced
+     *     successfully is returned.
+     */
+    bool RenameOver(
+        const std::string& newPath,
+        const std::string& oldPath
+    ) {
+#ifdef _WIN32
+        return (
+            MoveFileExA(
+                newPath.c_str(),
+                oldPath.c_str(),
+                MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH
+            ) != 0
+        );
+#else
+        if (rename(newPath.c_str(), oldPath.c_str()) != 0) {
+            return false;
+        }
+
+        // Synchronize the directory too, so that the rename itself is
+        // stored on the device.
+        const auto slash = oldPath.rfind('/');
+        const auto directory = (
+            (slash == std::string::npos)
+            ? std::string(".")
+            : oldPath.substr(0, std::max(slash, (size_t)1))
+        );
+        const auto fd = open(directory.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            (void)fsync(fd);
+            (void)close(fd);
+        }
+        return true;
+#endif
+    }
+}
+
+namespace Hash {
+
+    /**
+     * This contains the private properties of an OtpStore instance.
+     */
+    struct OtpStore::Impl {
+        /**
+         * This points to the contents of the store file.
+         */
+        const uint8_t* data = nullptr;
+
+        /**
+         * This is the size of the store file, in bytes.
+         */
+        size_t length = 0;
+
+#ifdef _WIN32
+        /**
+         * This holds the contents of the store file, which is read rather
+         * than mapped into memory on this platform, because a mapped file
+         * couldn't be replaced by Write while the store is open.
+         */
+        std::vector< uint8_t > contents;
+#endif
+
+        /**
+         * This is the hash function used with HMAC.
+         */
+        OtpStoreAlgorithm algorithm = OtpStoreAlgorithm::Sha1;
+
+        /**
+         * This is the number of digits in each one-time password.
+         */
+        size_t digits = 0;
+
+        /**
+         * This is the number by which the truncated HMAC code is reduced
+         * to produce a one-time password, or zero if it isn't reduced.
+         */
+        uint32_t modulus = 0;
+
+        /**
+         * This is the size of each record, in bytes.
+         */
+        size_t recordSize = 0;
+
+        /**
+         * This is the number of records in the store.
+         */
+        size_t count = 0;
+
+        /**
+         * This is the function which computes HOTP one-time passwords from
+         * a record of midstates.
+         */
+        int (*hotp)(const uint8_t* record, uint64_t count, uint32_t modulus) = nullptr;
+
+        /**
+         * This method releases the contents of the store file, if any.
+         */
+        void Unmap() {
+            if (data == nullptr) {
+                return;
+            }
+#ifdef _WIN32
+            contents.clear();
+            contents.shrink_to_fit();
+#else
+            (void)munmap((void*)data, length);
+#endif
+            data = nullptr;
+            length = 0;
+            count = 0;
+        }
+
+        /**
+         * This method checks the header of the store file, and sets up
+         * the properties it describes.
+         *
+         * @return
+         *     An indication of whether or not the header is valid and the
+         *     file is long enough to hold all its records is returned.
+         */
+        bool ParseHeader() {
+            if (
+                (length < HEADER_SIZE)
+                || (memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+                || (LoadLittleEndian< uint32_t >(data + 8) != VERSION)
+            ) {
+                return false;
+            }
+            algorithm = (OtpStoreAlgorithm)LoadLittleEndian< uint32_t >(data + 12);
+            switch (algorithm) {
+                case OtpStoreAlgorithm::Sha1: hotp = OtpMidstates< Sha1Context >::Hotp; break;
+                case OtpStoreAlgorithm::Sha256: hotp = OtpMidstates< Sha256Context >::Hotp; break;
+                case OtpStoreAlgorithm::Sha512: hotp = OtpMidstates< Sha512Context >::Hotp; break;
+                default: return false;
+            }
+            digits = LoadLittleEndian< uint32_t >(data + 16);
+            modulus = OtpModulus(digits);
+            recordSize = LoadLittleEndian< uint32_t >(data + 20);
+            if (recordSize != RecordSize(algorithm)) {
+                return false;
+            }
+            const auto records = LoadLittleEndian< uint64_t >(data + 24);
+            if (records > (length - HEADER_SIZE) / recordSize) {
+                return false;
+            }
+            count = (size_t)records;
+            return true;
+        }
+
+        /**
+         * This method generates the HOTP one-time password of the given
+         * secret for the given counter value.
+         *
+         * @param[in] index
+         *     This is the index of the secret in the store.
+         *
+         * @param[in] counter
+         *     This is the counter value to use to generate the one-time
+         *     password.
+         *
+         * @return
+         *     The generated one-time password is returned, or -1 if
+         *     there is no secret in the store at the given index.
+         */
+        int Hotp(
+            size_t index,
+            uint64_t counter
+        ) const {
+            if (!Contains(index)) {
+                return -1;
+            }
+            return hotp(data + HEADER_SIZE + index * recordSize, counter, modulus);
+        }
+
+        /**
+         * This method checks to see if the store is open and has a secret
+         * at the given index.
+         *
+         * @param[in] index
+         *     This is the index of the secret to check.
+         *
+         * @return
+         *     An indication of whether or not the store has a secret at
+         *     the given index is returned.
+         */
+        bool Contains(size_t index) const {
+            return (data != nullptr) && (index < count);
+        }
+    };
+
+    OtpStore::~OtpStore() noexcept {
+        Close();
+    }
+    OtpStore::OtpStore(OtpStore&&) noexcept = default;
+    OtpStore& OtpStore::operator=(OtpStore&& other) noexcept {
+        if (this != &other) {
+            Close();
+            impl_ = std::move(other.impl_);
+        }
+        return *this;
+    }
+
+    OtpStore::OtpStore()
+        : impl_(new Impl)
+    {
+    }
+
+    bool OtpStore::Write(
+        const std::string& path,
+        OtpStoreAlgorithm algorithm,
+        size_t digits,
+        const std::vector< std::string >& secrets
+    ) {
+        const auto recordSize = RecordSize(algorithm);
+        if (recordSize == 0) {
+            return false;
+        }
+
+        // The store is written to a new file next to the destination, and
+        // then renamed over it, because processes which have the
+        // destination mapped into memory would crash if it were truncated
+        // and rewritten in place.  They keep using the old file until they
+        // reopen the store.
+        std::string temporaryPath;
+        const auto file = CreateTemporaryFile(path, temporaryPath);
+        if (file == NULL) {
+            return false;
+        }
+        uint8_t header[HEADER_SIZE] = {0};
+        (void)memcpy(header, MAGIC, sizeof(MAGIC));
+        StoreLittleEndian(VERSION, header + 8);
+        StoreLittleEndian((uint32_t)algorithm, header + 12);
+        StoreLittleEndian((uint32_t)digits, header + 16);
+        StoreLittleEndian((uint32_t)recordSize, header + 20);
+        StoreLittleEndian((uint64_t)secrets.size(), header + 24);
+        bool success = (fwrite(header, sizeof(header), 1, file) == 1);
+        std::vector< uint8_t > records(RECORDS_PER_WRITE * recordSize);
+        for (size_t first = 0; success && (first < secrets.size()); first += RECORDS_PER_WRITE) {
+            const auto numRecords = std::min(RECORDS_PER_WRITE, secrets.size() - first);
+            for (size_t i = 0; i < numRecords; ++i) {
+                const auto& secret = secrets[first + i];
+                const auto record = records.data() + i * recordSize;
+                switch (algorithm) {
+                    case OtpStoreAlgorithm::Sha1: {
+                        OtpMidstates< Sha1Context >::Key(
+                            secret.data(),
+                            secret.length(),
+                            record
+                        );
+                    } break;
+
+                    case OtpStoreAlgorithm::Sha256: {
+                        OtpMidstates< Sha256Context >::Key(
+                            secret.data(),
+                            secret.length(),
+                            record
+                        );
+                    } break;
+
+                    case OtpStoreAlgorithm::Sha512: {
+                        OtpMidstates< Sha512Context >::Key(
+                            secret.data(),
+                            secret.length(),
+                            record
+                        );
+                    } break;
+                }
+            }
+            success = (
+                fwrite(records.data(), recordSize, numRecords, file)
+                == numRecords
+            );
+        }
+        Internal::Wipe(records.data(), records.size());
+        success = (
+            success
+            && (fflush(file) == 0)
+            && SyncFile(file)
+        );
+        success = ((fclose(file) == 0) && success);
+        success = (
+            success
+            && RenameOver(temporaryPath, path)
+        );
+        if (!success) {
+            (void)remove(temporaryPath.c_str());
+        }
+        return success;
+    }
+
+    bool OtpStore::Open(const std::string& path) {
+        Close();
+        if (impl_ == nullptr) {
+            impl_.reset(new Impl);
+        }
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        impl_->contents.assign(
+            std::istreambuf_iterator< char >(file),
+            std::istreambuf_iterator< char >()
+        );
+        if (impl_->contents.empty()) {
+            return false;
+        }
+        impl_->data = impl_->contents.data();
+        impl_->length = impl_->contents.size();
+#else
+        const auto fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat status;
+        if (
+            (fstat(fd, &status) != 0)
+            || (status.st_size <= 0)
+        ) {
+            (void)close(fd);
+            return false;
+        }
+        const auto length = (size_t)status.st_size;
+        const auto data = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+        (void)close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        // Each verification touches the record of only one secret, so
+        // reading ahead would only waste memory.
+        (void)madvise(data, length, MADV_RANDOM);
+        impl_->data = (const uint8_t*)data;
+        impl_->length = length;
+#endif
+        if (!impl_->ParseHeader()) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void OtpStore::Close() {
+        if (impl_ != nullptr) {
+            impl_->Unmap();
+        }
+    }
+
+    size_t OtpStore::Size() const {
+        if (impl_ == nullptr) {
+            return 0;
+        }
+        return impl_->count;
+    }
+
+    OtpStoreAlgorithm OtpStore::GetAlgorithm() const {
+        if (impl_ == nullptr) {
+            return OtpStoreAlgorithm::Sha1;
+        }
+        return impl_->algorithm;
+    }
+
+    size_t OtpStore::GetDigits() const {
+        if (impl_ == nullptr) {
+            return 0;
+        }
+        return impl_->digits;
+    }
+
+    int OtpStore::Hotp(
+        size_t index,
+        uint64_t count
+    ) const {
+        if (impl_ == nullptr) {
+            return -1;
+        }
+        return impl_->Hotp(index, count);
+    }
+
+    int OtpStore::Totp(
+        size_t index,
+        uint64_t time,
+        uint64_t base,
+        uint64_t step
+    ) const {
+        if (impl_ == nullptr) {
+            return -1;
+        }
+        return impl_->Hotp(index, (time - base) / step);
+    }
+
+    bool OtpStore::VerifyHotp(
+        size_t index,
+        int password,
+        uint64_t count,
+        size_t lookAhead,
+        uint64_t& nextCount
+    ) const {
+        if (
+            (impl_ == nullptr)
+            || !impl_->Contains(index)
+        ) {
+            return false;
+        }
+        const auto& impl = *impl_;
+        return VerifyHotpWindow(
+            [&impl, index](uint64_t counter) { return impl.Hotp(index, counter); },
+            password,
+            count,
+            lookAhead,
+            nextCount
+        );
+    }
+
+    bool OtpStore::VerifyTotp(
+        size_t index,
+        int password,
+        uint64_t time,
+        uint64_t base,
+        uint64_t step,
+        size_t window,
+        int64_t& drift
+    ) const {
+        if (
+            (impl_ == nullptr)
+            || !impl_->Contains(index)
+        ) {
+            return false;
+        }
+        const auto& impl = *impl_;
+        return VerifyTotpWindow(
+            [&impl, index](uint64_t counter) { return impl.Hotp(index, counter); },
+            password,
+            time,
+            base,
+            step,
+            window,
+            drift
+        );
+    }
+
+}
@@ -7,8 +7,27 @@
  * © 2019 by Richard Walters
  */
 
+#include "CachedHmac.hpp"
+#include "Pbkdf2Hmac.hpp"
+#include "Sha1Kernels.hpp"
+#include "Sha2Kernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <Hash/HmacContext.hpp>
+#include <Hash/Md5.hpp>
 #include <Hash/Pbkdf2.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <memory>
+#include <mutex>
 #include <stdint.h>
+#include <string.h>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -56,8 +75,7 @@ namespace {
         std::vector< uint8_t > dk = prf(password, saltWithIndex);
         std::vector< uint8_t > u(dk);
         for (size_t j = 1; j < c; ++j) {
-            std::vector< uint8_t > uPrevious(u);
-            u = prf(password, uPrevious);
+            u = prf(password, u);
             for (size_t k = 0; k < dk.size(); ++k) {
                 dk[k] ^= u[k];
             }
@@ -65,6 +83,721 @@ namespace {
         return dk;
     }
 
+    /**
+     * This function measures how long PBKDF2 iterations take on the current
+     * machine, by timing the given derivation of one block of a derived key
+     * with increasing iteration counts, and determines how many iterations
+     * fit within the given latency budget.
+     *
+     * @param[in] derive
+     *     This is the function to call to derive one block of a key using
+     *     the given number of iterations.
+     *
+     * @param[in] budget
+     *     This is the time allowed for computing one block of a derived
+     *     key.
+     *
+     * @return
+     *     The iteration count which fits the budget, along with the
+     *     measured time per iteration, is returned.
+     */
+    Hash::Pbkdf2Calibration Calibrate(
+        const std::function< void(size_t c) >& derive,
+        std::chrono::nanoseconds budget
+    ) {
+        // Time a few derivations, each long enough that the overhead of
+        // setting up the derivation and reading the clock is negligible,
+        // but short enough that the whole calibration stays within a small
+        // multiple of the budget.
+        const std::chrono::nanoseconds minimumSampleTime(1000000);
+        const auto sampleTime = std::min(
+            std::max(budget / 8, minimumSampleTime),
+            std::chrono::nanoseconds(20000000)
+        );
+        const auto time = [&](size_t c) {
+            const auto start = std::chrono::steady_clock::now();
+            derive(c);
+            return std::chrono::duration_cast< std::chrono::nanoseconds >(
+                std::chrono::steady_clock::now() - start
+            );
+        };
+        size_t c = 1;
+        auto elapsed = time(c);
+        while (elapsed < sampleTime) {
+            c *= 2;
+            elapsed = time(c);
+        }
+        for (size_t i = 1; i < 3; ++i) {
+            elapsed = std::min(elapsed, time(c));
+        }
+        Hash::Pbkdf2Calibration calibration;
+        calibration.nanosecondsPerIteration = (
+            (double)elapsed.count() / (double)c
+        );
+        const auto fit = (
+            (double)budget.count() / calibration.nanosecondsPerIteration
+        );
+        calibration.c = ((fit < 1.0) ? 1 : (size_t)fit);
+        return calibration;
+    }
+
+    /**
+     * This is the largest number of lanes of any multi-buffer compression
+     * kernel used to compute blocks of a derived key at once.
+     */
+    constexpr size_t MAX_LANES = 8;
+
+    /**
+     * This identifies a multi-buffer compression kernel which may be used
+     * to compute several blocks of a derived key at once.
+     */
+    template< typename Word > struct Lanes {
+        /**
+         * This is the multi-buffer compression kernel, if any.
+         */
+        Hash::Internal::LanesKernel< Word > kernel;
+
+        /**
+         * This is the number of lanes of the kernel, or 1 if there
+         * is no kernel.
+         */
+        size_t lanes;
+    };
+
+    /**
+     * This function selects the multi-buffer compression kernel to use to
+     * compute several blocks of a PBKDF2-HMAC-SHA-256 derived key at once.
+     * As with Sha256Batch, the lanes are only used if the CPU doesn't have
+     * the SHA extensions, which compress one block faster than the lanes
+     * compress several.
+     *
+     * @return
+     *     The selected kernel is returned.
+     */
+    Lanes< uint32_t > SelectSha256Lanes() {
+#if HASH_TARGET_X86
+        const auto& features = Hash::Internal::GetCpuFeatures();
+        if (
+            features.avx2
+            && !features.sha
+        ) {
+            return {Hash::Internal::Sha256CompressAvx2x8, 8};
+        }
+#endif
+        return {nullptr, 1};
+    }
+
+    /**
+     * This function selects the multi-buffer compression kernel to use to
+     * compute several blocks of a PBKDF2-HMAC-SHA-512 derived key at once.
+     *
+     * @return
+     *     The selected kernel is returned.
+     */
+    Lanes< uint64_t > SelectSha512Lanes() {
+#if HASH_TARGET_X86
+        const auto& features = Hash::Internal::GetCpuFeatures();
+        if (features.avx512) {
+            return {Hash::Internal::Sha512CompressAvx512x8, 8};
+        }
+        if (features.avx2) {
+            return {Hash::Internal::Sha512CompressAvx2x4, 4};
+        }
+#endif
+        return {nullptr, 1};
+    }
+
+    /**
+     * This function computes the given number of blocks of a derived key,
+     * either one after another or using the given executor.
+     *
+     * @param[in] l
+     *     This is the number of blocks to compute.
+     *
+     * @param[in] computeBlock
+     *     This is the function to call to compute each block, given the
+     *     zero-based index of the block.
+     *
+     * @param[in] executor
+     *     If not empty, this is used to compute the blocks concurrently.
+     */
+    void RunBlocks(
+        size_t l,
+        const std::function< void(size_t index) >& computeBlock,
+        const Hash::Pbkdf2Executor& executor
+    ) {
+        if (
+            (l > 1)
+            && executor
+        ) {
+            executor(l, computeBlock);
+        } else {
+            for (size_t index = 0; index < l; ++index) {
+                computeBlock(index);
+            }
+        }
+    }
+
+    /**
+     * This holds the state of one call to Pbkdf2ThreadExecutor, shared by
+     * the calling thread and the pool threads which help it.
+     */
+    struct ExecutorJob {
+        /**
+         * This is the number of tasks to run.
+         */
+        size_t count = 0;
+
+        /**
+         * This is the function to call with the index of each task.  It's
+         * only called while some task is still unclaimed, so it's never
+         * used after the calling thread returns.
+         */
+        const std::function< void(size_t index) >* task = nullptr;
+
+        /**
+         * This is the index of the next task to claim.
+         */
+        std::atomic< size_t > next{0};
+
+        /**
+         * This is the number of tasks which have finished.
+         */
+        std::atomic< size_t > done{0};
+
+        /**
+         * This is set once any task has thrown an exception, so that the
+         * tasks not yet started are skipped.
+         */
+        std::atomic< bool > failed{false};
+
+        /**
+         * This is the first exception thrown by any task.
+         */
+        std::exception_ptr error;
+
+        /**
+         * This is used to synchronize access to the error, and to wait
+         * for the tasks to finish.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is notified when the last task finishes.
+         */
+        std::condition_variable finished;
+
+        /**
+         * This method claims and runs tasks until none are left to claim.
+         * Any exception thrown by a task is kept, rather than thrown, so
+         * that it may be rethrown on the calling thread.
+         */
+        void Work() {
+            for (size_t index = next++; index < count; index = next++) {
+                if (!failed) {
+                    try {
+                        (*task)(index);
+                    } catch (...) {
+                        std::lock_guard< std::mutex > lock(mutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                        failed = true;
+                    }
+                }
+                if (++done == count) {
+                    std::lock_guard< std::mutex > lock(mutex);
+                    finished.notify_all();
+                }
+            }
+        }
+    };
+
+    /**
+     * This is the pool of threads used by Pbkdf2ThreadExecutor, which are
+     * started once and then kept waiting for work, so that each
+     * derivation doesn't pay to start and join its own threads.
+     */
+    class ExecutorPool {
+    public:
+        /**
+         * This constructor starts the given number of pool threads.
+         *
+         * @param[in] numThreads
+         *     This is the number of threads to start.
+         */
+        explicit ExecutorPool(size_t numThreads) {
+            for (size_t i = 0; i < numThreads; ++i) {
+                threads_.emplace_back([this]{ Serve(); });
+            }
+        }
+
+        ~ExecutorPool() noexcept {
+            {
+                std::lock_guard< std::mutex > lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto& thread: threads_) {
+                thread.join();
+            }
+        }
+
+        /**
+         * This method runs the given tasks on the calling thread and on
+         * as many pool threads as are free to help, returning once every
+         * task has finished.  Since the calling thread keeps claiming
+         * tasks itself, the tasks are finished even if every pool thread
+         * is busy, including with tasks which themselves call this method.
+         *
+         * @param[in] count
+         *     This is the number of tasks to run.
+         *
+         * @param[in] task
+         *     This is the function to call with the index of each task.
+         *
+         * @throw
+         *     The first exception thrown by any task is rethrown, after
+         *     every task has finished or been skipped.
+         */
+        void Run(
+            size_t count,
+            const std::function< void(size_t index) >& task
+        ) {
+            const auto job = std::make_shared< ExecutorJob >();
+            job->count = count;
+            job->task = &task;
+            const auto numHelpers = std::min(count - 1, threads_.size());
+            if (numHelpers > 0) {
+                {
+                    std::lock_guard< std::mutex > lock(mutex_);
+                    for (size_t i = 0; i < numHelpers; ++i) {
+                        jobs_.push_back(job);
+                    }
+                }
+                wake_.notify_all();
+            }
+            job->Work();
+            std::unique_lock< std::mutex > lock(job->mutex);
+            job->finished.wait(lock, [&]{ return job->done == count; });
+            if (job->error) {
+                std::rethrow_exception(job->error);
+            }
+        }
+
+    private:
+        /**
+         * This method is run by each pool thread, helping with jobs until
+         * the pool is destroyed.
+         */
+        void Serve() {
+            for (;;) {
+                std::shared_ptr< ExecutorJob > job;
+                {
+                    std::unique_lock< std::mutex > lock(mutex_);
+                    wake_.wait(lock, [this]{ return stop_ || !jobs_.empty(); });
+                    if (stop_) {
+                        return;
+                    }
+                    job = std::move(jobs_.front());
+                    jobs_.pop_front();
+                }
+                job->Work();
+            }
+        }
+
+        /**
+         * These are the pool threads.
+         */
+        std::vector< std::thread > threads_;
+
+        /**
+         * This is used to synchronize access to the queue of jobs.
+         */
+        std::mutex mutex_;
+
+        /**
+         * This is notified when jobs are queued or the pool is stopping.
+         */
+        std::condition_variable wake_;
+
+        /**
+         * These are the jobs with which pool threads may help, one entry
+         * for each helper wanted.
+         */
+        std::deque< std::shared_ptr< ExecutorJob > > jobs_;
+
+        /**
+         * This is set when the pool is being destroyed.
+         */
+        bool stop_ = false;
+    };
+
+    /**
+     * This function returns the pool of threads used by
+     * Pbkdf2ThreadExecutor, starting it the first time it's called, with
+     * one thread fewer than the number of hardware threads, since the
+     * calling thread also runs tasks.
+     *
+     * @return
+     *     The pool of threads used by Pbkdf2ThreadExecutor is returned.
+     */
+    ExecutorPool& GetExecutorPool() {
+        static ExecutorPool pool(
+            std::max((size_t)std::thread::hardware_concurrency(), (size_t)1) - 1
+        );
+        return pool;
+    }
+
+    /**
+     * This function determines how many blocks of a derived key to compute
+     * in each task given to the executor.  The blocks are split among as
+     * many tasks as the executor can run at once, and the blocks of each
+     * task share the lanes of the multi-buffer compression kernel, if
+     * there is one.  Without an executor, the tasks run one after another,
+     * so the lanes are filled as far as possible.
+     *
+     * The width of Pbkdf2ThreadExecutor is the number of hardware threads.
+     * Other executors are assumed to be able to run every task at once.
+     *
+     * @param[in] l
+     *     This is the number of blocks to compute.
+     *
+     * @param[in] lanes
+     *     This is the number of lanes of the multi-buffer compression
+     *     kernel, or 1 if there is no kernel.
+     *
+     * @param[in] executor
+     *     If not empty, this is used to compute the blocks concurrently.
+     *
+     * @return
+     *     The number of blocks to compute in each task is returned.
+     */
+    size_t GroupSize(
+        size_t l,
+        size_t lanes,
+        const Hash::Pbkdf2Executor& executor
+    ) {
+        size_t width = 1;
+        if (executor) {
+            typedef void(*ExecutorFunction)(size_t, std::function< void(size_t) >);
+            const auto function = executor.target< ExecutorFunction >();
+            if (
+                (function != nullptr)
+                && (*function == Hash::Pbkdf2ThreadExecutor)
+            ) {
+                width = std::max((size_t)std::thread::hardware_concurrency(), (size_t)1);
+            } else {
+                width = l;
+            }
+        }
+        const auto numGroups = std::max(
+            std::max(
+                std::min(l, width),
+                (l + lanes - 1) / lanes
+            ),
+            (size_t)1
+        );
+        return std::max((l + numGroups - 1) / numGroups, (size_t)1);
+    }
+
+    /**
+     * This function computes the given chains of PBKDF2 iterations, using
+     * HMAC as the pseudorandom function, in the lanes of the given
+     * multi-buffer compression kernel if there is one and more than one
+     * chain, or otherwise one after another.
+     *
+     * @param[in] chains
+     *     These are the chains to compute.
+     *
+     * @param[in] numChains
+     *     This is the number of chains to compute.
+     *
+     * @param[in] compress
+     *     This is the single-buffer compression kernel to use.
+     *
+     * @param[in] lanes
+     *     This is the multi-buffer compression kernel to use, if any.
+     */
+    template<
+        typename Word,
+        size_t stateWords,
+        size_t digestSize,
+        size_t blockSize,
+        size_t lengthFieldSize,
+        typename Compress
+    > void RunChains(
+        const Hash::Internal::Pbkdf2Chain< Word, stateWords >* chains,
+        size_t numChains,
+        Compress compress,
+        const Lanes< Word >& lanes
+    ) {
+        if (
+            (lanes.lanes > 1)
+            && (numChains > 1)
+        ) {
+            Hash::Internal::Pbkdf2HmacChainsInLanes< Word, stateWords, digestSize, blockSize, lengthFieldSize, MAX_LANES >(
+                chains,
+                numChains,
+                compress,
+                lanes.kernel,
+                lanes.lanes
+            );
+        } else {
+            for (size_t i = 0; i < numChains; ++i) {
+                Hash::Internal::Pbkdf2HmacBlock< Word, stateWords, digestSize, blockSize, lengthFieldSize >(
+                    chains[i],
+                    compress
+                );
+            }
+        }
+    }
+
+    /**
+     * This function is an implementation of PBKDF2 using HMAC with the
+     * given hash function as the pseudorandom function.  The padded password
+     * is compressed only once, and each iteration is exactly two
+     * compressions, with no memory allocation.
+     *
+     * @param[in] password
+     *     This points to the master password from which a derived key
+     *     is generated.
+     *
+     * @param[in] passwordLength
+     *     This is the length of the password, in bytes.
+     *
+     * @param[in] salt
+     *     This points to the cryptographic salt.
+     *
+     * @param[in] saltLength
+     *     This is the length of the salt, in bytes.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[out] dk
+     *     This is where to store the derived key.
+     *
+     * @param[in] dkLen
+     *     This is the desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     If not empty, this is used to compute the blocks of the derived
+     *     key concurrently.
+     *
+     * @param[in] initialHashValues
+     *     These are the initial hash values of the hash function.
+     *
+     * @param[in] compress
+     *     This is the single-buffer compression kernel to use.
+     *
+     * @param[in] lanes
+     *     This is the multi-buffer compression kernel to use to compute
+     *     several blocks of the derived key at once, if any.
+     */
+    template<
+        typename Word,
+        size_t stateWords,
+        size_t digestSize,
+        size_t blockSize,
+        size_t lengthFieldSize,
+        typename Compress
+    > void Pbkdf2Hmac(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        const Hash::Pbkdf2Executor& executor,
+        const Word* initialHashValues,
+        Compress compress,
+        const Lanes< Word >& lanes
+    ) {
+        auto midstates = Hash::Internal::KeyHmac< Word, stateWords, digestSize, blockSize, lengthFieldSize >(
+            (const uint8_t*)password,
+            passwordLength,
+            initialHashValues,
+            compress
+        );
+        const size_t l = (dkLen + digestSize - 1) / digestSize;
+        const auto groupSize = GroupSize(l, lanes.lanes, executor);
+        const auto computeGroup = [&](size_t group) {
+            const auto firstIndex = group * groupSize;
+            const auto numBlocks = std::min(groupSize, l - firstIndex);
+            Hash::Internal::Pbkdf2Chain< Word, stateWords > chains[MAX_LANES];
+            for (size_t j = 0; j < numBlocks; ++j) {
+                const auto offset = (firstIndex + j) * digestSize;
+                chains[j] = {
+                    &midstates,
+                    (const uint8_t*)salt,
+                    saltLength,
+                    firstIndex + j + 1,
+                    c,
+                    dk + offset,
+                    std::min(dkLen - offset, digestSize)
+                };
+            }
+            RunChains< Word, stateWords, digestSize, blockSize, lengthFieldSize >(
+                chains,
+                numBlocks,
+                compress,
+                lanes
+            );
+        };
+        RunBlocks((l + groupSize - 1) / groupSize, computeGroup, executor);
+        Hash::Internal::Wipe(&midstates, sizeof(midstates));
+    }
+
+    /**
+     * This function is an implementation of PBKDF2 using HMAC with the
+     * given hash function as the pseudorandom function, for many
+     * independent derivations at once.  If there is a multi-buffer
+     * compression kernel, the blocks of all the derived keys share its
+     * lanes.
+     *
+     * @param[in] jobs
+     *     These are the derivations to compute.
+     *
+     * @param[in] numJobs
+     *     This is the number of derivations to compute.
+     *
+     * @param[in] initialHashValues
+     *     These are the initial hash values of the hash function.
+     *
+     * @param[in] compress
+     *     This is the single-buffer compression kernel to use.
+     *
+     * @param[in] lanes
+     *     This is the multi-buffer compression kernel to use, if any.
+     */
+    template<
+        typename Word,
+        size_t stateWords,
+        size_t digestSize,
+        size_t blockSize,
+        size_t lengthFieldSize,
+        typename Compress
+    > void Pbkdf2HmacBatch(
+        const Hash::Pbkdf2Job* jobs,
+        size_t numJobs,
+        const Word* initialHashValues,
+        Compress compress,
+        const Lanes< Word >& lanes
+    ) {
+        std::vector< Hash::Internal::HmacMidstates< Word, stateWords > > midstates(numJobs);
+        std::vector< Hash::Internal::Pbkdf2Chain< Word, stateWords > > chains;
+        for (size_t i = 0; i < numJobs; ++i) {
+            const auto& job = jobs[i];
+            midstates[i] = Hash::Internal::KeyHmac< Word, stateWords, digestSize, blockSize, lengthFieldSize >(
+                (const uint8_t*)job.password,
+                job.passwordLength,
+                initialHashValues,
+                compress
+            );
+            for (size_t offset = 0; offset < job.dkLen; offset += digestSize) {
+                chains.push_back({
+                    &midstates[i],
+                    (const uint8_t*)job.salt,
+                    job.saltLength,
+                    offset / digestSize + 1,
+                    job.c,
+                    job.dk + offset,
+                    std::min(job.dkLen - offset, digestSize)
+                });
+            }
+        }
+        RunChains< Word, stateWords, digestSize, blockSize, lengthFieldSize >(
+            chains.data(),
+            chains.size(),
+            compress,
+            lanes
+        );
+        Hash::Internal::Wipe(midstates.data(), midstates.size() * sizeof(midstates[0]));
+    }
+
+    /**
+     * This function computes PBKDF2 directly with the hash function,
+     * if the given pseudorandom function was made by
+     * Hash::MakeHmacBytesToBytesFunction from one of the hash functions
+     * of this library.  This gives the same result as calling the
+     * pseudorandom function for every iteration, but the password is
+     * prepared only once.
+     *
+     * @param[in] prf
+     *     This is the pseudorandom function given to Pbkdf2.
+     *
+     * @param[in] hLen
+     *     This is the length of the output of the pseudorandom function,
+     *     in bits.
+     *
+     * @param[in] password
+     *     This is the master password from which a derived key is
+     *     generated.
+     *
+     * @param[in] salt
+     *     This is the cryptographic salt.
+     *
+     * @param[in] c
+     *     This is the number of iterations desired.
+     *
+     * @param[out] dk
+     *     This is where to store the derived key.  Its size is the
+     *     desired byte-length of the derived key.
+     *
+     * @param[in] executor
+     *     If not empty, this is used to compute the blocks of the derived
+     *     key concurrently.
+     *
+     * @return
+     *     An indication of whether or not the pseudorandom function was
+     *     recognized and the derived key computed is returned.
+     */
+    bool Pbkdf2WithLibraryHmac(
+        const std::function<
+            std::vector< uint8_t >(
+                const std::vector< uint8_t >&,
+                const std::vector< uint8_t >&
+            )
+        >& prf,
+        size_t hLen,
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        std::vector< uint8_t >& dk,
+        const Hash::Pbkdf2Executor& executor
+    ) {
+        const auto libraryHmac = prf.target< Hash::Internal::LibraryHmac >();
+        if (
+            (libraryHmac == nullptr)
+            || (hLen != libraryHmac->codeSize * 8)
+        ) {
+            return false;
+        }
+        const auto compute = libraryHmac->compute;
+        if (compute == Hash::Internal::CachedHmac< Hash::Sha1Context >) {
+            Hash::Pbkdf2HmacSha1(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else if (compute == Hash::Internal::CachedHmac< Hash::Sha256Context >) {
+            Hash::Pbkdf2HmacSha256(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else if (compute == Hash::Internal::CachedHmac< Hash::Sha512Context >) {
+            Hash::Pbkdf2HmacSha512(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else if (compute == Hash::Internal::CachedHmac< Hash::Md5Context >) {
+            Hash::Pbkdf2Hmac< Hash::Md5Context >(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else if (compute == Hash::Internal::CachedHmac< Hash::Sha224Context >) {
+            Hash::Pbkdf2Hmac< Hash::Sha224Context >(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else if (compute == Hash::Internal::CachedHmac< Hash::Sha384Context >) {
+            Hash::Pbkdf2Hmac< Hash::Sha384Context >(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else if (compute == Hash::Internal::CachedHmac< Hash::Sha512t224Context >) {
+            Hash::Pbkdf2Hmac< Hash::Sha512t224Context >(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else if (compute == Hash::Internal::CachedHmac< Hash::Sha512t256Context >) {
+            Hash::Pbkdf2Hmac< Hash::Sha512t256Context >(password.data(), password.size(), salt.data(), salt.size(), c, dk.data(), dk.size(), executor);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
 }
 
 namespace Hash {
@@ -82,27 +815,308 @@ namespace Hash {
         size_t c,
         size_t dkLen
     ) {
-        std::vector< uint8_t > hash;
-        hash.reserve(dkLen);
+        return Pbkdf2Parallel(prf, hLen, password, salt, c, dkLen, nullptr);
+    }
+
+    std::vector< uint8_t > Pbkdf2Parallel(
+        std::function<
+            std::vector< uint8_t >(
+                const std::vector< uint8_t >&,
+                const std::vector< uint8_t >&
+            )
+        > prf,
+        size_t hLen,
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        std::vector< uint8_t > hash(dkLen);
+        if (Pbkdf2WithLibraryHmac(prf, hLen, password, salt, c, hash, executor)) {
+            return hash;
+        }
         const size_t l = (dkLen * 8 + hLen - 1) / hLen;
-        for (size_t i = 0; i < l - 1; ++i) {
-            const auto T = F(prf, password, salt, c, i + 1);
-            hash.insert(
-                hash.end(),
-                T.begin(),
-                T.end()
-            );
+        RunBlocks(
+            l,
+            [&](size_t index) {
+                const auto T = F(prf, password, salt, c, index + 1);
+                const auto offset = index * (hLen / 8);
+                std::copy(
+                    T.begin(),
+                    T.begin() + std::min(dkLen - offset, T.size()),
+                    hash.begin() + offset
+                );
+            },
+            executor
+        );
+        return hash;
+    }
+
+    void Pbkdf2ThreadExecutor(
+        size_t count,
+        std::function< void(size_t index) > task
+    ) {
+        if (count == 0) {
+            return;
         }
-        const auto leftOvers = dkLen * 8 - (l - 1) * hLen;
-        if (leftOvers > 0) {
-            const auto T = F(prf, password, salt, c, l);
-            hash.insert(
-                hash.end(),
-                T.begin(),
-                T.begin() + (leftOvers / 8)
+        GetExecutorPool().Run(count, task);
+    }
+
+    template< typename HashContext > void Pbkdf2HmacBatch(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    ) {
+        for (size_t i = 0; i < numJobs; ++i) {
+            const auto& job = jobs[i];
+            Pbkdf2Hmac< HashContext >(
+                job.password,
+                job.passwordLength,
+                job.salt,
+                job.saltLength,
+                job.c,
+                job.dk,
+                job.dkLen
             );
         }
-        return hash;
     }
 
+    template void Pbkdf2HmacBatch< Md5Context >(const Pbkdf2Job*, size_t);
+    template void Pbkdf2HmacBatch< Sha224Context >(const Pbkdf2Job*, size_t);
+    template void Pbkdf2HmacBatch< Sha384Context >(const Pbkdf2Job*, size_t);
+    template void Pbkdf2HmacBatch< Sha512t224Context >(const Pbkdf2Job*, size_t);
+    template void Pbkdf2HmacBatch< Sha512t256Context >(const Pbkdf2Job*, size_t);
+
+    void Pbkdf2HmacSha1(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        Pbkdf2Hmac< uint32_t, 5, SHA1_DIGEST_LENGTH / 8, SHA1_BLOCK_SIZE, 8 >(
+            password,
+            passwordLength,
+            salt,
+            saltLength,
+            c,
+            dk,
+            dkLen,
+            executor,
+            Internal::Sha1InitialHashValues,
+            Internal::Sha1Compress,
+            Lanes< uint32_t >{nullptr, 1}
+        );
+    }
+
+    std::vector< uint8_t > Pbkdf2HmacSha1(
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        std::vector< uint8_t > dk(dkLen);
+        Pbkdf2HmacSha1(
+            password.data(),
+            password.size(),
+            salt.data(),
+            salt.size(),
+            c,
+            dk.data(),
+            dkLen,
+            executor
+        );
+        return dk;
+    }
+
+    template<> void Pbkdf2HmacBatch< Sha1Context >(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    ) {
+        Pbkdf2HmacBatch< uint32_t, 5, SHA1_DIGEST_LENGTH / 8, SHA1_BLOCK_SIZE, 8 >(
+            jobs,
+            numJobs,
+            Internal::Sha1InitialHashValues,
+            Internal::Sha1Compress,
+            Lanes< uint32_t >{nullptr, 1}
+        );
+    }
+
+    void Pbkdf2HmacSha256(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        static const auto lanes = SelectSha256Lanes();
+        Pbkdf2Hmac< uint32_t, 8, SHA256_DIGEST_LENGTH / 8, SHA256_BLOCK_SIZE, 8 >(
+            password,
+            passwordLength,
+            salt,
+            saltLength,
+            c,
+            dk,
+            dkLen,
+            executor,
+            Internal::Sha256InitialHashValues,
+            Internal::Sha256Compress,
+            lanes
+        );
+    }
+
+    std::vector< uint8_t > Pbkdf2HmacSha256(
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        std::vector< uint8_t > dk(dkLen);
+        Pbkdf2HmacSha256(
+            password.data(),
+            password.size(),
+            salt.data(),
+            salt.size(),
+            c,
+            dk.data(),
+            dkLen,
+            executor
+        );
+        return dk;
+    }
+
+    template<> void Pbkdf2HmacBatch< Sha256Context >(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    ) {
+        static const auto lanes = SelectSha256Lanes();
+        Pbkdf2HmacBatch< uint32_t, 8, SHA256_DIGEST_LENGTH / 8, SHA256_BLOCK_SIZE, 8 >(
+            jobs,
+            numJobs,
+            Internal::Sha256InitialHashValues,
+            Internal::Sha256Compress,
+            lanes
+        );
+    }
+
+    void Pbkdf2HmacSha512(
+        const void* password,
+        size_t passwordLength,
+        const void* salt,
+        size_t saltLength,
+        size_t c,
+        uint8_t* dk,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        static const auto lanes = SelectSha512Lanes();
+        Pbkdf2Hmac< uint64_t, 8, SHA512_DIGEST_LENGTH / 8, SHA512_BLOCK_SIZE, 16 >(
+            password,
+            passwordLength,
+            salt,
+            saltLength,
+            c,
+            dk,
+            dkLen,
+            executor,
+            Internal::Sha512InitialHashValues,
+            Internal::Sha512Compress,
+            lanes
+        );
+    }
+
+    std::vector< uint8_t > Pbkdf2HmacSha512(
+        const std::vector< uint8_t >& password,
+        const std::vector< uint8_t >& salt,
+        size_t c,
+        size_t dkLen,
+        Pbkdf2Executor executor
+    ) {
+        std::vector< uint8_t > dk(dkLen);
+        Pbkdf2HmacSha512(
+            password.data(),
+            password.size(),
+            salt.data(),
+            salt.size(),
+            c,
+            dk.data(),
+            dkLen,
+            executor
+        );
+        return dk;
+    }
+
+    template<> void Pbkdf2HmacBatch< Sha512Context >(
+        const Pbkdf2Job* jobs,
+        size_t numJobs
+    ) {
+        static const auto lanes = SelectSha512Lanes();
+        Pbkdf2HmacBatch< uint64_t, 8, SHA512_DIGEST_LENGTH / 8, SHA512_BLOCK_SIZE, 16 >(
+            jobs,
+            numJobs,
+            Internal::Sha512InitialHashValues,
+            Internal::Sha512Compress,
+            lanes
+        );
+    }
+
+    Pbkdf2Calibration Pbkdf2Calibrate(
+        std::function<
+            std::vector< uint8_t >(
+                const std::vector< uint8_t >&,
+                const std::vector< uint8_t >&
+            )
+        > prf,
+        size_t hLen,
+        std::chrono::nanoseconds budget
+    ) {
+        const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+        const std::vector< uint8_t > salt(16, 0);
+        return Calibrate(
+            [&](size_t c) {
+                (void)Pbkdf2(prf, hLen, password, salt, c, hLen / 8);
+            },
+            budget
+        );
+    }
+
+    template< typename HashContext > Pbkdf2Calibration Pbkdf2HmacCalibrate(
+        std::chrono::nanoseconds budget
+    ) {
+        const uint8_t password[] = {'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+        const uint8_t salt[16] = {0};
+        uint8_t dk[HmacContext< HashContext >::codeSize];
+        return Calibrate(
+            [&](size_t c) {
+                Pbkdf2Hmac< HashContext >(
+                    password,
+                    sizeof(password),
+                    salt,
+                    sizeof(salt),
+                    c,
+                    dk,
+                    sizeof(dk)
+                );
+            },
+            budget
+        );
+    }
+
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Md5Context >(std::chrono::nanoseconds);
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Sha1Context >(std::chrono::nanoseconds);
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Sha224Context >(std::chrono::nanoseconds);
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Sha256Context >(std::chrono::nanoseconds);
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Sha384Context >(std::chrono::nanoseconds);
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Sha512Context >(std::chrono::nanoseconds);
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Sha512t224Context >(std::chrono::nanoseconds);
+    template Pbkdf2Calibration Pbkdf2HmacCalibrate< Sha512t256Context >(std::chrono::nanoseconds);
+
 }
@@ -0,0 +1,502 @@
+#ifndef HASH_PBKDF2_HMAC_HPP
+#define HASH_PBKDF2_HMAC_HPP
+
+/**
+ * @file Pbkdf2Hmac.hpp
+ *
+ * This module declares the function templates used to compute PBKDF2 with
+ * HMAC directly on the hash values of a hash function, rather than through
+ * a general pseudorandom function.  The padded password blocks are
+ * compressed only once, and each iteration is then exactly two compressions
+ * of a single block, with no memory allocation.  Every buffer holding the
+ * password or a value derived from it is wiped before it goes out of scope;
+ * callers of KeyHmac wipe the midstates it returns once they're done.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "BlockBuffer.hpp"
+#include "MultiBuffer.hpp"
+
+#include <Hash/HmacContext.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This holds the hash values of an HMAC computation after the
+         * padded inner and outer keys have been compressed.
+         */
+        template< typename Word, size_t stateWords > struct HmacMidstates {
+            /**
+             * These are the hash values after compressing the inner
+             * padded key.
+             */
+            Word inner[stateWords];
+
+            /**
+             * These are the hash values after compressing the outer
+             * padded key.
+             */
+            Word outer[stateWords];
+        };
+
+        /**
+         * This function completes a hash computation by compressing the
+         * given data into the given hash values, followed by the padding
+         * and message length.
+         *
+         * @param[in,out] state
+         *     These are the hash values to update.
+         *
+         * @param[in] data
+         *     This points to the rest of the message.
+         *
+         * @param[in] length
+         *     This is the number of bytes in the rest of the message.
+         *
+         * @param[in] prefixLength
+         *     This is the number of bytes of the message already compressed
+         *     into the hash values, which must be a whole number of blocks.
+         *
+         * @param[in] compress
+         *     This is the single-buffer compression kernel to use.
+         */
+        template<
+            size_t blockSize,
+            size_t lengthFieldSize,
+            typename Word,
+            typename Compress
+        > void FinishHash(
+            Word* state,
+            const uint8_t* data,
+            size_t length,
+            size_t prefixLength,
+            Compress compress
+        ) {
+            const auto wholeBlocks = length / blockSize;
+            if (wholeBlocks > 0) {
+                compress(state, data, wholeBlocks);
+            }
+            uint8_t finalBlocks[blockSize * 2];
+            const auto numFinalBlocks = PadFinalBlocks< blockSize, lengthFieldSize, true >(
+                finalBlocks,
+                data + wholeBlocks * blockSize,
+                length % blockSize,
+                prefixLength + length
+            );
+            compress(state, finalBlocks, numFinalBlocks);
+            Wipe(finalBlocks, sizeof(finalBlocks));
+        }
+
+        /**
+         * This function compresses the inner and outer padded forms of the
+         * given HMAC key.
+         *
+         * @param[in] key
+         *     This points to the HMAC key.
+         *
+         * @param[in] keyLength
+         *     This is the length of the key, in bytes.
+         *
+         * @param[in] initialHashValues
+         *     These are the initial hash values of the hash function.
+         *
+         * @param[in] compress
+         *     This is the single-buffer compression kernel to use.
+         *
+         * @return
+         *     The hash values after compressing the padded keys are returned.
+         *     The caller should wipe them with Wipe once it's done with them.
+         */
+        template<
+            typename Word,
+            size_t stateWords,
+            size_t digestSize,
+            size_t blockSize,
+            size_t lengthFieldSize,
+            typename Compress
+        > HmacMidstates< Word, stateWords > KeyHmac(
+            const uint8_t* key,
+            size_t keyLength,
+            const Word* initialHashValues,
+            Compress compress
+        ) {
+            uint8_t keyBlock[blockSize] = {0};
+            if (keyLength > blockSize) {
+                Word state[stateWords];
+                (void)memcpy(state, initialHashValues, sizeof(state));
+                FinishHash< blockSize, lengthFieldSize >(state, key, keyLength, 0, compress);
+                StoreDigest< Word, true >(state, 1, keyBlock, digestSize);
+                Wipe(state, sizeof(state));
+            } else if (keyLength > 0) {
+                (void)memcpy(keyBlock, key, keyLength);
+            }
+            HmacMidstates< Word, stateWords > midstates;
+            for (auto& b: keyBlock) {
+                b ^= 0x36;
+            }
+            (void)memcpy(midstates.inner, initialHashValues, sizeof(midstates.inner));
+            compress(midstates.inner, keyBlock, 1);
+            for (auto& b: keyBlock) {
+                b ^= (0x36 ^ 0x5C);
+            }
+            (void)memcpy(midstates.outer, initialHashValues, sizeof(midstates.outer));
+            compress(midstates.outer, keyBlock, 1);
+            Wipe(keyBlock, sizeof(keyBlock));
+            return midstates;
+        }
+
+        /**
+         * This holds one chain of PBKDF2 iterations, which computes one
+         * block of a derived key.
+         */
+        template< typename Word, size_t stateWords > struct Pbkdf2Chain {
+            /**
+             * These are the hash values after compressing the padded
+             * password.
+             */
+            const HmacMidstates< Word, stateWords >* midstates;
+
+            /**
+             * This points to the cryptographic salt.
+             */
+            const uint8_t* salt;
+
+            /**
+             * This is the length of the salt, in bytes.
+             */
+            size_t saltLength;
+
+            /**
+             * This is the one-based index of the block in the derived key.
+             */
+            size_t index;
+
+            /**
+             * This is the number of iterations.
+             */
+            size_t c;
+
+            /**
+             * This is where to store the block.
+             */
+            uint8_t* output;
+
+            /**
+             * This is the number of bytes of the block to store, which is
+             * less than the digest size only for the last block of a
+             * derived key.
+             */
+            size_t outputLength;
+        };
+
+        /**
+         * This function forms the block used for every iteration of PBKDF2
+         * with HMAC after the first, in which the message is a digest.
+         * The message, padding, and length fit in a single block, and only
+         * the digest at the start of the block changes.
+         *
+         * @param[out] digestBlock
+         *     This is where to store the block.  It must have room for
+         *     two blocks, although only the first is used.
+         */
+        template<
+            size_t digestSize,
+            size_t blockSize,
+            size_t lengthFieldSize
+        > void PadDigestBlock(uint8_t* digestBlock) {
+            static_assert(
+                digestSize + 1 + lengthFieldSize <= blockSize,
+                "digest and padding must fit in one block"
+            );
+            const uint8_t placeholder[digestSize] = {0};
+            (void)PadFinalBlocks< blockSize, lengthFieldSize, true >(
+                digestBlock,
+                placeholder,
+                digestSize,
+                blockSize + digestSize
+            );
+        }
+
+        /**
+         * This function computes the first iteration of a PBKDF2 chain,
+         * whose HMAC message is the salt followed by the four-byte
+         * big-endian index of the block.
+         *
+         * @param[in] chain
+         *     This is the chain for which to compute the first iteration.
+         *
+         * @param[in,out] digestBlock
+         *     This is the block formed by PadDigestBlock, in which to store
+         *     the result of the iteration.
+         *
+         * @param[out] u
+         *     This is where to store the hash values which are the result
+         *     of the iteration.
+         *
+         * @param[in] compress
+         *     This is the single-buffer compression kernel to use.
+         */
+        template<
+            typename Word,
+            size_t stateWords,
+            size_t digestSize,
+            size_t blockSize,
+            size_t lengthFieldSize,
+            typename Compress
+        > void Pbkdf2FirstIteration(
+            const Pbkdf2Chain< Word, stateWords >& chain,
+            uint8_t* digestBlock,
+            Word* u,
+            Compress compress
+        ) {
+            Word inner[stateWords];
+            (void)memcpy(inner, chain.midstates->inner, sizeof(inner));
+            const auto wholeBlocks = chain.saltLength / blockSize;
+            if (wholeBlocks > 0) {
+                compress(inner, chain.salt, wholeBlocks);
+            }
+            const auto remainder = chain.saltLength % blockSize;
+            uint8_t tail[blockSize + 4];
+            if (remainder > 0) {
+                (void)memcpy(tail, chain.salt + wholeBlocks * blockSize, remainder);
+            }
+            tail[remainder] = (uint8_t)(chain.index >> 24);
+            tail[remainder + 1] = (uint8_t)(chain.index >> 16);
+            tail[remainder + 2] = (uint8_t)(chain.index >> 8);
+            tail[remainder + 3] = (uint8_t)chain.index;
+            FinishHash< blockSize, lengthFieldSize >(
+                inner,
+                tail,
+                remainder + 4,
+                (wholeBlocks + 1) * blockSize,
+                compress
+            );
+            StoreDigest< Word, true >(inner, 1, digestBlock, digestSize);
+            Wipe(inner, sizeof(inner));
+            (void)memcpy(u, chain.midstates->outer, sizeof(Word) * stateWords);
+            compress(u, digestBlock, 1);
+            StoreDigest< Word, true >(u, 1, digestBlock, digestSize);
+        }
+
+        /**
+         * This function computes one block of a PBKDF2 derived key, using
+         * HMAC as the pseudorandom function.
+         *
+         * After the first iteration, every HMAC message is a digest, so
+         * each iteration only stores the previous digest into the block
+         * formed by PadDigestBlock and compresses it once from each
+         * midstate.
+         *
+         * @param[in] chain
+         *     This is the chain of iterations to compute.
+         *
+         * @param[in] compress
+         *     This is the single-buffer compression kernel to use.
+         */
+        template<
+            typename Word,
+            size_t stateWords,
+            size_t digestSize,
+            size_t blockSize,
+            size_t lengthFieldSize,
+            typename Compress
+        > void Pbkdf2HmacBlock(
+            const Pbkdf2Chain< Word, stateWords >& chain,
+            Compress compress
+        ) {
+            constexpr size_t digestWords = digestSize / sizeof(Word);
+            uint8_t digestBlock[blockSize * 2];
+            PadDigestBlock< digestSize, blockSize, lengthFieldSize >(digestBlock);
+            Word u[stateWords];
+            Pbkdf2FirstIteration< Word, stateWords, digestSize, blockSize, lengthFieldSize >(
+                chain,
+                digestBlock,
+                u,
+                compress
+            );
+            Word t[digestWords];
+            (void)memcpy(t, u, sizeof(t));
+            const auto& midstates = *chain.midstates;
+            Word inner[stateWords];
+            for (size_t j = 1; j < chain.c; ++j) {
+                (void)memcpy(inner, midstates.inner, sizeof(inner));
+                compress(inner, digestBlock, 1);
+                StoreDigest< Word, true >(inner, 1, digestBlock, digestSize);
+                (void)memcpy(u, midstates.outer, sizeof(u));
+                compress(u, digestBlock, 1);
+                StoreDigest< Word, true >(u, 1, digestBlock, digestSize);
+                for (size_t k = 0; k < digestWords; ++k) {
+                    t[k] ^= u[k];
+                }
+            }
+            uint8_t block[digestSize];
+            StoreDigest< Word, true >(t, 1, block, digestSize);
+            (void)memcpy(chain.output, block, chain.outputLength);
+            Wipe(block, sizeof(block));
+            Wipe(digestBlock, sizeof(digestBlock));
+            Wipe(u, sizeof(u));
+            Wipe(t, sizeof(t));
+            Wipe(inner, sizeof(inner));
+        }
+
+        /**
+         * This is the signature of a multi-buffer compression kernel,
+         * which compresses one block of each of several independent
+         * messages into their hash values, stored word-major (word i of
+         * lane j is at index i * lanes + j).
+         */
+        template< typename Word > using LanesKernel = void(*)(
+            Word* states,
+            const uint8_t* const* blocks
+        );
+
+        /**
+         * This function computes the given chains of PBKDF2 iterations,
+         * using HMAC as the pseudorandom function, by running them in the
+         * lanes of a multi-buffer compression kernel.  Each lane runs one
+         * chain at a time, and is given the next chain as soon as it
+         * finishes the one it has, so chains of different passwords, salts,
+         * and iteration counts may share the kernel.
+         *
+         * @param[in] chains
+         *     These are the chains to compute.
+         *
+         * @param[in] numChains
+         *     This is the number of chains to compute.
+         *
+         * @param[in] compress
+         *     This is the single-buffer compression kernel to use for
+         *     the first iteration of each chain, whose message is the salt.
+         *
+         * @param[in] kernel
+         *     This is the multi-buffer compression kernel to use for the
+         *     rest of the iterations.
+         *
+         * @param[in] lanes
+         *     This is the number of lanes of the multi-buffer kernel, which
+         *     must not be more than maxLanes.
+         */
+        template<
+            typename Word,
+            size_t stateWords,
+            size_t digestSize,
+            size_t blockSize,
+            size_t lengthFieldSize,
+            size_t maxLanes,
+            typename Compress
+        > void Pbkdf2HmacChainsInLanes(
+            const Pbkdf2Chain< Word, stateWords >* chains,
+            size_t numChains,
+            Compress compress,
+            LanesKernel< Word > kernel,
+            size_t lanes
+        ) {
+            constexpr size_t digestWords = digestSize / sizeof(Word);
+            struct Lane {
+                const Pbkdf2Chain< Word, stateWords >* chain = nullptr;
+                size_t iterationsLeft = 0;
+            } lane[maxLanes];
+            uint8_t digestBlocks[maxLanes][blockSize * 2];
+            const uint8_t* digestBlockPointers[maxLanes];
+            Word innerStates[stateWords * maxLanes];
+            Word outerStates[stateWords * maxLanes];
+            Word states[stateWords * maxLanes];
+            Word t[digestWords * maxLanes];
+            size_t nextChain = 0;
+            size_t activeLanes = 0;
+            const auto finishChain = [&](size_t j) {
+                uint8_t block[digestSize];
+                StoreDigest< Word, true >(t + j, lanes, block, digestSize);
+                (void)memcpy(lane[j].chain->output, block, lane[j].chain->outputLength);
+                Wipe(block, sizeof(block));
+            };
+            const auto startNextChain = [&](size_t j) {
+                auto& l = lane[j];
+                while (nextChain < numChains) {
+                    l.chain = &chains[nextChain++];
+                    Word u[stateWords];
+                    Pbkdf2FirstIteration< Word, stateWords, digestSize, blockSize, lengthFieldSize >(
+                        *l.chain,
+                        digestBlocks[j],
+                        u,
+                        compress
+                    );
+                    for (size_t k = 0; k < digestWords; ++k) {
+                        t[k * lanes + j] = u[k];
+                    }
+                    Wipe(u, sizeof(u));
+                    if (l.chain->c <= 1) {
+                        finishChain(j);
+                        continue;
+                    }
+                    for (size_t k = 0; k < stateWords; ++k) {
+                        innerStates[k * lanes + j] = l.chain->midstates->inner[k];
+                        outerStates[k * lanes + j] = l.chain->midstates->outer[k];
+                    }
+                    l.iterationsLeft = l.chain->c - 1;
+                    return;
+                }
+                l.chain = nullptr;
+            };
+            for (size_t j = 0; j < lanes; ++j) {
+                PadDigestBlock< digestSize, blockSize, lengthFieldSize >(digestBlocks[j]);
+                digestBlockPointers[j] = digestBlocks[j];
+                for (size_t k = 0; k < stateWords; ++k) {
+                    innerStates[k * lanes + j] = 0;
+                    outerStates[k * lanes + j] = 0;
+                }
+                for (size_t k = 0; k < digestWords; ++k) {
+                    t[k * lanes + j] = 0;
+                }
+                startNextChain(j);
+                if (lane[j].chain != nullptr) {
+                    ++activeLanes;
+                }
+            }
+            while (activeLanes > 0) {
+                (void)memcpy(states, innerStates, sizeof(Word) * stateWords * lanes);
+                kernel(states, digestBlockPointers);
+                for (size_t j = 0; j < lanes; ++j) {
+                    StoreDigest< Word, true >(states + j, lanes, digestBlocks[j], digestSize);
+                }
+                (void)memcpy(states, outerStates, sizeof(Word) * stateWords * lanes);
+                kernel(states, digestBlockPointers);
+                for (size_t j = 0; j < lanes; ++j) {
+                    StoreDigest< Word, true >(states + j, lanes, digestBlocks[j], digestSize);
+                }
+                for (size_t k = 0; k < digestWords * lanes; ++k) {
+                    t[k] ^= states[k];
+                }
+                for (size_t j = 0; j < lanes; ++j) {
+                    auto& l = lane[j];
+                    if (
+                        (l.chain == nullptr)
+                        || (--l.iterationsLeft > 0)
+                    ) {
+                        continue;
+                    }
+                    finishChain(j);
+                    startNextChain(j);
+                    if (l.chain == nullptr) {
+                        --activeLanes;
+                    }
+                }
+            }
+            Wipe(digestBlocks, sizeof(digestBlocks));
+            Wipe(innerStates, sizeof(innerStates));
+            Wipe(outerStates, sizeof(outerStates));
+            Wipe(states, sizeof(states));
+            Wipe(t, sizeof(t));
+        }
+
+    }
+
+}
+
+#endif /* HASH_PBKDF2_HMAC_HPP */
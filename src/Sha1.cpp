@@ -2,11 +2,14 @@
  * @file Sha1.cpp
  *
  * This module contains the implementation of the
- * Hash::Sha1 function.
+ * Hash::Sha1 function and context.
  *
  * © 2016-2018 by Richard Walters
  */
 
+#include "BlockBuffer.hpp"
+#include "Sha1Kernels.hpp"
+
 #include <Hash/Sha1.hpp>
 #include <string.h>
 #include <stdint.h>
@@ -34,110 +37,261 @@ namespace {
         );
     }
 
+    /**
+     * These are the round constants of the SHA-1 hash function, one for
+     * each stage of twenty rounds.
+     */
+    const uint32_t SHA1_K[4] = {
+        0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6
+    };
+
+    /**
+     * This function computes the round function of the given stage of
+     * SHA-1 (choose, parity, majority, or parity again).
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in] d
+     *     This is working variable D.
+     *
+     * @return
+     *     The result of the round function is returned.
+     */
+    template< size_t stage > inline uint32_t RoundFunction(uint32_t b, uint32_t c, uint32_t d) {
+        return b ^ c ^ d;
+    }
+
+    template<> inline uint32_t RoundFunction< 0 >(uint32_t b, uint32_t c, uint32_t d) {
+        return ((c ^ d) & b) ^ d;
+    }
+
+    template<> inline uint32_t RoundFunction< 2 >(uint32_t b, uint32_t c, uint32_t d) {
+        return (b & c) | (d & (b | c));
+    }
+
+    /**
+     * This function performs one round of SHA-1, first extending the
+     * message schedule if the round needs a new word.  The round number is
+     * a template parameter, so the round function, round constant, and
+     * schedule indices are all fixed at compile time.  Rather than shifting
+     * every working variable, the caller rotates the order in which it
+     * passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in,out] b
+     *     This is working variable B, which is rotated to become working
+     *     variable C for the next round.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in] d
+     *     This is working variable D.
+     *
+     * @param[in,out] e
+     *     This is working variable E, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in,out] w
+     *     These are the last sixteen words of the message schedule.
+     */
+    template< size_t i > inline void Round(
+        uint32_t a, uint32_t& b, uint32_t c, uint32_t d, uint32_t& e,
+        uint32_t* w
+    ) {
+        if (i >= 16) {
+            w[i & 15] = Rot(
+                w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15],
+                1
+            );
+        }
+        e += Rot(a, 5) + RoundFunction< i / 20 >(b, c, d) + SHA1_K[i / 20] + w[i & 15];
+        b = Rot(b, 30);
+    }
+
+    /**
+     * This function performs five consecutive rounds of SHA-1, after which
+     * the working variables are back in their original places.
+     *
+     * @param[in,out] v
+     *     These are the five working variables.
+     *
+     * @param[in,out] w
+     *     These are the last sixteen words of the message schedule.
+     */
+    template< size_t i > inline void FiveRounds(uint32_t* v, uint32_t* w) {
+        Round< i + 0 >(v[0], v[1], v[2], v[3], v[4], w);
+        Round< i + 1 >(v[4], v[0], v[1], v[2], v[3], w);
+        Round< i + 2 >(v[3], v[4], v[0], v[1], v[2], w);
+        Round< i + 3 >(v[2], v[3], v[4], v[0], v[1], w);
+        Round< i + 4 >(v[1], v[2], v[3], v[4], v[0], w);
+    }
+
+    /**
+     * This is the signature of a kernel which updates the hash values of
+     * one message by compressing one or more message blocks into them.
+     */
+    using CompressKernel = void(*)(
+        uint32_t* state,
+        const uint8_t* blocks,
+        size_t numBlocks
+    );
+
+    /**
+     * This function selects the fastest SHA-1 block compression kernel
+     * supported by the CPU.
+     *
+     * @return
+     *     The selected kernel is returned.
+     */
+    CompressKernel SelectSha1Kernel() {
+#if HASH_TARGET_X86
+        const auto& features = Hash::Internal::GetCpuFeatures();
+        if (
+            features.sha
+            && features.ssse3
+            && features.sse41
+        ) {
+            return Hash::Internal::Sha1CompressShaNi;
+        }
+#endif
+        return Hash::Internal::Sha1CompressScalar;
+    }
+
 }
 
 namespace Hash {
 
-    std::vector< uint8_t > Sha1(const std::vector< uint8_t >& data) {
-        // This a straightforward implementation of the pseudocode
-        // found in the Wikipedia page for SHA-1
-        // (https://en.wikipedia.org/wiki/SHA-1).
-        uint8_t chunk[64];
-        uint32_t w[80];
-        uint32_t h0 = 0x67452301;
-        uint32_t h1 = 0xEFCDAB89;
-        uint32_t h2 = 0x98BADCFE;
-        uint32_t h3 = 0x10325476;
-        uint32_t h4 = 0xC3D2E1F0;
-        uint64_t ml = (uint64_t)data.size() * 8;
-        for (size_t offset = 0; offset < data.size() + 9; offset += 64) {
-            if (offset + 64 <= data.size()) {
-                (void)memcpy(chunk, &data[offset], 64);
-            } else {
-                (void)memset(chunk, 0, 64);
-                if (offset < data.size()) {
-                    (void)memcpy(chunk, &data[offset], data.size() - offset);
-                }
-                if (offset <= data.size()) {
-                    chunk[data.size() - offset] = 0x80;
+    namespace Internal {
+
+        const uint32_t Sha1InitialHashValues[5] = {
+            0x67452301,
+            0xEFCDAB89,
+            0x98BADCFE,
+            0x10325476,
+            0xC3D2E1F0,
+        };
+
+        void Sha1CompressScalar(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            uint32_t w[16];
+            uint32_t v[5];
+            for (; numBlocks > 0; --numBlocks, blocks += 64) {
+                for (size_t i = 0; i < 16; ++i) {
+                    w[i] = (
+                        ((uint32_t)blocks[i * 4 + 0] << 24)
+                        | ((uint32_t)blocks[i * 4 + 1] << 16)
+                        | ((uint32_t)blocks[i * 4 + 2] << 8)
+                        | (uint32_t)blocks[i * 4 + 3]
+                    );
                 }
-                if (offset + 64 - data.size() >= 9) {
-                    chunk[56] = (uint8_t)(ml >> 56);
-                    chunk[57] = (uint8_t)(ml >> 48);
-                    chunk[58] = (uint8_t)(ml >> 40);
-                    chunk[59] = (uint8_t)(ml >> 32);
-                    chunk[60] = (uint8_t)(ml >> 24);
-                    chunk[61] = (uint8_t)(ml >> 16);
-                    chunk[62] = (uint8_t)(ml >> 8);
-                    chunk[63] = (uint8_t)ml;
+                (void)memcpy(v, state, sizeof(v));
+                FiveRounds< 0 >(v, w);
+                FiveRounds< 5 >(v, w);
+                FiveRounds< 10 >(v, w);
+                FiveRounds< 15 >(v, w);
+                FiveRounds< 20 >(v, w);
+                FiveRounds< 25 >(v, w);
+                FiveRounds< 30 >(v, w);
+                FiveRounds< 35 >(v, w);
+                FiveRounds< 40 >(v, w);
+                FiveRounds< 45 >(v, w);
+                FiveRounds< 50 >(v, w);
+                FiveRounds< 55 >(v, w);
+                FiveRounds< 60 >(v, w);
+                FiveRounds< 65 >(v, w);
+                FiveRounds< 70 >(v, w);
+                FiveRounds< 75 >(v, w);
+                for (size_t i = 0; i < 5; ++i) {
+                    state[i] += v[i];
                 }
             }
-            for (size_t i = 0; i < 16; ++i) {
-                w[i] = (
-                    ((uint32_t)chunk[i * 4 + 0] << 24)
-                    | ((uint32_t)chunk[i * 4 + 1] << 16)
-                    | ((uint32_t)chunk[i * 4 + 2] << 8)
-                    | (uint32_t)chunk[i * 4 + 3]
-                );
-            }
-            for (size_t i = 16; i < 80; ++i) {
-                w[i] = Rot(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        void Sha1Compress(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            static const auto kernel = SelectSha1Kernel();
+            kernel(state, blocks, numBlocks);
+        }
+
+    }
+
+    Sha1Context::Sha1Context() {
+        Reset();
+    }
+
+    void Sha1Context::Reset() {
+        (void)memcpy(state_, Internal::Sha1InitialHashValues, sizeof(state_));
+        bufferLength_ = 0;
+        messageLength_ = 0;
+    }
+
+    void Sha1Context::Update(const void* data, size_t length) {
+        messageLength_ += length;
+        Internal::AbsorbData< SHA1_BLOCK_SIZE >(
+            buffer_,
+            bufferLength_,
+            (const uint8_t*)data,
+            length,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Internal::Sha1Compress(state_, blocks, numBlocks);
             }
-            uint32_t a = h0;
-            uint32_t b = h1;
-            uint32_t c = h2;
-            uint32_t d = h3;
-            uint32_t e = h4;
-            for (size_t i = 0; i < 80; ++i) {
-                uint32_t f, k;
-                if (i < 20) {
-                    f = (b & c) | ((~b) & d);
-                    k = 0x5A827999;
-                } else if (i < 40) {
-                    f = b ^ c ^ d;
-                    k = 0x6ED9EBA1;
-                } else if (i < 60) {
-                    f = (b & c) | (b & d) | (c & d);
-                    k = 0x8F1BBCDC;
-                } else {
-                    f = b ^ c ^ d;
-                    k = 0xCA62C1D6;
-                }
-                uint32_t temp = Rot(a, 5) + f + e + k + w[i];
-                e = d;
-                d = c;
-                c = Rot(b, 30);
-                b = a;
-                a = temp;
+        );
+    }
+
+    void Sha1Context::Update(const std::vector< uint8_t >& data) {
+        Update(data.data(), data.size());
+    }
+
+    std::vector< uint8_t > Sha1Context::Final() {
+        std::vector< uint8_t > digest(SHA1_DIGEST_LENGTH / 8);
+        Final(digest.data());
+        return digest;
+    }
+
+    void Sha1Context::Final(uint8_t* digest) {
+        Internal::PadAndCompress< SHA1_BLOCK_SIZE, 8, true >(
+            buffer_,
+            bufferLength_,
+            messageLength_,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Internal::Sha1Compress(state_, blocks, numBlocks);
             }
-            h0 += a;
-            h1 += b;
-            h2 += c;
-            h3 += d;
-            h4 += e;
+        );
+        for (size_t i = 0; i < SHA1_DIGEST_LENGTH / 8; ++i) {
+            digest[i] = (uint8_t)(state_[i / 4] >> (24 - (i % 4) * 8));
         }
-        return {
-            (uint8_t)((h0 >> 24) & 0xff),
-            (uint8_t)((h0 >> 16) & 0xff),
-            (uint8_t)((h0 >> 8) & 0xff),
-            (uint8_t)(h0 & 0xff),
-            (uint8_t)((h1 >> 24) & 0xff),
-            (uint8_t)((h1 >> 16) & 0xff),
-            (uint8_t)((h1 >> 8) & 0xff),
-            (uint8_t)(h1 & 0xff),
-            (uint8_t)((h2 >> 24) & 0xff),
-            (uint8_t)((h2 >> 16) & 0xff),
-            (uint8_t)((h2 >> 8) & 0xff),
-            (uint8_t)(h2 & 0xff),
-            (uint8_t)((h3 >> 24) & 0xff),
-            (uint8_t)((h3 >> 16) & 0xff),
-            (uint8_t)((h3 >> 8) & 0xff),
-            (uint8_t)(h3 & 0xff),
-            (uint8_t)((h4 >> 24) & 0xff),
-            (uint8_t)((h4 >> 16) & 0xff),
-            (uint8_t)((h4 >> 8) & 0xff),
-            (uint8_t)(h4 & 0xff),
-        };
+        Reset();
+    }
+
+    std::vector< uint8_t > Sha1(const std::vector< uint8_t >& data) {
+        std::vector< uint8_t > digest(SHA1_DIGEST_LENGTH / 8);
+        ComputeSha1(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeSha1(const void* data, size_t length, uint8_t* digest) {
+        Sha1Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Sha1Digest ComputeSha1(const void* data, size_t length) {
+        Sha1Digest digest;
+        ComputeSha1(data, length, digest.data());
+        return digest;
     }
 
 }
@@ -0,0 +1,98 @@
+#ifndef HASH_SHA1_KERNELS_HPP
+#define HASH_SHA1_KERNELS_HPP
+
+/**
+ * @file Sha1Kernels.hpp
+ *
+ * This module declares the block compression kernels of the SHA-1 hash
+ * function.  Each kernel updates the hash values of one message by
+ * compressing one or more whole message blocks into them.  The portable
+ * kernel works everywhere, while the others require optional instruction
+ * set extensions and must only be called if the CPU supports them.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "CpuFeatures.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * This function updates the given SHA-1 hash values by compressing
+         * the given message blocks into them, using only portable C++.
+         *
+         * @param[in,out] state
+         *     These are the five hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 64-byte message blocks to compress.
+         */
+        void Sha1CompressScalar(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+        /**
+         * These are the initial hash values of the SHA-1 hash function.
+         */
+        extern const uint32_t Sha1InitialHashValues[5];
+
+        /**
+         * This function updates the given SHA-1 hash values by compressing
+         * the given message blocks into them, using the fastest kernel
+         * supported by the CPU.
+         *
+         * @param[in,out] state
+         *     These are the five hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 64-byte message blocks to compress.
+         */
+        void Sha1Compress(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+#if HASH_TARGET_X86
+        /**
+         * This function updates the given SHA-1 hash values by compressing
+         * the given message blocks into them, using the Intel SHA
+         * extensions.
+         *
+         * @note
+         *     This requires the SHA, SSSE3, and SSE4.1 extensions.
+         *
+         * @param[in,out] state
+         *     These are the five hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 64-byte message blocks to compress.
+         */
+        void Sha1CompressShaNi(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+#endif
+
+    }
+
+}
+
+#endif /* HASH_SHA1_KERNELS_HPP */
@@ -0,0 +1,166 @@
+/**
+ * @file Sha1ShaNi.cpp
+ *
+ * This module contains the implementation of the SHA-1 block compression
+ * kernel which uses the Intel SHA extensions.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha1Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function performs four rounds of SHA-1 on the given state,
+     * using the given four message schedule words.
+     *
+     * @param[in,out] abcd
+     *     These are the working variables A, B, C, and D.
+     *
+     * @param[in,out] e
+     *     This holds the working variable E for these rounds, to which
+     *     the message schedule words are added.
+     *
+     * @param[out] eNext
+     *     This is where to save the working variable A, which becomes
+     *     the working variable E for the next four rounds.
+     *
+     * @param[in] w
+     *     These are the four message schedule words for the rounds.
+     */
+    template< int f > inline void FourRounds(
+        __m128i& abcd,
+        __m128i& e,
+        __m128i& eNext,
+        __m128i w
+    ) {
+        e = _mm_sha1nexte_epu32(e, w);
+        eNext = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e, f);
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Sha1CompressShaNi(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            const __m128i byteSwap = _mm_set_epi64x(
+                0x0001020304050607ULL,
+                0x08090a0b0c0d0e0fULL
+            );
+            auto abcd = _mm_shuffle_epi32(
+                _mm_loadu_si128((const __m128i*)state),
+                0x1B
+            );
+            auto e0 = _mm_set_epi32((int)state[4], 0, 0, 0);
+            __m128i e1;
+            for (; numBlocks > 0; --numBlocks, blocks += 64) {
+                const auto abcdSaved = abcd;
+                const auto eSaved = e0;
+                auto w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 0)), byteSwap);
+                auto w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 16)), byteSwap);
+                auto w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 32)), byteSwap);
+                auto w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 48)), byteSwap);
+
+                // Rounds 0-19
+                e0 = _mm_add_epi32(e0, w0);
+                e1 = abcd;
+                abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+                FourRounds< 0 >(abcd, e1, e0, w1);
+                w0 = _mm_sha1msg1_epu32(w0, w1);
+                FourRounds< 0 >(abcd, e0, e1, w2);
+                w1 = _mm_sha1msg1_epu32(w1, w2);
+                w0 = _mm_xor_si128(w0, w2);
+                w0 = _mm_sha1msg2_epu32(w0, w3);
+                FourRounds< 0 >(abcd, e1, e0, w3);
+                w2 = _mm_sha1msg1_epu32(w2, w3);
+                w1 = _mm_xor_si128(w1, w3);
+                w1 = _mm_sha1msg2_epu32(w1, w0);
+                FourRounds< 0 >(abcd, e0, e1, w0);
+                w3 = _mm_sha1msg1_epu32(w3, w0);
+                w2 = _mm_xor_si128(w2, w0);
+
+                // Rounds 20-39
+                w2 = _mm_sha1msg2_epu32(w2, w1);
+                FourRounds< 1 >(abcd, e1, e0, w1);
+                w0 = _mm_sha1msg1_epu32(w0, w1);
+                w3 = _mm_xor_si128(w3, w1);
+                w3 = _mm_sha1msg2_epu32(w3, w2);
+                FourRounds< 1 >(abcd, e0, e1, w2);
+                w1 = _mm_sha1msg1_epu32(w1, w2);
+                w0 = _mm_xor_si128(w0, w2);
+                w0 = _mm_sha1msg2_epu32(w0, w3);
+                FourRounds< 1 >(abcd, e1, e0, w3);
+                w2 = _mm_sha1msg1_epu32(w2, w3);
+                w1 = _mm_xor_si128(w1, w3);
+                w1 = _mm_sha1msg2_epu32(w1, w0);
+                FourRounds< 1 >(abcd, e0, e1, w0);
+                w3 = _mm_sha1msg1_epu32(w3, w0);
+                w2 = _mm_xor_si128(w2, w0);
+                w2 = _mm_sha1msg2_epu32(w2, w1);
+                FourRounds< 1 >(abcd, e1, e0, w1);
+                w0 = _mm_sha1msg1_epu32(w0, w1);
+                w3 = _mm_xor_si128(w3, w1);
+
+                // Rounds 40-59
+                w3 = _mm_sha1msg2_epu32(w3, w2);
+                FourRounds< 2 >(abcd, e0, e1, w2);
+                w1 = _mm_sha1msg1_epu32(w1, w2);
+                w0 = _mm_xor_si128(w0, w2);
+                w0 = _mm_sha1msg2_epu32(w0, w3);
+                FourRounds< 2 >(abcd, e1, e0, w3);
+                w2 = _mm_sha1msg1_epu32(w2, w3);
+                w1 = _mm_xor_si128(w1, w3);
+                w1 = _mm_sha1msg2_epu32(w1, w0);
+                FourRounds< 2 >(abcd, e0, e1, w0);
+                w3 = _mm_sha1msg1_epu32(w3, w0);
+                w2 = _mm_xor_si128(w2, w0);
+                w2 = _mm_sha1msg2_epu32(w2, w1);
+                FourRounds< 2 >(abcd, e1, e0, w1);
+                w0 = _mm_sha1msg1_epu32(w0, w1);
+                w3 = _mm_xor_si128(w3, w1);
+                w3 = _mm_sha1msg2_epu32(w3, w2);
+                FourRounds< 2 >(abcd, e0, e1, w2);
+                w1 = _mm_sha1msg1_epu32(w1, w2);
+                w0 = _mm_xor_si128(w0, w2);
+
+                // Rounds 60-79
+                w0 = _mm_sha1msg2_epu32(w0, w3);
+                FourRounds< 3 >(abcd, e1, e0, w3);
+                w2 = _mm_sha1msg1_epu32(w2, w3);
+                w1 = _mm_xor_si128(w1, w3);
+                w1 = _mm_sha1msg2_epu32(w1, w0);
+                FourRounds< 3 >(abcd, e0, e1, w0);
+                w3 = _mm_sha1msg1_epu32(w3, w0);
+                w2 = _mm_xor_si128(w2, w0);
+                w2 = _mm_sha1msg2_epu32(w2, w1);
+                FourRounds< 3 >(abcd, e1, e0, w1);
+                w3 = _mm_xor_si128(w3, w1);
+                w3 = _mm_sha1msg2_epu32(w3, w2);
+                FourRounds< 3 >(abcd, e0, e1, w2);
+                FourRounds< 3 >(abcd, e1, e0, w3);
+
+                e0 = _mm_sha1nexte_epu32(e0, eSaved);
+                abcd = _mm_add_epi32(abcd, abcdSaved);
+            }
+            _mm_storeu_si128((__m128i*)state, _mm_shuffle_epi32(abcd, 0x1B));
+            state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
@@ -2,13 +2,16 @@
  * @file Sha2.cpp
  *
  * This module contains the implementation of the
- * Hash::Sha2 function.
+ * Hash::Sha2 functions and contexts.
  *
  * © 2018 by Richard Walters
  */
 
+#include "BlockBuffer.hpp"
+#include "MultiBuffer.hpp"
+#include "Sha2Kernels.hpp"
+
 #include <Hash/Sha2.hpp>
-#include <string>
 #include <string.h>
 #include <stdint.h>
 #include <vector>
@@ -56,38 +59,426 @@ namespace {
     }
 
     /**
-     * This function computes either the SHA-224 or the SHA-256 message digest
-     * of the given data.
+     * This function performs one round of SHA-224 or SHA-256, first
+     * extending the message schedule if the round needs a new word.  The
+     * round number is a template parameter, so the round constant, the
+     * schedule indices, and whether or not to extend the schedule are all
+     * fixed at compile time.  Rather than shifting every working variable,
+     * the caller rotates the order in which it passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D, which becomes working variable E
+     *     for the next round.
+     *
+     * @param[in] e
+     *     This is working variable E.
+     *
+     * @param[in] f
+     *     This is working variable F.
+     *
+     * @param[in] g
+     *     This is working variable G.
+     *
+     * @param[in,out] h
+     *     This is working variable H, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in,out] w
+     *     These are the last sixteen words of the message schedule.
+     */
+    template< size_t i > inline void Sha256Round(
+        uint32_t a, uint32_t b, uint32_t c, uint32_t& d,
+        uint32_t e, uint32_t f, uint32_t g, uint32_t& h,
+        uint32_t* w
+    ) {
+        if (i >= 16) {
+            const auto w15 = w[(i + 1) & 15];
+            const auto w2 = w[(i + 14) & 15];
+            w[i & 15] += (
+                (Rot(w15, 7) ^ Rot(w15, 18) ^ (w15 >> 3)) // s0
+                + w[(i + 9) & 15]
+                + (Rot(w2, 17) ^ Rot(w2, 19) ^ (w2 >> 10)) // s1
+            );
+        }
+        const auto t1 = (
+            h
+            + (Rot(e, 6) ^ Rot(e, 11) ^ Rot(e, 25)) // S1
+            + (((f ^ g) & e) ^ g) // ch
+            + Hash::Internal::K256[i]
+            + w[i & 15]
+        );
+        const auto t2 = (
+            (Rot(a, 2) ^ Rot(a, 13) ^ Rot(a, 22)) // S0
+            + ((a & b) | (c & (a | b))) // maj
+        );
+        d += t1;
+        h = t1 + t2;
+    }
+
+    /**
+     * This function performs eight consecutive rounds of SHA-224 or
+     * SHA-256, after which the working variables are back in their
+     * original places.
+     *
+     * @param[in,out] v
+     *     These are the eight working variables.
+     *
+     * @param[in,out] w
+     *     These are the last sixteen words of the message schedule.
+     */
+    template< size_t i > inline void Sha256EightRounds(uint32_t* v, uint32_t* w) {
+        Sha256Round< i + 0 >(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], w);
+        Sha256Round< i + 1 >(v[7], v[0], v[1], v[2], v[3], v[4], v[5], v[6], w);
+        Sha256Round< i + 2 >(v[6], v[7], v[0], v[1], v[2], v[3], v[4], v[5], w);
+        Sha256Round< i + 3 >(v[5], v[6], v[7], v[0], v[1], v[2], v[3], v[4], w);
+        Sha256Round< i + 4 >(v[4], v[5], v[6], v[7], v[0], v[1], v[2], v[3], w);
+        Sha256Round< i + 5 >(v[3], v[4], v[5], v[6], v[7], v[0], v[1], v[2], w);
+        Sha256Round< i + 6 >(v[2], v[3], v[4], v[5], v[6], v[7], v[0], v[1], w);
+        Sha256Round< i + 7 >(v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[0], w);
+    }
+
+    /**
+     * This function performs one round of SHA-384, SHA-512, or SHA-512/t,
+     * first extending the message schedule if the round needs a new word.
+     * The round number is a template parameter, so the round constant, the
+     * schedule indices, and whether or not to extend the schedule are all
+     * fixed at compile time.  Rather than shifting every working variable,
+     * the caller rotates the order in which it passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D, which becomes working variable E
+     *     for the next round.
+     *
+     * @param[in] e
+     *     This is working variable E.
+     *
+     * @param[in] f
+     *     This is working variable F.
+     *
+     * @param[in] g
+     *     This is working variable G.
+     *
+     * @param[in,out] h
+     *     This is working variable H, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in,out] w
+     *     These are the last sixteen words of the message schedule.
+     */
+    template< size_t i > inline void Sha512Round(
+        uint64_t a, uint64_t b, uint64_t c, uint64_t& d,
+        uint64_t e, uint64_t f, uint64_t g, uint64_t& h,
+        uint64_t* w
+    ) {
+        if (i >= 16) {
+            const auto w15 = w[(i + 1) & 15];
+            const auto w2 = w[(i + 14) & 15];
+            w[i & 15] += (
+                (Rot(w15, 1) ^ Rot(w15, 8) ^ (w15 >> 7)) // s0
+                + w[(i + 9) & 15]
+                + (Rot(w2, 19) ^ Rot(w2, 61) ^ (w2 >> 6)) // s1
+            );
+        }
+        const auto t1 = (
+            h
+            + (Rot(e, 14) ^ Rot(e, 18) ^ Rot(e, 41)) // S1
+            + (((f ^ g) & e) ^ g) // ch
+            + Hash::Internal::K512[i]
+            + w[i & 15]
+        );
+        const auto t2 = (
+            (Rot(a, 28) ^ Rot(a, 34) ^ Rot(a, 39)) // S0
+            + ((a & b) | (c & (a | b))) // maj
+        );
+        d += t1;
+        h = t1 + t2;
+    }
+
+    /**
+     * This function performs eight consecutive rounds of SHA-384, SHA-512,
+     * or SHA-512/t, after which the working variables are back in their
+     * original places.
+     *
+     * @param[in,out] v
+     *     These are the eight working variables.
+     *
+     * @param[in,out] w
+     *     These are the last sixteen words of the message schedule.
+     */
+    template< size_t i > inline void Sha512EightRounds(uint64_t* v, uint64_t* w) {
+        Sha512Round< i + 0 >(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], w);
+        Sha512Round< i + 1 >(v[7], v[0], v[1], v[2], v[3], v[4], v[5], v[6], w);
+        Sha512Round< i + 2 >(v[6], v[7], v[0], v[1], v[2], v[3], v[4], v[5], w);
+        Sha512Round< i + 3 >(v[5], v[6], v[7], v[0], v[1], v[2], v[3], v[4], w);
+        Sha512Round< i + 4 >(v[4], v[5], v[6], v[7], v[0], v[1], v[2], v[3], w);
+        Sha512Round< i + 5 >(v[3], v[4], v[5], v[6], v[7], v[0], v[1], v[2], w);
+        Sha512Round< i + 6 >(v[2], v[3], v[4], v[5], v[6], v[7], v[0], v[1], w);
+        Sha512Round< i + 7 >(v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[0], w);
+    }
+
+    /**
+     * These are the initial hash values of the SHA-224 hash function.
+     */
+    const uint32_t SHA224_INITIAL_HASH_VALUES[8] = {
+        0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+        0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+    };
+
+    /**
+     * These are the initial hash values of the SHA-384 hash function.
+     */
+    const uint64_t SHA384_INITIAL_HASH_VALUES[8] = {
+        0xcbbb9d5dc1059ed8,
+        0x629a292a367cd507,
+        0x9159015a3070dd17,
+        0x152fecd8f70e5939,
+        0x67332667ffc00b31,
+        0x8eb44a8768581511,
+        0xdb0c2e0d64f98fa7,
+        0x47b5481dbefa4fa4
+    };
+
+    /**
+     * This is the signature of a kernel which updates the hash values of
+     * one message by compressing one or more message blocks into them.
+     */
+    template< typename Word > using CompressKernel = void(*)(
+        Word* state,
+        const uint8_t* blocks,
+        size_t numBlocks
+    );
+
+    /**
+     * This function selects the fastest SHA-224/SHA-256 block compression
+     * kernel supported by the CPU.
+     *
+     * @return
+     *     The selected kernel is returned.
+     */
+    CompressKernel< uint32_t > SelectSha256Kernel() {
+#if HASH_TARGET_X86
+        const auto& features = Hash::Internal::GetCpuFeatures();
+        if (
+            features.sha
+            && features.ssse3
+            && features.sse41
+        ) {
+            return Hash::Internal::Sha256CompressShaNi;
+        }
+        if (
+            features.avx2
+            && features.bmi2
+        ) {
+            return Hash::Internal::Sha256CompressAvx2;
+        }
+#endif
+        return Hash::Internal::Sha256CompressScalar;
+    }
+
+    /**
+     * This function selects the fastest SHA-384/SHA-512/SHA-512/t block
+     * compression kernel supported by the CPU.
+     *
+     * @return
+     *     The selected kernel is returned.
+     */
+    CompressKernel< uint64_t > SelectSha512Kernel() {
+#if HASH_TARGET_X86
+        const auto& features = Hash::Internal::GetCpuFeatures();
+        if (
+            features.avx2
+            && features.bmi2
+        ) {
+            return Hash::Internal::Sha512CompressAvx2;
+        }
+#endif
+        return Hash::Internal::Sha512CompressScalar;
+    }
+
+    /**
+     * This is used to hold the eight initial hash values of a variant
+     * of SHA-512.
+     */
+    struct Sha512InitialHashValues {
+        uint64_t h[8];
+    };
+
+    /**
+     * This function evaluates a modified SHA-512 on the given string, to be
+     * used to generate the initial hash values for SHA-512/t hash functions.
      *
      * @param[in] data
-     *     This is the data for which to compute the message digest.
+     *     This is the null-terminated string for which to evaluate the
+     *     modified SHA-512.  It is hashed in place.
+     *
+     * @return
+     *     The initial hash values for the SHA-512/t hash function matching
+     *     the given data is returned.
+     */
+    Sha512InitialHashValues Sha512IV(const char* data) {
+        const auto length = strlen(data);
+        Sha512InitialHashValues iv;
+        for (size_t i = 0; i < 8; ++i) {
+            iv.h[i] = Hash::Internal::Sha512InitialHashValues[i] ^ 0xa5a5a5a5a5a5a5a5;
+        }
+        const auto compress = [&iv](const uint8_t* blocks, size_t numBlocks){
+            Hash::Internal::Sha512Compress(iv.h, blocks, numBlocks);
+        };
+        uint8_t buffer[Hash::SHA512_BLOCK_SIZE];
+        size_t bufferLength = 0;
+        Hash::Internal::AbsorbData< Hash::SHA512_BLOCK_SIZE >(
+            buffer,
+            bufferLength,
+            (const uint8_t*)data,
+            length,
+            compress
+        );
+        Hash::Internal::PadAndCompress< Hash::SHA512_BLOCK_SIZE, 16, true >(
+            buffer,
+            bufferLength,
+            length,
+            compress
+        );
+        return iv;
+    }
+
+    /**
+     * This function returns the initial hash values of the SHA-512/224
+     * hash function, generating them the first time it's called.
      *
-     * @param[in] truncate
-     *     If true, compute the SHA-224 message digest.  Otherwise, compute
-     *     the SHA-256 message digest.
+     * @return
+     *     The initial hash values of the SHA-512/224 hash function
+     *     are returned.
+     */
+    const uint64_t* Sha512t224InitialHashValues() {
+        static const auto iv = Sha512IV("SHA-512/224");
+        return iv.h;
+    }
+
+    /**
+     * This function returns the initial hash values of the SHA-512/256
+     * hash function, generating them the first time it's called.
      *
      * @return
-     *     The SHA-224 or SHA-256 message digest of the given data is returned
-     *     as a vector of bytes.
+     *     The initial hash values of the SHA-512/256 hash function
+     *     are returned.
+     */
+    const uint64_t* Sha512t256InitialHashValues() {
+        static const auto iv = Sha512IV("SHA-512/256");
+        return iv.h;
+    }
+
+    /**
+     * This function computes the message digests of the given messages,
+     * using a variant of SHA-512 selected by the given initial hash values
+     * and digest size, and the fastest kernel supported by the CPU.
+     *
+     * @param[in] messages
+     *     This points to the first byte of each message.
+     *
+     * @param[in] lengths
+     *     These are the lengths, in bytes, of the messages.
+     *
+     * @param[in] numMessages
+     *     This is the number of messages.
+     *
+     * @param[in] initialHashValues
+     *     These are the initial hash values of the SHA-512 variant.
+     *
+     * @param[out] digests
+     *     This is where to store the message digests, one after
+     *     the other, in the same order as the messages.
+     *
+     * @param[in] digestSize
+     *     This is the size, in bytes, of each message digest.
      */
-    std::vector< uint8_t > Sha224or256(
-        const std::vector< uint8_t >& data,
-        bool truncate
+    void Sha512FamilyBatch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        const uint64_t* initialHashValues,
+        uint8_t* digests,
+        size_t digestSize
     ) {
-        // This a straightforward implementation of the pseudocode
-        // found in the Wikipedia page for SHA-2
-        // (https://en.wikipedia.org/wiki/SHA-2).
-        uint8_t chunk[64];
-        uint32_t w[64];
-        uint32_t h0 = truncate ? 0xc1059ed8 : 0x6a09e667;
-        uint32_t h1 = truncate ? 0x367cd507 : 0xbb67ae85;
-        uint32_t h2 = truncate ? 0x3070dd17 : 0x3c6ef372;
-        uint32_t h3 = truncate ? 0xf70e5939 : 0xa54ff53a;
-        uint32_t h4 = truncate ? 0xffc00b31 : 0x510e527f;
-        uint32_t h5 = truncate ? 0x68581511 : 0x9b05688c;
-        uint32_t h6 = truncate ? 0x64f98fa7 : 0x1f83d9ab;
-        uint32_t h7 = truncate ? 0xbefa4fa4 : 0x5be0cd19;
-        static const uint32_t k[64] = {
+#if HASH_TARGET_X86
+        const auto& features = Hash::Internal::GetCpuFeatures();
+        if (features.avx512) {
+            Hash::Internal::HashInLanes< uint64_t, 8, 8, Hash::SHA512_BLOCK_SIZE, 16, true >(
+                messages,
+                lengths,
+                numMessages,
+                initialHashValues,
+                digests,
+                digestSize,
+                Hash::Internal::Sha512CompressAvx512x8
+            );
+            return;
+        }
+        if (features.avx2) {
+            Hash::Internal::HashInLanes< uint64_t, 8, 4, Hash::SHA512_BLOCK_SIZE, 16, true >(
+                messages,
+                lengths,
+                numMessages,
+                initialHashValues,
+                digests,
+                digestSize,
+                Hash::Internal::Sha512CompressAvx2x4
+            );
+            return;
+        }
+#endif
+        Hash::Internal::HashOneAtATime< uint64_t, 8, Hash::SHA512_BLOCK_SIZE, 16, true >(
+            messages,
+            lengths,
+            numMessages,
+            initialHashValues,
+            digests,
+            digestSize,
+            Hash::Internal::Sha512Compress
+        );
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        const uint32_t Sha256InitialHashValues[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+
+        const uint64_t Sha512InitialHashValues[8] = {
+            0x6a09e667f3bcc908,
+            0xbb67ae8584caa73b,
+            0x3c6ef372fe94f82b,
+            0xa54ff53a5f1d36f1,
+            0x510e527fade682d1,
+            0x9b05688c2b3e6c1f,
+            0x1f83d9abfb41bd6b,
+            0x5be0cd19137e2179
+        };
+
+        const uint32_t K256[64] = {
             0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
             0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
             0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
@@ -105,170 +496,8 @@ namespace {
             0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
             0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
         };
-        uint64_t ml = (uint64_t)data.size() * 8;
-        for (size_t offset = 0; offset < data.size() + 9; offset += 64) {
-            if (offset + 64 <= data.size()) {
-                (void)memcpy(chunk, &data[offset], 64);
-            } else {
-                (void)memset(chunk, 0, 64);
-                if (offset < data.size()) {
-                    (void)memcpy(chunk, &data[offset], data.size() - offset);
-                }
-                if (offset <= data.size()) {
-                    chunk[data.size() - offset] = 0x80;
-                }
-                if (offset + 64 - data.size() >= 9) {
-                    chunk[56] = (uint8_t)(ml >> 56);
-                    chunk[57] = (uint8_t)(ml >> 48);
-                    chunk[58] = (uint8_t)(ml >> 40);
-                    chunk[59] = (uint8_t)(ml >> 32);
-                    chunk[60] = (uint8_t)(ml >> 24);
-                    chunk[61] = (uint8_t)(ml >> 16);
-                    chunk[62] = (uint8_t)(ml >> 8);
-                    chunk[63] = (uint8_t)ml;
-                }
-            }
-            for (size_t i = 0; i < 16; ++i) {
-                w[i] = (
-                    ((uint32_t)chunk[i * 4 + 0] << 24)
-                    | ((uint32_t)chunk[i * 4 + 1] << 16)
-                    | ((uint32_t)chunk[i * 4 + 2] << 8)
-                    | (uint32_t)chunk[i * 4 + 3]
-                );
-            }
-            for (size_t i = 16; i < 64; ++i) {
-                w[i] = (
-                    w[i - 16]
-                    + (
-                        Rot(w[i - 15], 7) ^ Rot(w[i - 15], 18) ^ (w[i - 15] >> 3)
-                    ) // s0
-                    + w[i - 7]
-                    + (
-                        Rot(w[i - 2], 17) ^ Rot(w[i - 2], 19) ^ (w[i - 2] >> 10)
-                    ) // s1
-                );
-            }
-            uint32_t a = h0;
-            uint32_t b = h1;
-            uint32_t c = h2;
-            uint32_t d = h3;
-            uint32_t e = h4;
-            uint32_t f = h5;
-            uint32_t g = h6;
-            uint32_t h = h7;
-            for (size_t i = 0; i < 64; ++i) {
-                const auto t1 = (
-                    h + (
-                        Rot(e, 6) ^ Rot(e, 11) ^ Rot(e, 25)
-                    ) // S1
-                    + (
-                        (e & f) ^ (~e & g)
-                    ) // ch
-                    + k[i]
-                    + w[i]
-                );
-                const auto t2 = (
-                    (
-                        Rot(a, 2) ^ Rot(a, 13) ^ Rot(a, 22)
-                    ) // S0
-                    + (
-                        (a & b) ^ (a & c) ^ (b & c)
-                    ) // maj
-                );
-                h = g;
-                g = f;
-                f = e;
-                e = d + t1;
-                d = c;
-                c = b;
-                b = a;
-                a = t1 + t2;
-            }
-            h0 += a;
-            h1 += b;
-            h2 += c;
-            h3 += d;
-            h4 += e;
-            h5 += f;
-            h6 += g;
-            h7 += h;
-        }
-        std::vector< uint8_t > digest{
-            (uint8_t)((h0 >> 24) & 0xff),
-            (uint8_t)((h0 >> 16) & 0xff),
-            (uint8_t)((h0 >> 8) & 0xff),
-            (uint8_t)(h0 & 0xff),
-            (uint8_t)((h1 >> 24) & 0xff),
-            (uint8_t)((h1 >> 16) & 0xff),
-            (uint8_t)((h1 >> 8) & 0xff),
-            (uint8_t)(h1 & 0xff),
-            (uint8_t)((h2 >> 24) & 0xff),
-            (uint8_t)((h2 >> 16) & 0xff),
-            (uint8_t)((h2 >> 8) & 0xff),
-            (uint8_t)(h2 & 0xff),
-            (uint8_t)((h3 >> 24) & 0xff),
-            (uint8_t)((h3 >> 16) & 0xff),
-            (uint8_t)((h3 >> 8) & 0xff),
-            (uint8_t)(h3 & 0xff),
-            (uint8_t)((h4 >> 24) & 0xff),
-            (uint8_t)((h4 >> 16) & 0xff),
-            (uint8_t)((h4 >> 8) & 0xff),
-            (uint8_t)(h4 & 0xff),
-            (uint8_t)((h5 >> 24) & 0xff),
-            (uint8_t)((h5 >> 16) & 0xff),
-            (uint8_t)((h5 >> 8) & 0xff),
-            (uint8_t)(h5 & 0xff),
-            (uint8_t)((h6 >> 24) & 0xff),
-            (uint8_t)((h6 >> 16) & 0xff),
-            (uint8_t)((h6 >> 8) & 0xff),
-            (uint8_t)(h6 & 0xff)
-        };
-        if (!truncate) {
-            digest.push_back((uint8_t)((h7 >> 24) & 0xff));
-            digest.push_back((uint8_t)((h7 >> 16) & 0xff));
-            digest.push_back((uint8_t)((h7 >> 8) & 0xff));
-            digest.push_back((uint8_t)(h7 & 0xff));
-        }
-        return digest;
-    }
 
-    /**
-     * This function computes either the SHA-384, SHA-512, or SHA-512/n message
-     * digest of the given data, depending on the given output size and initial
-     * hash values.
-     *
-     * @param[in] data
-     *     This is the data for which to compute the message digest.
-     *
-     * @param[in] outputSize
-     *     This is the number of bytes to output for the digest.
-     *
-     * @param[in] initialHashValues
-     *     These are the initial values to set for the digest.
-     *
-     * @return
-     *     The SHA-384 or SHA-512 message digest of the given data is returned
-     *     as a vector of bytes.
-     */
-    std::vector< uint8_t > Sha386or512or512t(
-        const std::vector< uint8_t >& data,
-        size_t outputSize,
-        const std::vector< uint64_t >& initialHashValues
-    ) {
-        // This a straightforward implementation of the pseudocode
-        // found in the Wikipedia page for SHA-2
-        // (https://en.wikipedia.org/wiki/SHA-2).
-        uint8_t chunk[128];
-        uint64_t w[80];
-        uint64_t h0 = initialHashValues[0];
-        uint64_t h1 = initialHashValues[1];
-        uint64_t h2 = initialHashValues[2];
-        uint64_t h3 = initialHashValues[3];
-        uint64_t h4 = initialHashValues[4];
-        uint64_t h5 = initialHashValues[5];
-        uint64_t h6 = initialHashValues[6];
-        uint64_t h7 = initialHashValues[7];
-        static const uint64_t k[80] = {
+        const uint64_t K512[80] = {
             0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc, 0x3956c25bf348b538,
             0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242, 0x12835b0145706fbe,
             0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2, 0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
@@ -286,273 +515,471 @@ namespace {
             0x113f9804bef90dae, 0x1b710b35131c471b, 0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
             0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817
         };
-        uint64_t ml = (uint64_t)data.size() * 8;
-        for (size_t offset = 0; offset < data.size() + 17; offset += 128) {
-            if (offset + 128 <= data.size()) {
-                (void)memcpy(chunk, &data[offset], 128);
-            } else {
-                (void)memset(chunk, 0, 128);
-                if (offset < data.size()) {
-                    (void)memcpy(chunk, &data[offset], data.size() - offset);
-                }
-                if (offset <= data.size()) {
-                    chunk[data.size() - offset] = 0x80;
+
+        void Sha256CompressScalar(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            uint32_t w[16];
+            uint32_t v[8];
+            for (; numBlocks > 0; --numBlocks, blocks += 64) {
+                for (size_t i = 0; i < 16; ++i) {
+                    w[i] = (
+                        ((uint32_t)blocks[i * 4 + 0] << 24)
+                        | ((uint32_t)blocks[i * 4 + 1] << 16)
+                        | ((uint32_t)blocks[i * 4 + 2] << 8)
+                        | (uint32_t)blocks[i * 4 + 3]
+                    );
                 }
-                if (offset + 128 - data.size() >= 17) {
-                    chunk[120] = (uint8_t)(ml >> 56);
-                    chunk[121] = (uint8_t)(ml >> 48);
-                    chunk[122] = (uint8_t)(ml >> 40);
-                    chunk[123] = (uint8_t)(ml >> 32);
-                    chunk[124] = (uint8_t)(ml >> 24);
-                    chunk[125] = (uint8_t)(ml >> 16);
-                    chunk[126] = (uint8_t)(ml >> 8);
-                    chunk[127] = (uint8_t)ml;
+                (void)memcpy(v, state, sizeof(v));
+                Sha256EightRounds< 0 >(v, w);
+                Sha256EightRounds< 8 >(v, w);
+                Sha256EightRounds< 16 >(v, w);
+                Sha256EightRounds< 24 >(v, w);
+                Sha256EightRounds< 32 >(v, w);
+                Sha256EightRounds< 40 >(v, w);
+                Sha256EightRounds< 48 >(v, w);
+                Sha256EightRounds< 56 >(v, w);
+                for (size_t i = 0; i < 8; ++i) {
+                    state[i] += v[i];
                 }
             }
-            for (size_t i = 0; i < 16; ++i) {
-                w[i] = (
-                    ((uint64_t)chunk[i * 8 + 0] << 56)
-                    | ((uint64_t)chunk[i * 8 + 1] << 48)
-                    | ((uint64_t)chunk[i * 8 + 2] << 40)
-                    | ((uint64_t)chunk[i * 8 + 3] << 32)
-                    | ((uint64_t)chunk[i * 8 + 4] << 24)
-                    | ((uint64_t)chunk[i * 8 + 5] << 16)
-                    | ((uint64_t)chunk[i * 8 + 6] << 8)
-                    | (uint64_t)chunk[i * 8 + 7]
-                );
+        }
+
+        void Sha512CompressScalar(
+            uint64_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            uint64_t w[16];
+            uint64_t v[8];
+            for (; numBlocks > 0; --numBlocks, blocks += 128) {
+                for (size_t i = 0; i < 16; ++i) {
+                    w[i] = (
+                        ((uint64_t)blocks[i * 8 + 0] << 56)
+                        | ((uint64_t)blocks[i * 8 + 1] << 48)
+                        | ((uint64_t)blocks[i * 8 + 2] << 40)
+                        | ((uint64_t)blocks[i * 8 + 3] << 32)
+                        | ((uint64_t)blocks[i * 8 + 4] << 24)
+                        | ((uint64_t)blocks[i * 8 + 5] << 16)
+                        | ((uint64_t)blocks[i * 8 + 6] << 8)
+                        | (uint64_t)blocks[i * 8 + 7]
+                    );
+                }
+                (void)memcpy(v, state, sizeof(v));
+                Sha512EightRounds< 0 >(v, w);
+                Sha512EightRounds< 8 >(v, w);
+                Sha512EightRounds< 16 >(v, w);
+                Sha512EightRounds< 24 >(v, w);
+                Sha512EightRounds< 32 >(v, w);
+                Sha512EightRounds< 40 >(v, w);
+                Sha512EightRounds< 48 >(v, w);
+                Sha512EightRounds< 56 >(v, w);
+                Sha512EightRounds< 64 >(v, w);
+                Sha512EightRounds< 72 >(v, w);
+                for (size_t i = 0; i < 8; ++i) {
+                    state[i] += v[i];
+                }
             }
-            for (size_t i = 16; i < 80; ++i) {
-                w[i] = (
-                    w[i - 16]
-                    + (
-                        Rot(w[i - 15], 1) ^ Rot(w[i - 15], 8) ^ (w[i - 15] >> 7)
-                    ) // s0
-                    + w[i - 7]
-                    + (
-                        Rot(w[i - 2], 19) ^ Rot(w[i - 2], 61) ^ (w[i - 2] >> 6)
-                    ) // s1
-                );
+        }
+
+        void Sha256Compress(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            static const auto kernel = SelectSha256Kernel();
+            kernel(state, blocks, numBlocks);
+        }
+
+        void Sha512Compress(
+            uint64_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            static const auto kernel = SelectSha512Kernel();
+            kernel(state, blocks, numBlocks);
+        }
+
+    }
+
+    Sha256Context::Sha256Context()
+        : Sha256Context(Internal::Sha256InitialHashValues, SHA256_DIGEST_LENGTH / 8)
+    {
+    }
+
+    Sha256Context::Sha256Context(
+        const uint32_t* initialHashValues,
+        size_t digestSize
+    )
+        : digestSize_(digestSize)
+    {
+        (void)memcpy(initialHashValues_, initialHashValues, sizeof(initialHashValues_));
+        Reset();
+    }
+
+    void Sha256Context::Reset() {
+        (void)memcpy(state_, initialHashValues_, sizeof(state_));
+        bufferLength_ = 0;
+        messageLength_ = 0;
+    }
+
+    void Sha256Context::Update(const void* data, size_t length) {
+        messageLength_ += length;
+        Internal::AbsorbData< SHA256_BLOCK_SIZE >(
+            buffer_,
+            bufferLength_,
+            (const uint8_t*)data,
+            length,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Internal::Sha256Compress(state_, blocks, numBlocks);
             }
-            uint64_t a = h0;
-            uint64_t b = h1;
-            uint64_t c = h2;
-            uint64_t d = h3;
-            uint64_t e = h4;
-            uint64_t f = h5;
-            uint64_t g = h6;
-            uint64_t h = h7;
-            for (size_t i = 0; i < 80; ++i) {
-                const auto t1 = (
-                    h + (
-                        Rot(e, 14) ^ Rot(e, 18) ^ Rot(e, 41)
-                    ) // S1
-                    + (
-                        (e & f) ^ (~e & g)
-                    ) // ch
-                    + k[i]
-                    + w[i]
-                );
-                const auto t2 = (
-                    (
-                        Rot(a, 28) ^ Rot(a, 34) ^ Rot(a, 39)
-                    ) // S0
-                    + (
-                        (a & b) ^ (a & c) ^ (b & c)
-                    ) // maj
-                );
-                h = g;
-                g = f;
-                f = e;
-                e = d + t1;
-                d = c;
-                c = b;
-                b = a;
-                a = t1 + t2;
+        );
+    }
+
+    void Sha256Context::Update(const std::vector< uint8_t >& data) {
+        Update(data.data(), data.size());
+    }
+
+    std::vector< uint8_t > Sha256Context::Final() {
+        std::vector< uint8_t > digest(digestSize_);
+        Final(digest.data());
+        return digest;
+    }
+
+    void Sha256Context::Final(uint8_t* digest) {
+        Internal::PadAndCompress< SHA256_BLOCK_SIZE, 8, true >(
+            buffer_,
+            bufferLength_,
+            messageLength_,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Internal::Sha256Compress(state_, blocks, numBlocks);
             }
-            h0 += a;
-            h1 += b;
-            h2 += c;
-            h3 += d;
-            h4 += e;
-            h5 += f;
-            h6 += g;
-            h7 += h;
+        );
+        for (size_t i = 0; i < digestSize_; ++i) {
+            digest[i] = (uint8_t)(state_[i / 4] >> (24 - (i % 4) * 8));
         }
-        std::vector< uint8_t > digest{
-            (uint8_t)((h0 >> 56) & 0xff),
-            (uint8_t)((h0 >> 48) & 0xff),
-            (uint8_t)((h0 >> 40) & 0xff),
-            (uint8_t)((h0 >> 32) & 0xff),
-            (uint8_t)((h0 >> 24) & 0xff),
-            (uint8_t)((h0 >> 16) & 0xff),
-            (uint8_t)((h0 >> 8) & 0xff),
-            (uint8_t)(h0 & 0xff),
-            (uint8_t)((h1 >> 56) & 0xff),
-            (uint8_t)((h1 >> 48) & 0xff),
-            (uint8_t)((h1 >> 40) & 0xff),
-            (uint8_t)((h1 >> 32) & 0xff),
-            (uint8_t)((h1 >> 24) & 0xff),
-            (uint8_t)((h1 >> 16) & 0xff),
-            (uint8_t)((h1 >> 8) & 0xff),
-            (uint8_t)(h1 & 0xff),
-            (uint8_t)((h2 >> 56) & 0xff),
-            (uint8_t)((h2 >> 48) & 0xff),
-            (uint8_t)((h2 >> 40) & 0xff),
-            (uint8_t)((h2 >> 32) & 0xff),
-            (uint8_t)((h2 >> 24) & 0xff),
-            (uint8_t)((h2 >> 16) & 0xff),
-            (uint8_t)((h2 >> 8) & 0xff),
-            (uint8_t)(h2 & 0xff),
-            (uint8_t)((h3 >> 56) & 0xff),
-            (uint8_t)((h3 >> 48) & 0xff),
-            (uint8_t)((h3 >> 40) & 0xff),
-            (uint8_t)((h3 >> 32) & 0xff),
-            (uint8_t)((h3 >> 24) & 0xff),
-            (uint8_t)((h3 >> 16) & 0xff),
-            (uint8_t)((h3 >> 8) & 0xff),
-            (uint8_t)(h3 & 0xff),
-            (uint8_t)((h4 >> 56) & 0xff),
-            (uint8_t)((h4 >> 48) & 0xff),
-            (uint8_t)((h4 >> 40) & 0xff),
-            (uint8_t)((h4 >> 32) & 0xff),
-            (uint8_t)((h4 >> 24) & 0xff),
-            (uint8_t)((h4 >> 16) & 0xff),
-            (uint8_t)((h4 >> 8) & 0xff),
-            (uint8_t)(h4 & 0xff),
-            (uint8_t)((h5 >> 56) & 0xff),
-            (uint8_t)((h5 >> 48) & 0xff),
-            (uint8_t)((h5 >> 40) & 0xff),
-            (uint8_t)((h5 >> 32) & 0xff),
-            (uint8_t)((h5 >> 24) & 0xff),
-            (uint8_t)((h5 >> 16) & 0xff),
-            (uint8_t)((h5 >> 8) & 0xff),
-            (uint8_t)(h5 & 0xff),
-            (uint8_t)((h6 >> 56) & 0xff),
-            (uint8_t)((h6 >> 48) & 0xff),
-            (uint8_t)((h6 >> 40) & 0xff),
-            (uint8_t)((h6 >> 32) & 0xff),
-            (uint8_t)((h6 >> 24) & 0xff),
-            (uint8_t)((h6 >> 16) & 0xff),
-            (uint8_t)((h6 >> 8) & 0xff),
-            (uint8_t)(h6 & 0xff),
-            (uint8_t)((h7 >> 56) & 0xff),
-            (uint8_t)((h7 >> 48) & 0xff),
-            (uint8_t)((h7 >> 40) & 0xff),
-            (uint8_t)((h7 >> 32) & 0xff),
-            (uint8_t)((h7 >> 24) & 0xff),
-            (uint8_t)((h7 >> 16) & 0xff),
-            (uint8_t)((h7 >> 8) & 0xff),
-            (uint8_t)(h7 & 0xff)
-        };
-        digest.resize(outputSize);
+        Reset();
+    }
+
+    Sha224Context::Sha224Context()
+        : Sha256Context(SHA224_INITIAL_HASH_VALUES, SHA224_DIGEST_LENGTH / 8)
+    {
+    }
+
+    Sha512Context::Sha512Context()
+        : Sha512Context(Internal::Sha512InitialHashValues, SHA512_DIGEST_LENGTH / 8)
+    {
+    }
+
+    Sha512Context::Sha512Context(
+        const uint64_t* initialHashValues,
+        size_t digestSize
+    )
+        : digestSize_(digestSize)
+    {
+        (void)memcpy(initialHashValues_, initialHashValues, sizeof(initialHashValues_));
+        Reset();
+    }
+
+    void Sha512Context::Reset() {
+        (void)memcpy(state_, initialHashValues_, sizeof(state_));
+        bufferLength_ = 0;
+        messageLength_ = 0;
+    }
+
+    void Sha512Context::Update(const void* data, size_t length) {
+        messageLength_ += length;
+        Internal::AbsorbData< SHA512_BLOCK_SIZE >(
+            buffer_,
+            bufferLength_,
+            (const uint8_t*)data,
+            length,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Internal::Sha512Compress(state_, blocks, numBlocks);
+            }
+        );
+    }
+
+    void Sha512Context::Update(const std::vector< uint8_t >& data) {
+        Update(data.data(), data.size());
+    }
+
+    std::vector< uint8_t > Sha512Context::Final() {
+        std::vector< uint8_t > digest(digestSize_);
+        Final(digest.data());
         return digest;
     }
 
-    /**
-     * This function evaluates a modified SHA-512 on the given string, to be
-     * used to generate the initial hash values for SHA-512/t hash functions.
-     *
-     * @param[in] data
-     *     This is the string for which to evaluate the modified SHA-512.
-     *
-     * @return
-     *     The initial hash values for the SHA-512/t hash function matching
-     *     the given data is returned.
-     */
-    std::vector< uint64_t > Sha512IV(const std::string& data) {
-        const auto digest = Sha386or512or512t(
-            std::vector< uint8_t >{
-                data.begin(),
-                data.end()
-            },
-            64,
-            {
-                0x6a09e667f3bcc908 ^ 0xa5a5a5a5a5a5a5a5,
-                0xbb67ae8584caa73b ^ 0xa5a5a5a5a5a5a5a5,
-                0x3c6ef372fe94f82b ^ 0xa5a5a5a5a5a5a5a5,
-                0xa54ff53a5f1d36f1 ^ 0xa5a5a5a5a5a5a5a5,
-                0x510e527fade682d1 ^ 0xa5a5a5a5a5a5a5a5,
-                0x9b05688c2b3e6c1f ^ 0xa5a5a5a5a5a5a5a5,
-                0x1f83d9abfb41bd6b ^ 0xa5a5a5a5a5a5a5a5,
-                0x5be0cd19137e2179 ^ 0xa5a5a5a5a5a5a5a5
+    void Sha512Context::Final(uint8_t* digest) {
+        Internal::PadAndCompress< SHA512_BLOCK_SIZE, 16, true >(
+            buffer_,
+            bufferLength_,
+            messageLength_,
+            [this](const uint8_t* blocks, size_t numBlocks){
+                Internal::Sha512Compress(state_, blocks, numBlocks);
             }
         );
-        std::vector< uint64_t > h;
-        for (size_t i = 0; i < 8; ++i) {
-            h.push_back(
-                ((uint64_t)digest[i * 8 + 0] << 56)
-                | ((uint64_t)digest[i * 8 + 1] << 48)
-                | ((uint64_t)digest[i * 8 + 2] << 40)
-                | ((uint64_t)digest[i * 8 + 3] << 32)
-                | ((uint64_t)digest[i * 8 + 4] << 24)
-                | ((uint64_t)digest[i * 8 + 5] << 16)
-                | ((uint64_t)digest[i * 8 + 6] << 8)
-                | (uint64_t)digest[i * 8 + 7]
-            );
-        };
-        return h;
+        for (size_t i = 0; i < digestSize_; ++i) {
+            digest[i] = (uint8_t)(state_[i / 8] >> (56 - (i % 8) * 8));
+        }
+        Reset();
     }
 
-}
+    Sha384Context::Sha384Context()
+        : Sha512Context(SHA384_INITIAL_HASH_VALUES, SHA384_DIGEST_LENGTH / 8)
+    {
+    }
 
-namespace Hash {
+    Sha512t224Context::Sha512t224Context()
+        : Sha512Context(Sha512t224InitialHashValues(), SHA512T224_DIGEST_LENGTH / 8)
+    {
+    }
+
+    Sha512t256Context::Sha512t256Context()
+        : Sha512Context(Sha512t256InitialHashValues(), SHA512T256_DIGEST_LENGTH / 8)
+    {
+    }
 
     std::vector< uint8_t > Sha224(const std::vector< uint8_t >& data) {
-        return Sha224or256(data, true);
+        std::vector< uint8_t > digest(SHA224_DIGEST_LENGTH / 8);
+        ComputeSha224(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeSha224(const void* data, size_t length, uint8_t* digest) {
+        Sha224Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Sha224Digest ComputeSha224(const void* data, size_t length) {
+        Sha224Digest digest;
+        ComputeSha224(data, length, digest.data());
+        return digest;
     }
 
     std::vector< uint8_t > Sha256(const std::vector< uint8_t >& data) {
-        return Sha224or256(data, false);
+        std::vector< uint8_t > digest(SHA256_DIGEST_LENGTH / 8);
+        ComputeSha256(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeSha256(const void* data, size_t length, uint8_t* digest) {
+        Sha256Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Sha256Digest ComputeSha256(const void* data, size_t length) {
+        Sha256Digest digest;
+        ComputeSha256(data, length, digest.data());
+        return digest;
     }
 
     std::vector< uint8_t > Sha384(const std::vector< uint8_t >& data) {
-        return Sha386or512or512t(
-            data,
-            48,
-            {
-                0xcbbb9d5dc1059ed8,
-                0x629a292a367cd507,
-                0x9159015a3070dd17,
-                0x152fecd8f70e5939,
-                0x67332667ffc00b31,
-                0x8eb44a8768581511,
-                0xdb0c2e0d64f98fa7,
-                0x47b5481dbefa4fa4
-            }
-        );
+        std::vector< uint8_t > digest(SHA384_DIGEST_LENGTH / 8);
+        ComputeSha384(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeSha384(const void* data, size_t length, uint8_t* digest) {
+        Sha384Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Sha384Digest ComputeSha384(const void* data, size_t length) {
+        Sha384Digest digest;
+        ComputeSha384(data, length, digest.data());
+        return digest;
     }
 
     std::vector< uint8_t > Sha512t224(const std::vector< uint8_t >& data) {
-        return Sha386or512or512t(
-            data,
-            28,
-            Sha512IV("SHA-512/224")
-        );
+        std::vector< uint8_t > digest(SHA512T224_DIGEST_LENGTH / 8);
+        ComputeSha512t224(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeSha512t224(const void* data, size_t length, uint8_t* digest) {
+        Sha512t224Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Sha512t224Digest ComputeSha512t224(const void* data, size_t length) {
+        Sha512t224Digest digest;
+        ComputeSha512t224(data, length, digest.data());
+        return digest;
     }
 
     std::vector< uint8_t > Sha512t256(const std::vector< uint8_t >& data) {
-        return Sha386or512or512t(
-            data,
-            32,
-            Sha512IV("SHA-512/256")
-        );
+        std::vector< uint8_t > digest(SHA512T256_DIGEST_LENGTH / 8);
+        ComputeSha512t256(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeSha512t256(const void* data, size_t length, uint8_t* digest) {
+        Sha512t256Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Sha512t256Digest ComputeSha512t256(const void* data, size_t length) {
+        Sha512t256Digest digest;
+        ComputeSha512t256(data, length, digest.data());
+        return digest;
     }
 
     std::vector< uint8_t > Sha512(const std::vector< uint8_t >& data) {
-        return Sha386or512or512t(
-            data,
-            64,
-            {
-                0x6a09e667f3bcc908,
-                0xbb67ae8584caa73b,
-                0x3c6ef372fe94f82b,
-                0xa54ff53a5f1d36f1,
-                0x510e527fade682d1,
-                0x9b05688c2b3e6c1f,
-                0x1f83d9abfb41bd6b,
-                0x5be0cd19137e2179
-            }
+        std::vector< uint8_t > digest(SHA512_DIGEST_LENGTH / 8);
+        ComputeSha512(data.data(), data.size(), digest.data());
+        return digest;
+    }
+
+    void ComputeSha512(const void* data, size_t length, uint8_t* digest) {
+        Sha512Context context;
+        context.Update(data, length);
+        context.Final(digest);
+    }
+
+    Sha512Digest ComputeSha512(const void* data, size_t length) {
+        Sha512Digest digest;
+        ComputeSha512(data, length, digest.data());
+        return digest;
+    }
+
+    void Sha256Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    ) {
+#if HASH_TARGET_X86
+        // The SHA extensions compress a single message faster than AVX2
+        // compresses eight, so the multi-buffer kernel is only used on
+        // CPUs without them.
+        const auto& features = Internal::GetCpuFeatures();
+        if (
+            features.avx2
+            && !features.sha
+        ) {
+            Internal::HashInLanes< uint32_t, 8, 8, SHA256_BLOCK_SIZE, 8, true >(
+                messages,
+                lengths,
+                numMessages,
+                Internal::Sha256InitialHashValues,
+                digests,
+                SHA256_DIGEST_LENGTH / 8,
+                Internal::Sha256CompressAvx2x8
+            );
+            return;
+        }
+#endif
+        Internal::HashOneAtATime< uint32_t, 8, SHA256_BLOCK_SIZE, 8, true >(
+            messages,
+            lengths,
+            numMessages,
+            Internal::Sha256InitialHashValues,
+            digests,
+            SHA256_DIGEST_LENGTH / 8,
+            Internal::Sha256Compress
+        );
+    }
+
+    std::vector< uint8_t > Sha256Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    ) {
+        return Internal::BatchVectors(messages, SHA256_DIGEST_LENGTH / 8, Sha256Batch);
+    }
+
+    void Sha384Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    ) {
+        Sha512FamilyBatch(
+            messages,
+            lengths,
+            numMessages,
+            SHA384_INITIAL_HASH_VALUES,
+            digests,
+            SHA384_DIGEST_LENGTH / 8
+        );
+    }
+
+    std::vector< uint8_t > Sha384Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    ) {
+        return Internal::BatchVectors(messages, SHA384_DIGEST_LENGTH / 8, Sha384Batch);
+    }
+
+    void Sha512Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    ) {
+        Sha512FamilyBatch(
+            messages,
+            lengths,
+            numMessages,
+            Internal::Sha512InitialHashValues,
+            digests,
+            SHA512_DIGEST_LENGTH / 8
+        );
+    }
+
+    std::vector< uint8_t > Sha512Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    ) {
+        return Internal::BatchVectors(messages, SHA512_DIGEST_LENGTH / 8, Sha512Batch);
+    }
+
+    void Sha512t224Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    ) {
+        Sha512FamilyBatch(
+            messages,
+            lengths,
+            numMessages,
+            Sha512t224InitialHashValues(),
+            digests,
+            SHA512T224_DIGEST_LENGTH / 8
+        );
+    }
+
+    std::vector< uint8_t > Sha512t224Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    ) {
+        return Internal::BatchVectors(messages, SHA512T224_DIGEST_LENGTH / 8, Sha512t224Batch);
+    }
+
+    void Sha512t256Batch(
+        const uint8_t* const* messages,
+        const size_t* lengths,
+        size_t numMessages,
+        uint8_t* digests
+    ) {
+        Sha512FamilyBatch(
+            messages,
+            lengths,
+            numMessages,
+            Sha512t256InitialHashValues(),
+            digests,
+            SHA512T256_DIGEST_LENGTH / 8
         );
     }
 
+    std::vector< uint8_t > Sha512t256Batch(
+        const std::vector< std::vector< uint8_t > >& messages
+    ) {
+        return Internal::BatchVectors(messages, SHA512T256_DIGEST_LENGTH / 8, Sha512t256Batch);
+    }
+
 }
@@ -0,0 +1,273 @@
+/**
+ * @file Sha256Avx2.cpp
+ *
+ * This module contains the implementation of the single-buffer SHA-256
+ * block compression kernel which uses AVX2 to compute the message schedules
+ * of two blocks at once, and BMI2 rotates (RORX) in the rounds.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha2Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function rotates the given argument right by the given number
+     * of bits.  With BMI2 enabled, this compiles to a single RORX, which
+     * doesn't overwrite its source or touch the flags.
+     *
+     * @param[in] x
+     *     This is the argument to rotate.
+     *
+     * @return
+     *     The rotated argument is returned.
+     */
+    template< int bits > inline uint32_t Rot(uint32_t x) {
+        return (x >> bits) | (x << (32 - bits));
+    }
+
+    /**
+     * This function rotates each 32-bit element of the given vector right
+     * by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the vector whose elements to rotate.
+     *
+     * @return
+     *     The rotated vector is returned.
+     */
+    template< int bits > inline __m256i Rot(__m256i x) {
+        return _mm256_or_si256(
+            _mm256_srli_epi32(x, bits),
+            _mm256_slli_epi32(x, 32 - bits)
+        );
+    }
+
+    /**
+     * This function computes the SHA-256 message schedule function s0
+     * on each 32-bit element of the given vector.
+     *
+     * @param[in] x
+     *     This is the vector on which to compute s0.
+     *
+     * @return
+     *     The result is returned.
+     */
+    inline __m256i SmallSigma0(__m256i x) {
+        return _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 7 >(x), Rot< 18 >(x)),
+            _mm256_srli_epi32(x, 3)
+        );
+    }
+
+    /**
+     * This function computes the SHA-256 message schedule function s1
+     * on each 32-bit element of the given vector.
+     *
+     * @param[in] x
+     *     This is the vector on which to compute s1.
+     *
+     * @return
+     *     The result is returned.
+     */
+    inline __m256i SmallSigma1(__m256i x) {
+        return _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 17 >(x), Rot< 19 >(x)),
+            _mm256_srli_epi32(x, 10)
+        );
+    }
+
+    /**
+     * This function computes the next four message schedule words, given
+     * the previous sixteen, independently in each 128-bit half of the
+     * vectors (one half per block).
+     *
+     * @param[in] x0
+     *     These are message schedule words t-16 through t-13.
+     *
+     * @param[in] x1
+     *     These are message schedule words t-12 through t-9.
+     *
+     * @param[in] x2
+     *     These are message schedule words t-8 through t-5.
+     *
+     * @param[in] x3
+     *     These are message schedule words t-4 through t-1.
+     *
+     * @return
+     *     Message schedule words t through t+3 are returned.
+     */
+    inline __m256i Schedule(__m256i x0, __m256i x1, __m256i x2, __m256i x3) {
+        const auto w15 = _mm256_alignr_epi8(x1, x0, 4);
+        const auto w7 = _mm256_alignr_epi8(x3, x2, 4);
+        auto next = _mm256_add_epi32(
+            _mm256_add_epi32(x0, SmallSigma0(w15)),
+            w7
+        );
+
+        // Words t and t+1 depend on words t-2 and t-1, which are known,
+        // but words t+2 and t+3 depend on words t and t+1, so s1 is
+        // added in two steps.
+        next = _mm256_add_epi32(next, _mm256_srli_si256(SmallSigma1(x3), 8));
+        return _mm256_add_epi32(next, _mm256_slli_si256(SmallSigma1(next), 8));
+    }
+
+    /**
+     * This function performs one round of SHA-256.  Rather than shifting
+     * every working variable, the caller rotates the order in which it
+     * passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D, which becomes working variable E
+     *     for the next round.
+     *
+     * @param[in] e
+     *     This is working variable E.
+     *
+     * @param[in] f
+     *     This is working variable F.
+     *
+     * @param[in] g
+     *     This is working variable G.
+     *
+     * @param[in,out] h
+     *     This is working variable H, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in] kw
+     *     This is the sum of the round constant and message schedule word
+     *     for the round.
+     */
+    inline void Round(
+        uint32_t a, uint32_t b, uint32_t c, uint32_t& d,
+        uint32_t e, uint32_t f, uint32_t g, uint32_t& h,
+        uint32_t kw
+    ) {
+        const auto t1 = (
+            h
+            + (Rot< 6 >(e) ^ Rot< 11 >(e) ^ Rot< 25 >(e))
+            + ((e & f) ^ (~e & g))
+            + kw
+        );
+        const auto t2 = (
+            (Rot< 2 >(a) ^ Rot< 13 >(a) ^ Rot< 22 >(a))
+            + ((a & b) | (c & (a | b)))
+        );
+        d += t1;
+        h = t1 + t2;
+    }
+
+    /**
+     * This function performs the 64 rounds of SHA-256 for one block,
+     * using message schedule words already added to the round constants.
+     *
+     * @param[in,out] state
+     *     These are the eight hash values to update.
+     *
+     * @param[in] kw
+     *     These are the sums of the round constants and message schedule
+     *     words, in groups of four, with the groups of each block
+     *     interleaved with those of the other block.
+     */
+    inline void Rounds(uint32_t* state, const uint32_t* kw) {
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (size_t i = 0; i < 64; i += 8, kw += 16) {
+            Round(a, b, c, d, e, f, g, h, kw[0]);
+            Round(h, a, b, c, d, e, f, g, kw[1]);
+            Round(g, h, a, b, c, d, e, f, kw[2]);
+            Round(f, g, h, a, b, c, d, e, kw[3]);
+            Round(e, f, g, h, a, b, c, d, kw[8]);
+            Round(d, e, f, g, h, a, b, c, kw[9]);
+            Round(c, d, e, f, g, h, a, b, kw[10]);
+            Round(b, c, d, e, f, g, h, a, kw[11]);
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Sha256CompressAvx2(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            const auto byteSwap = _mm256_setr_epi8(
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+            );
+            alignas(32) uint32_t kw[64 * 2];
+            while (numBlocks > 0) {
+                // The schedule of the second block is computed alongside
+                // that of the first; with only one block left, it's the
+                // same block twice and the second half is ignored.
+                const auto second = (numBlocks > 1 ? blocks + 64 : blocks);
+                __m256i x[4];
+                for (size_t i = 0; i < 4; ++i) {
+                    x[i] = _mm256_shuffle_epi8(
+                        _mm256_inserti128_si256(
+                            _mm256_castsi128_si256(
+                                _mm_loadu_si128((const __m128i*)(blocks + i * 16))
+                            ),
+                            _mm_loadu_si128((const __m128i*)(second + i * 16)),
+                            1
+                        ),
+                        byteSwap
+                    );
+                }
+                for (size_t i = 0; i < 16; ++i) {
+                    if (i >= 4) {
+                        x[i & 3] = Schedule(
+                            x[i & 3],
+                            x[(i + 1) & 3],
+                            x[(i + 2) & 3],
+                            x[(i + 3) & 3]
+                        );
+                    }
+                    _mm256_store_si256(
+                        (__m256i*)(kw + i * 8),
+                        _mm256_add_epi32(
+                            x[i & 3],
+                            _mm256_broadcastsi128_si256(
+                                _mm_loadu_si128((const __m128i*)(K256 + i * 4))
+                            )
+                        )
+                    );
+                }
+                Rounds(state, kw);
+                if (numBlocks > 1) {
+                    Rounds(state, kw + 4);
+                    blocks += 128;
+                    numBlocks -= 2;
+                } else {
+                    blocks += 64;
+                    numBlocks -= 1;
+                }
+            }
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
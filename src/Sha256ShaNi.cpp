@@ -0,0 +1,156 @@
+/**
+ * @file Sha256ShaNi.cpp
+ *
+ * This module contains the implementation of the SHA-256 block compression
+ * kernel which uses the Intel SHA extensions.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha2Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function performs four rounds of SHA-256 on the given state,
+     * using the given four message schedule words.
+     *
+     * @param[in,out] abef
+     *     These are the working variables A, B, E, and F.
+     *
+     * @param[in,out] cdgh
+     *     These are the working variables C, D, G, and H.
+     *
+     * @param[in] w
+     *     These are the four message schedule words for the rounds.
+     *
+     * @param[in] group
+     *     This is the index of the group of four rounds to perform,
+     *     used to select the round constants.
+     */
+    inline void FourRounds(
+        __m128i& abef,
+        __m128i& cdgh,
+        __m128i w,
+        size_t group
+    ) {
+        w = _mm_add_epi32(
+            w,
+            _mm_loadu_si128((const __m128i*)&Hash::Internal::K256[group * 4])
+        );
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, w);
+        w = _mm_shuffle_epi32(w, 0x0E);
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, w);
+    }
+
+    /**
+     * This function completes the computation of the next four message
+     * schedule words, given the current and previous four words.
+     *
+     * @param[in] next
+     *     These are the next four message schedule words, partially
+     *     computed by the SHA256MSG1 instruction.
+     *
+     * @param[in] current
+     *     These are the current four message schedule words.
+     *
+     * @param[in] previous
+     *     These are the previous four message schedule words.
+     *
+     * @return
+     *     The next four message schedule words are returned.
+     */
+    inline __m128i Schedule(
+        __m128i next,
+        __m128i current,
+        __m128i previous
+    ) {
+        next = _mm_add_epi32(next, _mm_alignr_epi8(current, previous, 4));
+        return _mm_sha256msg2_epu32(next, current);
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Sha256CompressShaNi(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            // The SHA extensions keep the working variables in two
+            // registers, one holding A, B, E, and F, and the other holding
+            // C, D, G, and H, so the hash values are rearranged into that
+            // form first, and back again at the end.
+            const __m128i byteSwap = _mm_set_epi64x(
+                0x0c0d0e0f08090a0bULL,
+                0x0405060700010203ULL
+            );
+            auto cdab = _mm_shuffle_epi32(
+                _mm_loadu_si128((const __m128i*)&state[0]),
+                0xB1
+            );
+            auto cdgh = _mm_shuffle_epi32(
+                _mm_loadu_si128((const __m128i*)&state[4]),
+                0x1B
+            );
+            auto abef = _mm_alignr_epi8(cdab, cdgh, 8);
+            cdgh = _mm_blend_epi16(cdgh, cdab, 0xF0);
+            for (; numBlocks > 0; --numBlocks, blocks += 64) {
+                const auto abefSaved = abef;
+                const auto cdghSaved = cdgh;
+                auto w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 0)), byteSwap);
+                auto w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 16)), byteSwap);
+                auto w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 32)), byteSwap);
+                auto w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(blocks + 48)), byteSwap);
+                FourRounds(abef, cdgh, w0, 0);
+                FourRounds(abef, cdgh, w1, 1);
+                w0 = _mm_sha256msg1_epu32(w0, w1);
+                FourRounds(abef, cdgh, w2, 2);
+                w1 = _mm_sha256msg1_epu32(w1, w2);
+                FourRounds(abef, cdgh, w3, 3);
+                w0 = Schedule(w0, w3, w2);
+                w2 = _mm_sha256msg1_epu32(w2, w3);
+                for (size_t group = 4; group < 12; group += 4) {
+                    FourRounds(abef, cdgh, w0, group);
+                    w1 = Schedule(w1, w0, w3);
+                    w3 = _mm_sha256msg1_epu32(w3, w0);
+                    FourRounds(abef, cdgh, w1, group + 1);
+                    w2 = Schedule(w2, w1, w0);
+                    w0 = _mm_sha256msg1_epu32(w0, w1);
+                    FourRounds(abef, cdgh, w2, group + 2);
+                    w3 = Schedule(w3, w2, w1);
+                    w1 = _mm_sha256msg1_epu32(w1, w2);
+                    FourRounds(abef, cdgh, w3, group + 3);
+                    w0 = Schedule(w0, w3, w2);
+                    w2 = _mm_sha256msg1_epu32(w2, w3);
+                }
+                FourRounds(abef, cdgh, w0, 12);
+                w1 = Schedule(w1, w0, w3);
+                w3 = _mm_sha256msg1_epu32(w3, w0);
+                FourRounds(abef, cdgh, w1, 13);
+                w2 = Schedule(w2, w1, w0);
+                FourRounds(abef, cdgh, w2, 14);
+                w3 = Schedule(w3, w2, w1);
+                FourRounds(abef, cdgh, w3, 15);
+                abef = _mm_add_epi32(abef, abefSaved);
+                cdgh = _mm_add_epi32(cdgh, cdghSaved);
+            }
+            const auto feba = _mm_shuffle_epi32(abef, 0x1B);
+            const auto dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+            _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(feba, dchg, 0xF0));
+            _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(dchg, feba, 8));
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
@@ -0,0 +1,226 @@
+/**
+ * @file Sha256x8Avx2.cpp
+ *
+ * This module contains the implementation of the multi-buffer SHA-256
+ * block compression kernel which uses AVX2 to compress one block of each
+ * of eight independent messages at once.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha2Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function rotates each 32-bit element of the given vector right
+     * by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the vector whose elements to rotate.
+     *
+     * @return
+     *     The rotated vector is returned.
+     */
+    template< int bits > inline __m256i Rot(__m256i x) {
+        return _mm256_or_si256(
+            _mm256_srli_epi32(x, bits),
+            _mm256_slli_epi32(x, 32 - bits)
+        );
+    }
+
+    /**
+     * This function performs one round of SHA-256 in all eight lanes.
+     * Rather than shifting every working variable, the caller rotates
+     * the order in which it passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D, which becomes working variable E
+     *     for the next round.
+     *
+     * @param[in] e
+     *     This is working variable E.
+     *
+     * @param[in] f
+     *     This is working variable F.
+     *
+     * @param[in] g
+     *     This is working variable G.
+     *
+     * @param[in,out] h
+     *     This is working variable H, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in] kw
+     *     This is the sum of the round constant and message schedule word
+     *     for the round.
+     */
+    inline void Round(
+        __m256i a, __m256i b, __m256i c, __m256i& d,
+        __m256i e, __m256i f, __m256i g, __m256i& h,
+        __m256i kw
+    ) {
+        const auto s1 = _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 6 >(e), Rot< 11 >(e)),
+            Rot< 25 >(e)
+        );
+        const auto ch = _mm256_xor_si256(
+            _mm256_and_si256(e, f),
+            _mm256_andnot_si256(e, g)
+        );
+        const auto t1 = _mm256_add_epi32(
+            _mm256_add_epi32(h, s1),
+            _mm256_add_epi32(ch, kw)
+        );
+        const auto s0 = _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 2 >(a), Rot< 13 >(a)),
+            Rot< 22 >(a)
+        );
+        const auto maj = _mm256_or_si256(
+            _mm256_and_si256(a, b),
+            _mm256_and_si256(c, _mm256_or_si256(a, b))
+        );
+        d = _mm256_add_epi32(d, t1);
+        h = _mm256_add_epi32(t1, _mm256_add_epi32(s0, maj));
+    }
+
+    /**
+     * This function loads eight consecutive big-endian 32-bit words from
+     * each of eight blocks and transposes them, so that each resulting
+     * vector holds the same word of all eight blocks.
+     *
+     * @param[in] blocks
+     *     These point to the blocks from which to load words.
+     *
+     * @param[in] offset
+     *     This is the offset, in bytes, of the first word to load
+     *     from each block.
+     *
+     * @param[out] w
+     *     This is where to store the eight transposed words.
+     */
+    inline void LoadTransposed(
+        const uint8_t* const* blocks,
+        size_t offset,
+        __m256i* w
+    ) {
+        const auto byteSwap = _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+        );
+        __m256i r[8];
+        for (size_t i = 0; i < 8; ++i) {
+            r[i] = _mm256_loadu_si256((const __m256i*)(blocks[i] + offset));
+        }
+        const auto t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+        const auto t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        const auto t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+        const auto t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        const auto t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+        const auto t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        const auto t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+        const auto t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+        const auto u0 = _mm256_unpacklo_epi64(t0, t2);
+        const auto u1 = _mm256_unpackhi_epi64(t0, t2);
+        const auto u2 = _mm256_unpacklo_epi64(t1, t3);
+        const auto u3 = _mm256_unpackhi_epi64(t1, t3);
+        const auto u4 = _mm256_unpacklo_epi64(t4, t6);
+        const auto u5 = _mm256_unpackhi_epi64(t4, t6);
+        const auto u6 = _mm256_unpacklo_epi64(t5, t7);
+        const auto u7 = _mm256_unpackhi_epi64(t5, t7);
+        w[0] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x20), byteSwap);
+        w[1] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x20), byteSwap);
+        w[2] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x20), byteSwap);
+        w[3] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x20), byteSwap);
+        w[4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x31), byteSwap);
+        w[5] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x31), byteSwap);
+        w[6] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x31), byteSwap);
+        w[7] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x31), byteSwap);
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Sha256CompressAvx2x8(
+            uint32_t* states,
+            const uint8_t* const* blocks
+        ) {
+            __m256i w[16];
+            LoadTransposed(blocks, 0, w);
+            LoadTransposed(blocks, 32, w + 8);
+            auto a = _mm256_loadu_si256((const __m256i*)(states + 0));
+            auto b = _mm256_loadu_si256((const __m256i*)(states + 8));
+            auto c = _mm256_loadu_si256((const __m256i*)(states + 16));
+            auto d = _mm256_loadu_si256((const __m256i*)(states + 24));
+            auto e = _mm256_loadu_si256((const __m256i*)(states + 32));
+            auto f = _mm256_loadu_si256((const __m256i*)(states + 40));
+            auto g = _mm256_loadu_si256((const __m256i*)(states + 48));
+            auto h = _mm256_loadu_si256((const __m256i*)(states + 56));
+            const auto a0 = a, b0 = b, c0 = c, d0 = d;
+            const auto e0 = e, f0 = f, g0 = g, h0 = h;
+            for (size_t i = 0; i < 64; i += 8) {
+                __m256i kw[8];
+                for (size_t j = 0; j < 8; ++j) {
+                    const auto t = (i + j) & 15;
+                    if (i + j >= 16) {
+                        const auto w15 = w[(i + j - 15) & 15];
+                        const auto w2 = w[(i + j - 2) & 15];
+                        const auto s0 = _mm256_xor_si256(
+                            _mm256_xor_si256(Rot< 7 >(w15), Rot< 18 >(w15)),
+                            _mm256_srli_epi32(w15, 3)
+                        );
+                        const auto s1 = _mm256_xor_si256(
+                            _mm256_xor_si256(Rot< 17 >(w2), Rot< 19 >(w2)),
+                            _mm256_srli_epi32(w2, 10)
+                        );
+                        w[t] = _mm256_add_epi32(
+                            _mm256_add_epi32(w[t], s0),
+                            _mm256_add_epi32(w[(i + j - 7) & 15], s1)
+                        );
+                    }
+                    kw[j] = _mm256_add_epi32(
+                        w[t],
+                        _mm256_set1_epi32((int)K256[i + j])
+                    );
+                }
+                Round(a, b, c, d, e, f, g, h, kw[0]);
+                Round(h, a, b, c, d, e, f, g, kw[1]);
+                Round(g, h, a, b, c, d, e, f, kw[2]);
+                Round(f, g, h, a, b, c, d, e, kw[3]);
+                Round(e, f, g, h, a, b, c, d, kw[4]);
+                Round(d, e, f, g, h, a, b, c, kw[5]);
+                Round(c, d, e, f, g, h, a, b, kw[6]);
+                Round(b, c, d, e, f, g, h, a, kw[7]);
+            }
+            _mm256_storeu_si256((__m256i*)(states + 0), _mm256_add_epi32(a, a0));
+            _mm256_storeu_si256((__m256i*)(states + 8), _mm256_add_epi32(b, b0));
+            _mm256_storeu_si256((__m256i*)(states + 16), _mm256_add_epi32(c, c0));
+            _mm256_storeu_si256((__m256i*)(states + 24), _mm256_add_epi32(d, d0));
+            _mm256_storeu_si256((__m256i*)(states + 32), _mm256_add_epi32(e, e0));
+            _mm256_storeu_si256((__m256i*)(states + 40), _mm256_add_epi32(f, f0));
+            _mm256_storeu_si256((__m256i*)(states + 48), _mm256_add_epi32(g, g0));
+            _mm256_storeu_si256((__m256i*)(states + 56), _mm256_add_epi32(h, h0));
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
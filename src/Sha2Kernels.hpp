@@ -0,0 +1,268 @@
+#ifndef HASH_SHA2_KERNELS_HPP
+#define HASH_SHA2_KERNELS_HPP
+
+/**
+ * @file Sha2Kernels.hpp
+ *
+ * This module declares the constants and block compression kernels of the
+ * SHA-2 hash functions.  Each kernel updates the hash values of one message
+ * by compressing one or more whole message blocks into them.  The portable
+ * kernels work everywhere, while the others require optional instruction
+ * set extensions and must only be called if the CPU supports them.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "CpuFeatures.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Hash {
+
+    namespace Internal {
+
+        /**
+         * These are the round constants used by the SHA-224 and SHA-256
+         * hash functions.
+         */
+        extern const uint32_t K256[64];
+
+        /**
+         * These are the round constants used by the SHA-384, SHA-512, and
+         * SHA-512/t hash functions.
+         */
+        extern const uint64_t K512[80];
+
+        /**
+         * This function updates the given SHA-224 or SHA-256 hash values
+         * by compressing the given message blocks into them, using only
+         * portable C++.
+         *
+         * @param[in,out] state
+         *     These are the eight hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 64-byte message blocks to compress.
+         */
+        void Sha256CompressScalar(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+        /**
+         * This function updates the given SHA-384, SHA-512, or SHA-512/t
+         * hash values by compressing the given message blocks into them,
+         * using only portable C++.
+         *
+         * @param[in,out] state
+         *     These are the eight hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 128-byte message blocks to compress.
+         */
+        void Sha512CompressScalar(
+            uint64_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+        /**
+         * These are the initial hash values of the SHA-256 hash function.
+         */
+        extern const uint32_t Sha256InitialHashValues[8];
+
+        /**
+         * These are the initial hash values of the SHA-512 hash function.
+         */
+        extern const uint64_t Sha512InitialHashValues[8];
+
+        /**
+         * This function updates the given SHA-224 or SHA-256 hash values
+         * by compressing the given message blocks into them, using the fastest
+         * kernel supported by the CPU.
+         *
+         * @param[in,out] state
+         *     These are the eight hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 64-byte message blocks to compress.
+         */
+        void Sha256Compress(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+        /**
+         * This function updates the given SHA-384, SHA-512, or SHA-512/t hash
+         * values by compressing the given message blocks into them, using the
+         * fastest kernel supported by the CPU.
+         *
+         * @param[in,out] state
+         *     These are the eight hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 128-byte message blocks to compress.
+         */
+        void Sha512Compress(
+            uint64_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+#if HASH_TARGET_X86
+        /**
+         * This function updates the given SHA-224 or SHA-256 hash values
+         * by compressing the given message blocks into them, using the
+         * Intel SHA extensions.
+         *
+         * @note
+         *     This requires the SHA, SSSE3, and SSE4.1 extensions.
+         *
+         * @param[in,out] state
+         *     These are the eight hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 64-byte message blocks to compress.
+         */
+        void Sha256CompressShaNi(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+        /**
+         * This function updates the given SHA-224 or SHA-256 hash values
+         * by compressing the given message blocks into them, using AVX2 to
+         * compute the message schedules of two blocks at once and BMI2
+         * to rotate in the rounds.
+         *
+         * @note
+         *     This requires the AVX2 and BMI2 extensions.
+         *
+         * @param[in,out] state
+         *     These are the eight hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 64-byte message blocks to compress.
+         */
+        void Sha256CompressAvx2(
+            uint32_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+        /**
+         * This function updates the given SHA-384, SHA-512, or SHA-512/t
+         * hash values by compressing the given message blocks into them,
+         * using AVX2 to compute the message schedule and BMI2 to rotate
+         * in the rounds.
+         *
+         * @note
+         *     This requires the AVX2 and BMI2 extensions.
+         *
+         * @param[in,out] state
+         *     These are the eight hash values to update.
+         *
+         * @param[in] blocks
+         *     This points to the message blocks to compress.
+         *
+         * @param[in] numBlocks
+         *     This is the number of 128-byte message blocks to compress.
+         */
+        void Sha512CompressAvx2(
+            uint64_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        );
+
+        /**
+         * This function updates the SHA-224 or SHA-256 hash values of eight
+         * independent messages by compressing one block of each message
+         * into them, using AVX2.
+         *
+         * @note
+         *     This requires the AVX2 extensions.
+         *
+         * @param[in,out] states
+         *     These are the hash values of the eight messages, stored
+         *     word-major (word i of message j is at index i * 8 + j).
+         *
+         * @param[in] blocks
+         *     These point to the 64-byte message blocks to compress,
+         *     one for each message.
+         */
+        void Sha256CompressAvx2x8(
+            uint32_t* states,
+            const uint8_t* const* blocks
+        );
+
+        /**
+         * This function updates the SHA-384, SHA-512, or SHA-512/t hash
+         * values of four independent messages by compressing one block of
+         * each message into them, using AVX2.
+         *
+         * @note
+         *     This requires the AVX2 extensions.
+         *
+         * @param[in,out] states
+         *     These are the hash values of the four messages, stored
+         *     word-major (word i of message j is at index i * 4 + j).
+         *
+         * @param[in] blocks
+         *     These point to the 128-byte message blocks to compress,
+         *     one for each message.
+         */
+        void Sha512CompressAvx2x4(
+            uint64_t* states,
+            const uint8_t* const* blocks
+        );
+
+        /**
+         * This function updates the SHA-384, SHA-512, or SHA-512/t hash
+         * values of eight independent messages by compressing one block of
+         * each message into them, using AVX-512.
+         *
+         * @note
+         *     This requires the AVX-512 foundation and byte/word
+         *     extensions.
+         *
+         * @param[in,out] states
+         *     These are the hash values of the eight messages, stored
+         *     word-major (word i of message j is at index i * 8 + j).
+         *
+         * @param[in] blocks
+         *     These point to the 128-byte message blocks to compress,
+         *     one for each message.
+         */
+        void Sha512CompressAvx512x8(
+            uint64_t* states,
+            const uint8_t* const* blocks
+        );
+#endif
+
+    }
+
+}
+
+#endif /* HASH_SHA2_KERNELS_HPP */
@@ -0,0 +1,261 @@
+/**
+ * @file Sha512Avx2.cpp
+ *
+ * This module contains the implementation of the single-buffer SHA-512
+ * block compression kernel which uses AVX2 to compute the message schedule
+ * four words at a time, and BMI2 rotates (RORX) in the rounds.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha2Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function rotates the given argument right by the given number
+     * of bits.  With BMI2 enabled, this compiles to a single RORX, which
+     * doesn't overwrite its source or touch the flags.
+     *
+     * @param[in] x
+     *     This is the argument to rotate.
+     *
+     * @return
+     *     The rotated argument is returned.
+     */
+    template< int bits > inline uint64_t Rot(uint64_t x) {
+        return (x >> bits) | (x << (64 - bits));
+    }
+
+    /**
+     * This function rotates each 64-bit element of the given vector right
+     * by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the vector whose elements to rotate.
+     *
+     * @return
+     *     The rotated vector is returned.
+     */
+    template< int bits > inline __m256i Rot(__m256i x) {
+        return _mm256_or_si256(
+            _mm256_srli_epi64(x, bits),
+            _mm256_slli_epi64(x, 64 - bits)
+        );
+    }
+
+    /**
+     * This function computes the SHA-512 message schedule function s0
+     * on each 64-bit element of the given vector.
+     *
+     * @param[in] x
+     *     This is the vector on which to compute s0.
+     *
+     * @return
+     *     The result is returned.
+     */
+    inline __m256i SmallSigma0(__m256i x) {
+        return _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 1 >(x), Rot< 8 >(x)),
+            _mm256_srli_epi64(x, 7)
+        );
+    }
+
+    /**
+     * This function computes the SHA-512 message schedule function s1
+     * on each 64-bit element of the given vector.
+     *
+     * @param[in] x
+     *     This is the vector on which to compute s1.
+     *
+     * @return
+     *     The result is returned.
+     */
+    inline __m256i SmallSigma1(__m256i x) {
+        return _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 19 >(x), Rot< 61 >(x)),
+            _mm256_srli_epi64(x, 6)
+        );
+    }
+
+    /**
+     * This function returns the four 64-bit words which start one word
+     * into the given pair of vectors.
+     *
+     * @param[in] lo
+     *     This vector holds the first four words.
+     *
+     * @param[in] hi
+     *     This vector holds the next four words.
+     *
+     * @return
+     *     Words 1 through 4 of the pair of vectors are returned.
+     */
+    inline __m256i ShiftInOneWord(__m256i lo, __m256i hi) {
+        return _mm256_alignr_epi8(
+            _mm256_permute2x128_si256(lo, hi, 0x21),
+            lo,
+            8
+        );
+    }
+
+    /**
+     * This function computes the next four message schedule words, given
+     * the previous sixteen.
+     *
+     * @param[in] y0
+     *     These are message schedule words t-16 through t-13.
+     *
+     * @param[in] y1
+     *     These are message schedule words t-12 through t-9.
+     *
+     * @param[in] y2
+     *     These are message schedule words t-8 through t-5.
+     *
+     * @param[in] y3
+     *     These are message schedule words t-4 through t-1.
+     *
+     * @return
+     *     Message schedule words t through t+3 are returned.
+     */
+    inline __m256i Schedule(__m256i y0, __m256i y1, __m256i y2, __m256i y3) {
+        auto next = _mm256_add_epi64(
+            _mm256_add_epi64(y0, SmallSigma0(ShiftInOneWord(y0, y1))),
+            ShiftInOneWord(y2, y3)
+        );
+
+        // Words t and t+1 depend on words t-2 and t-1, which are known,
+        // but words t+2 and t+3 depend on words t and t+1, so s1 is
+        // added in two steps.
+        next = _mm256_add_epi64(
+            next,
+            _mm256_permute2x128_si256(SmallSigma1(y3), SmallSigma1(y3), 0x81)
+        );
+        return _mm256_add_epi64(
+            next,
+            _mm256_permute2x128_si256(SmallSigma1(next), SmallSigma1(next), 0x08)
+        );
+    }
+
+    /**
+     * This function performs one round of SHA-512.  Rather than shifting
+     * every working variable, the caller rotates the order in which it
+     * passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D, which becomes working variable E
+     *     for the next round.
+     *
+     * @param[in] e
+     *     This is working variable E.
+     *
+     * @param[in] f
+     *     This is working variable F.
+     *
+     * @param[in] g
+     *     This is working variable G.
+     *
+     * @param[in,out] h
+     *     This is working variable H, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in] kw
+     *     This is the sum of the round constant and message schedule word
+     *     for the round.
+     */
+    inline void Round(
+        uint64_t a, uint64_t b, uint64_t c, uint64_t& d,
+        uint64_t e, uint64_t f, uint64_t g, uint64_t& h,
+        uint64_t kw
+    ) {
+        const auto t1 = (
+            h
+            + (Rot< 14 >(e) ^ Rot< 18 >(e) ^ Rot< 41 >(e))
+            + ((e & f) ^ (~e & g))
+            + kw
+        );
+        const auto t2 = (
+            (Rot< 28 >(a) ^ Rot< 34 >(a) ^ Rot< 39 >(a))
+            + ((a & b) | (c & (a | b)))
+        );
+        d += t1;
+        h = t1 + t2;
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Sha512CompressAvx2(
+            uint64_t* state,
+            const uint8_t* blocks,
+            size_t numBlocks
+        ) {
+            const auto byteSwap = _mm256_setr_epi8(
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+            );
+            alignas(32) uint64_t kw[80];
+            for (; numBlocks > 0; --numBlocks, blocks += 128) {
+                __m256i y[4];
+                for (size_t i = 0; i < 4; ++i) {
+                    y[i] = _mm256_shuffle_epi8(
+                        _mm256_loadu_si256((const __m256i*)(blocks + i * 32)),
+                        byteSwap
+                    );
+                }
+                for (size_t i = 0; i < 20; ++i) {
+                    if (i >= 4) {
+                        y[i & 3] = Schedule(
+                            y[i & 3],
+                            y[(i + 1) & 3],
+                            y[(i + 2) & 3],
+                            y[(i + 3) & 3]
+                        );
+                    }
+                    _mm256_store_si256(
+                        (__m256i*)(kw + i * 4),
+                        _mm256_add_epi64(
+                            y[i & 3],
+                            _mm256_loadu_si256((const __m256i*)(K512 + i * 4))
+                        )
+                    );
+                }
+                auto a = state[0], b = state[1], c = state[2], d = state[3];
+                auto e = state[4], f = state[5], g = state[6], h = state[7];
+                for (size_t i = 0; i < 80; i += 8) {
+                    Round(a, b, c, d, e, f, g, h, kw[i + 0]);
+                    Round(h, a, b, c, d, e, f, g, kw[i + 1]);
+                    Round(g, h, a, b, c, d, e, f, kw[i + 2]);
+                    Round(f, g, h, a, b, c, d, e, kw[i + 3]);
+                    Round(e, f, g, h, a, b, c, d, kw[i + 4]);
+                    Round(d, e, f, g, h, a, b, c, kw[i + 5]);
+                    Round(c, d, e, f, g, h, a, b, kw[i + 6]);
+                    Round(b, c, d, e, f, g, h, a, kw[i + 7]);
+                }
+                state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+                state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+            }
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
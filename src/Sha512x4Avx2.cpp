@@ -0,0 +1,208 @@
+/**
+ * @file Sha512x4Avx2.cpp
+ *
+ * This module contains the implementation of the multi-buffer SHA-512
+ * block compression kernel which uses AVX2 to compress one block of each
+ * of four independent messages at once.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha2Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function rotates each 64-bit element of the given vector right
+     * by the given number of bits.
+     *
+     * @param[in] x
+     *     This is the vector whose elements to rotate.
+     *
+     * @return
+     *     The rotated vector is returned.
+     */
+    template< int bits > inline __m256i Rot(__m256i x) {
+        return _mm256_or_si256(
+            _mm256_srli_epi64(x, bits),
+            _mm256_slli_epi64(x, 64 - bits)
+        );
+    }
+
+    /**
+     * This function performs one round of SHA-512 in all four lanes.
+     * Rather than shifting every working variable, the caller rotates
+     * the order in which it passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D, which becomes working variable E
+     *     for the next round.
+     *
+     * @param[in] e
+     *     This is working variable E.
+     *
+     * @param[in] f
+     *     This is working variable F.
+     *
+     * @param[in] g
+     *     This is working variable G.
+     *
+     * @param[in,out] h
+     *     This is working variable H, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in] kw
+     *     This is the sum of the round constant and message schedule word
+     *     for the round.
+     */
+    inline void Round(
+        __m256i a, __m256i b, __m256i c, __m256i& d,
+        __m256i e, __m256i f, __m256i g, __m256i& h,
+        __m256i kw
+    ) {
+        const auto s1 = _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 14 >(e), Rot< 18 >(e)),
+            Rot< 41 >(e)
+        );
+        const auto ch = _mm256_xor_si256(
+            _mm256_and_si256(e, f),
+            _mm256_andnot_si256(e, g)
+        );
+        const auto t1 = _mm256_add_epi64(
+            _mm256_add_epi64(h, s1),
+            _mm256_add_epi64(ch, kw)
+        );
+        const auto s0 = _mm256_xor_si256(
+            _mm256_xor_si256(Rot< 28 >(a), Rot< 34 >(a)),
+            Rot< 39 >(a)
+        );
+        const auto maj = _mm256_or_si256(
+            _mm256_and_si256(a, b),
+            _mm256_and_si256(c, _mm256_or_si256(a, b))
+        );
+        d = _mm256_add_epi64(d, t1);
+        h = _mm256_add_epi64(t1, _mm256_add_epi64(s0, maj));
+    }
+
+    /**
+     * This function loads four consecutive big-endian 64-bit words from
+     * each of four blocks and transposes them, so that each resulting
+     * vector holds the same word of all four blocks.
+     *
+     * @param[in] blocks
+     *     These point to the blocks from which to load words.
+     *
+     * @param[in] offset
+     *     This is the offset, in bytes, of the first word to load
+     *     from each block.
+     *
+     * @param[out] w
+     *     This is where to store the four transposed words.
+     */
+    inline void LoadTransposed(
+        const uint8_t* const* blocks,
+        size_t offset,
+        __m256i* w
+    ) {
+        const auto byteSwap = _mm256_setr_epi8(
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+            7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+        );
+        const auto r0 = _mm256_loadu_si256((const __m256i*)(blocks[0] + offset));
+        const auto r1 = _mm256_loadu_si256((const __m256i*)(blocks[1] + offset));
+        const auto r2 = _mm256_loadu_si256((const __m256i*)(blocks[2] + offset));
+        const auto r3 = _mm256_loadu_si256((const __m256i*)(blocks[3] + offset));
+        const auto t0 = _mm256_unpacklo_epi64(r0, r1);
+        const auto t1 = _mm256_unpackhi_epi64(r0, r1);
+        const auto t2 = _mm256_unpacklo_epi64(r2, r3);
+        const auto t3 = _mm256_unpackhi_epi64(r2, r3);
+        w[0] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t0, t2, 0x20), byteSwap);
+        w[1] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t1, t3, 0x20), byteSwap);
+        w[2] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t0, t2, 0x31), byteSwap);
+        w[3] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(t1, t3, 0x31), byteSwap);
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Sha512CompressAvx2x4(
+            uint64_t* states,
+            const uint8_t* const* blocks
+        ) {
+            __m256i w[16];
+            for (size_t i = 0; i < 4; ++i) {
+                LoadTransposed(blocks, i * 32, w + i * 4);
+            }
+            __m256i v[8];
+            __m256i saved[8];
+            for (size_t i = 0; i < 8; ++i) {
+                v[i] = saved[i] = _mm256_loadu_si256((const __m256i*)(states + i * 4));
+            }
+            auto a = v[0], b = v[1], c = v[2], d = v[3];
+            auto e = v[4], f = v[5], g = v[6], h = v[7];
+            for (size_t i = 0; i < 80; i += 8) {
+                __m256i kw[8];
+                for (size_t j = 0; j < 8; ++j) {
+                    const auto t = (i + j) & 15;
+                    if (i + j >= 16) {
+                        const auto w15 = w[(i + j - 15) & 15];
+                        const auto w2 = w[(i + j - 2) & 15];
+                        const auto s0 = _mm256_xor_si256(
+                            _mm256_xor_si256(Rot< 1 >(w15), Rot< 8 >(w15)),
+                            _mm256_srli_epi64(w15, 7)
+                        );
+                        const auto s1 = _mm256_xor_si256(
+                            _mm256_xor_si256(Rot< 19 >(w2), Rot< 61 >(w2)),
+                            _mm256_srli_epi64(w2, 6)
+                        );
+                        w[t] = _mm256_add_epi64(
+                            _mm256_add_epi64(w[t], s0),
+                            _mm256_add_epi64(w[(i + j - 7) & 15], s1)
+                        );
+                    }
+                    kw[j] = _mm256_add_epi64(
+                        w[t],
+                        _mm256_set1_epi64x((long long)K512[i + j])
+                    );
+                }
+                Round(a, b, c, d, e, f, g, h, kw[0]);
+                Round(h, a, b, c, d, e, f, g, kw[1]);
+                Round(g, h, a, b, c, d, e, f, kw[2]);
+                Round(f, g, h, a, b, c, d, e, kw[3]);
+                Round(e, f, g, h, a, b, c, d, kw[4]);
+                Round(d, e, f, g, h, a, b, c, kw[5]);
+                Round(c, d, e, f, g, h, a, b, kw[6]);
+                Round(b, c, d, e, f, g, h, a, kw[7]);
+            }
+            v[0] = a; v[1] = b; v[2] = c; v[3] = d;
+            v[4] = e; v[5] = f; v[6] = g; v[7] = h;
+            for (size_t i = 0; i < 8; ++i) {
+                _mm256_storeu_si256(
+                    (__m256i*)(states + i * 4),
+                    _mm256_add_epi64(v[i], saved[i])
+                );
+            }
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
@@ -0,0 +1,203 @@
+/**
+ * @file Sha512x8Avx512.cpp
+ *
+ * This module contains the implementation of the multi-buffer SHA-512
+ * block compression kernel which uses AVX-512 to compress one block of
+ * each of eight independent messages at once.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include "Sha2Kernels.hpp"
+
+#if HASH_TARGET_X86
+
+#include <immintrin.h>
+#include <stdint.h>
+
+namespace {
+
+    /**
+     * This function performs one round of SHA-512 in all eight lanes.
+     * Rather than shifting every working variable, the caller rotates
+     * the order in which it passes them.
+     *
+     * @param[in] a
+     *     This is working variable A.
+     *
+     * @param[in] b
+     *     This is working variable B.
+     *
+     * @param[in] c
+     *     This is working variable C.
+     *
+     * @param[in,out] d
+     *     This is working variable D, which becomes working variable E
+     *     for the next round.
+     *
+     * @param[in] e
+     *     This is working variable E.
+     *
+     * @param[in] f
+     *     This is working variable F.
+     *
+     * @param[in] g
+     *     This is working variable G.
+     *
+     * @param[in,out] h
+     *     This is working variable H, which becomes working variable A
+     *     for the next round.
+     *
+     * @param[in] kw
+     *     This is the sum of the round constant and message schedule word
+     *     for the round.
+     */
+    inline void Round(
+        __m512i a, __m512i b, __m512i c, __m512i& d,
+        __m512i e, __m512i f, __m512i g, __m512i& h,
+        __m512i kw
+    ) {
+        // The ternary logic immediates select, bit by bit:
+        // 0x96 = x ^ y ^ z, 0xCA = x ? y : z (ch), 0xE8 = majority.
+        const auto s1 = _mm512_ternarylogic_epi64(
+            _mm512_ror_epi64(e, 14),
+            _mm512_ror_epi64(e, 18),
+            _mm512_ror_epi64(e, 41),
+            0x96
+        );
+        const auto ch = _mm512_ternarylogic_epi64(e, f, g, 0xCA);
+        const auto t1 = _mm512_add_epi64(
+            _mm512_add_epi64(h, s1),
+            _mm512_add_epi64(ch, kw)
+        );
+        const auto s0 = _mm512_ternarylogic_epi64(
+            _mm512_ror_epi64(a, 28),
+            _mm512_ror_epi64(a, 34),
+            _mm512_ror_epi64(a, 39),
+            0x96
+        );
+        const auto maj = _mm512_ternarylogic_epi64(a, b, c, 0xE8);
+        d = _mm512_add_epi64(d, t1);
+        h = _mm512_add_epi64(t1, _mm512_add_epi64(s0, maj));
+    }
+
+    /**
+     * This function loads eight consecutive big-endian 64-bit words from
+     * each of eight blocks and transposes them, so that each resulting
+     * vector holds the same word of all eight blocks.
+     *
+     * @param[in] blocks
+     *     These point to the blocks from which to load words.
+     *
+     * @param[in] offset
+     *     This is the offset, in bytes, of the first word to load
+     *     from each block.
+     *
+     * @param[out] w
+     *     This is where to store the eight transposed words.
+     */
+    inline void LoadTransposed(
+        const uint8_t* const* blocks,
+        size_t offset,
+        __m512i* w
+    ) {
+        const auto byteSwap = _mm512_set_epi64(
+            0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+            0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+            0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+            0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL
+        );
+        __m512i r[8];
+        for (size_t i = 0; i < 8; ++i) {
+            r[i] = _mm512_loadu_si512((const void*)(blocks[i] + offset));
+        }
+        __m512i t[8];
+        for (size_t i = 0; i < 4; ++i) {
+            t[i * 2] = _mm512_unpacklo_epi64(r[i * 2], r[i * 2 + 1]);
+            t[i * 2 + 1] = _mm512_unpackhi_epi64(r[i * 2], r[i * 2 + 1]);
+        }
+        for (size_t i = 0; i < 2; ++i) {
+            const auto even0 = _mm512_shuffle_i64x2(t[i], t[i + 2], 0x88);
+            const auto odd0 = _mm512_shuffle_i64x2(t[i], t[i + 2], 0xDD);
+            const auto even1 = _mm512_shuffle_i64x2(t[i + 4], t[i + 6], 0x88);
+            const auto odd1 = _mm512_shuffle_i64x2(t[i + 4], t[i + 6], 0xDD);
+            w[i] = _mm512_shuffle_epi8(_mm512_shuffle_i64x2(even0, even1, 0x88), byteSwap);
+            w[i + 4] = _mm512_shuffle_epi8(_mm512_shuffle_i64x2(even0, even1, 0xDD), byteSwap);
+            w[i + 2] = _mm512_shuffle_epi8(_mm512_shuffle_i64x2(odd0, odd1, 0x88), byteSwap);
+            w[i + 6] = _mm512_shuffle_epi8(_mm512_shuffle_i64x2(odd0, odd1, 0xDD), byteSwap);
+        }
+    }
+
+}
+
+namespace Hash {
+
+    namespace Internal {
+
+        void Sha512CompressAvx512x8(
+            uint64_t* states,
+            const uint8_t* const* blocks
+        ) {
+            __m512i w[16];
+            LoadTransposed(blocks, 0, w);
+            LoadTransposed(blocks, 64, w + 8);
+            __m512i v[8];
+            __m512i saved[8];
+            for (size_t i = 0; i < 8; ++i) {
+                v[i] = saved[i] = _mm512_loadu_si512((const void*)(states + i * 8));
+            }
+            auto a = v[0], b = v[1], c = v[2], d = v[3];
+            auto e = v[4], f = v[5], g = v[6], h = v[7];
+            for (size_t i = 0; i < 80; i += 8) {
+                __m512i kw[8];
+                for (size_t j = 0; j < 8; ++j) {
+                    const auto t = (i + j) & 15;
+                    if (i + j >= 16) {
+                        const auto w15 = w[(i + j - 15) & 15];
+                        const auto w2 = w[(i + j - 2) & 15];
+                        const auto s0 = _mm512_ternarylogic_epi64(
+                            _mm512_ror_epi64(w15, 1),
+                            _mm512_ror_epi64(w15, 8),
+                            _mm512_srli_epi64(w15, 7),
+                            0x96
+                        );
+                        const auto s1 = _mm512_ternarylogic_epi64(
+                            _mm512_ror_epi64(w2, 19),
+                            _mm512_ror_epi64(w2, 61),
+                            _mm512_srli_epi64(w2, 6),
+                            0x96
+                        );
+                        w[t] = _mm512_add_epi64(
+                            _mm512_add_epi64(w[t], s0),
+                            _mm512_add_epi64(w[(i + j - 7) & 15], s1)
+                        );
+                    }
+                    kw[j] = _mm512_add_epi64(
+                        w[t],
+                        _mm512_set1_epi64((long long)K512[i + j])
+                    );
+                }
+                Round(a, b, c, d, e, f, g, h, kw[0]);
+                Round(h, a, b, c, d, e, f, g, kw[1]);
+                Round(g, h, a, b, c, d, e, f, kw[2]);
+                Round(f, g, h, a, b, c, d, e, kw[3]);
+                Round(e, f, g, h, a, b, c, d, kw[4]);
+                Round(d, e, f, g, h, a, b, c, kw[5]);
+                Round(c, d, e, f, g, h, a, b, kw[6]);
+                Round(b, c, d, e, f, g, h, a, kw[7]);
+            }
+            v[0] = a; v[1] = b; v[2] = c; v[3] = d;
+            v[4] = e; v[5] = f; v[6] = g; v[7] = h;
+            for (size_t i = 0; i < 8; ++i) {
+                _mm512_storeu_si512(
+                    (void*)(states + i * 8),
+                    _mm512_add_epi64(v[i], saved[i])
+                );
+            }
+        }
+
+    }
+
+}
+
+#endif /* HASH_TARGET_X86 */
@@ -0,0 +1,198 @@
+/**
+ * @file HashFileTests.cpp
+ *
+ * This module contains the unit tests of the functions which compute
+ * message digests of files.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Hash/HashFile.hpp>
+#include <Hash/Md5.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+    /**
+     * This is the path of the file used in the tests.
+     */
+    const std::string testFilePath = "HashFileTests.tmp";
+
+    /**
+     * This function writes the given contents to the given file.
+     *
+     * @param[in] path
+     *     This is the path of the file to write.
+     *
+     * @param[in] contents
+     *     These are the contents to write to the file.
+     */
+    void WriteFile(const std::string& path, const std::vector< uint8_t >& contents) {
+        const auto file = fopen(path.c_str(), "wb");
+        ASSERT_FALSE(file == NULL);
+        if (!contents.empty()) {
+            ASSERT_EQ(contents.size(), fwrite(contents.data(), 1, contents.size(), file));
+        }
+        (void)fclose(file);
+    }
+
+    /**
+     * This function makes contents for a test file of the given size.
+     *
+     * @param[in] size
+     *     This is the number of bytes to make.
+     *
+     * @return
+     *     The contents are returned.
+     */
+    std::vector< uint8_t > MakeContents(size_t size) {
+        std::vector< uint8_t > contents(size);
+        uint32_t x = 12345;
+        for (auto& b: contents) {
+            x = x * 1103515245 + 12345;
+            b = (uint8_t)(x >> 24);
+        }
+        return contents;
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct HashFileTests
+    : public ::testing::Test
+{
+    // TestFixture
+
+    virtual void TearDown() override {
+        (void)remove(testFilePath.c_str());
+    }
+};
+
+TEST_F(HashFileTests, DigestsMatchInMemoryHashes) {
+    for (const auto size: {1, 63, 64, 1000, 3 * 1024 * 1024 + 17}) {
+        const auto contents = MakeContents(size);
+        WriteFile(testFilePath, contents);
+        EXPECT_EQ(Hash::Md5(contents), Hash::HashFile< Hash::Md5Context >(testFilePath)) << size;
+        EXPECT_EQ(Hash::Sha1(contents), Hash::HashFile< Hash::Sha1Context >(testFilePath)) << size;
+        EXPECT_EQ(Hash::Sha256(contents), Hash::HashFile< Hash::Sha256Context >(testFilePath)) << size;
+        EXPECT_EQ(Hash::Sha512(contents), Hash::HashFile< Hash::Sha512Context >(testFilePath)) << size;
+    }
+}
+
+TEST_F(HashFileTests, EmptyFile) {
+    WriteFile(testFilePath, {});
+    EXPECT_EQ(Hash::Sha256({}), Hash::HashFile< Hash::Sha256Context >(testFilePath));
+}
+
+TEST_F(HashFileTests, MissingFile) {
+    EXPECT_TRUE(Hash::HashFile< Hash::Sha256Context >(testFilePath).empty());
+    uint8_t digest[32];
+    EXPECT_FALSE(Hash::HashFile< Hash::Sha256Context >(testFilePath, digest));
+}
+
+TEST_F(HashFileTests, PiecesCoverWholeFile) {
+    const auto contents = MakeContents(2 * 1024 * 1024 + 5);
+    WriteFile(testFilePath, contents);
+    std::vector< uint8_t > pieces;
+    EXPECT_TRUE(
+        Hash::ReadFileInPieces(
+            testFilePath,
+            [&pieces](const uint8_t* data, size_t length) {
+                pieces.insert(pieces.end(), data, data + length);
+            }
+        )
+    );
+    EXPECT_EQ(contents, pieces);
+}
+
+#ifndef _WIN32
+TEST_F(HashFileTests, PipeIsReadInBuffers) {
+    ASSERT_EQ(0, mkfifo(testFilePath.c_str(), 0600));
+    const auto contents = MakeContents(5 * 1024 * 1024 + 3);
+    std::thread writer([&]{
+        const auto file = fopen(testFilePath.c_str(), "wb");
+        ASSERT_FALSE(file == NULL);
+        for (size_t offset = 0; offset < contents.size(); offset += 1000) {
+            const auto length = std::min((size_t)1000, contents.size() - offset);
+            (void)fwrite(contents.data() + offset, 1, length, file);
+        }
+        (void)fclose(file);
+    });
+    EXPECT_EQ(Hash::Sha256(contents), Hash::HashFile< Hash::Sha256Context >(testFilePath));
+    writer.join();
+}
+#endif
+
+TEST_F(HashFileTests, ConsumerExceptionIsPassedOn) {
+    WriteFile(testFilePath, MakeContents(1000));
+    size_t calls = 0;
+    EXPECT_THROW(
+        Hash::ReadFileInPieces(
+            testFilePath,
+            [&calls](const uint8_t*, size_t) {
+                ++calls;
+                throw std::runtime_error("stop");
+            }
+        ),
+        std::runtime_error
+    );
+    EXPECT_EQ(1, calls);
+}
+
+#ifndef _WIN32
+TEST_F(HashFileTests, ConsumerExceptionStopsReaderThread) {
+    // Reading from an endless device, the reader thread fills the other
+    // buffer and then waits for it to be emptied, which never happens
+    // unless it's told to stop.
+    size_t calls = 0;
+    EXPECT_THROW(
+        Hash::ReadFileInPieces(
+            "/dev/zero",
+            [&calls](const uint8_t*, size_t) {
+                if (++calls == 3) {
+                    throw std::runtime_error("stop");
+                }
+            }
+        ),
+        std::runtime_error
+    );
+    EXPECT_EQ(3, calls);
+}
+
+TEST_F(HashFileTests, TruncatedFileFailsInsteadOfCrashing) {
+    // The file is sparse, so it's large enough to be mapped in more than
+    // one window without actually writing that much.
+    WriteFile(testFilePath, {});
+    ASSERT_EQ(0, truncate(testFilePath.c_str(), 65 * 1024 * 1024));
+    size_t received = 0;
+    EXPECT_FALSE(
+        Hash::ReadFileInPieces(
+            testFilePath,
+            [&received](const uint8_t*, size_t length) {
+                if (received == 0) {
+                    ASSERT_EQ(0, truncate(testFilePath.c_str(), 1024 * 1024));
+                }
+                received += length;
+            }
+        )
+    );
+    EXPECT_EQ(64 * 1024 * 1024, received);
+}
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file HexTests.cpp
+ *
+ * This module contains the unit tests of the hexadecimal conversion
+ * functions.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Hash/Hex.hpp>
+#include <src/HexKernels.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+TEST(HexTests, EncodeTestVectors) {
+    EXPECT_EQ("", Hash::EncodeHex(std::vector< uint8_t >{}));
+    EXPECT_EQ("00", Hash::EncodeHex(std::vector< uint8_t >{0x00}));
+    EXPECT_EQ(
+        "0123456789abcdeffedcba9876543210",
+        Hash::EncodeHex(std::vector< uint8_t >{
+            0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+            0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+        })
+    );
+}
+
+TEST(HexTests, EncodeKernelsAgree) {
+    std::vector< uint8_t > data(300);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (size_t length = 0; length <= data.size(); ++length) {
+        std::string expected(length * 2, '\0');
+        Hash::Internal::EncodeHexScalar(data.data(), length, &expected[0]);
+        EXPECT_EQ(expected, Hash::EncodeHex(data.data(), length)) << length;
+#if HASH_TARGET_X86
+        if (Hash::Internal::GetCpuFeatures().ssse3) {
+            std::string actual(length * 2, '\0');
+            Hash::Internal::EncodeHexSsse3(data.data(), length, &actual[0]);
+            EXPECT_EQ(expected, actual) << length;
+        }
+#endif
+    }
+}
+
+TEST(HexTests, EncodeAllByteValues) {
+    std::vector< uint8_t > data(256);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)i;
+    }
+    const auto hex = Hash::EncodeHex(data);
+    ASSERT_EQ(512, hex.length());
+    const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < data.size(); ++i) {
+        EXPECT_EQ(digits[i >> 4], hex[i * 2]);
+        EXPECT_EQ(digits[i & 0x0F], hex[i * 2 + 1]);
+    }
+}
+
+TEST(HexTests, DecodeValidDigits) {
+    std::vector< uint8_t > data;
+    EXPECT_TRUE(Hash::DecodeHex("", data));
+    EXPECT_EQ(std::vector< uint8_t >{}, data);
+    EXPECT_TRUE(Hash::DecodeHex("0123456789abcdefABCDEF", data));
+    EXPECT_EQ(
+        (std::vector< uint8_t >{
+            0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0xAB, 0xCD, 0xEF,
+        }),
+        data
+    );
+}
+
+TEST(HexTests, DecodeRejectsInvalidInput) {
+    std::vector< uint8_t > data;
+    EXPECT_FALSE(Hash::DecodeHex("abc", data));
+    EXPECT_TRUE(data.empty());
+    for (const std::string hex: {
+        "0g", "g0", "x1", " 1", "1 ", "0:", "/0", "@a", "`a", "af\n",
+    }) {
+        data.assign(3, 0);
+        EXPECT_FALSE(Hash::DecodeHex(hex, data)) << hex;
+        EXPECT_TRUE(data.empty()) << hex;
+    }
+    const std::string withNull("0\0", 2);
+    EXPECT_FALSE(Hash::DecodeHex(withNull, data));
+    const std::string highBit("a\xC1", 2);
+    EXPECT_FALSE(Hash::DecodeHex(highBit, data));
+}
+
+TEST(HexTests, RoundTrip) {
+    std::vector< uint8_t > data(1000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)(i * 131 + 7);
+    }
+    std::vector< uint8_t > decoded;
+    ASSERT_TRUE(Hash::DecodeHex(Hash::EncodeHex(data), decoded));
+    EXPECT_EQ(data, decoded);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file HmacContextTests.cpp
+ *
+ * This module contains the unit tests of the Hash::HmacContext class
+ * template.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <Hash/Hex.hpp>
+#include <Hash/Hmac.hpp>
+#include <Hash/HmacContext.hpp>
+#include <Hash/Md5.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    /**
+     * This function checks that the given HMAC context produces the same
+     * HMAC codes as the general HMAC function made from the given hash
+     * function, for keys shorter than, equal to, and longer than a block,
+     * and messages given both at once and in pieces.
+     *
+     * @param[in] hashFunction
+     *     This is the hash function used by the HMAC context.
+     */
+    template< typename HashContext > void CheckAgainstGeneralForm(
+        std::vector< uint8_t > (*hashFunction)(const std::vector< uint8_t >&)
+    ) {
+        const size_t blockSize = Hash::HmacContext< HashContext >::blockSize;
+        const auto hmac = Hash::MakeHmacBytesToBytesFunction(hashFunction, blockSize);
+        std::vector< uint8_t > message(300);
+        for (size_t i = 0; i < message.size(); ++i) {
+            message[i] = (uint8_t)(i * 13 + 5);
+        }
+        for (size_t keyLength: {(size_t)0, (size_t)20, blockSize, blockSize + 1, blockSize * 3}) {
+            std::vector< uint8_t > key(keyLength);
+            for (size_t i = 0; i < key.size(); ++i) {
+                key[i] = (uint8_t)(i * 31 + 1);
+            }
+            Hash::HmacContext< HashContext > context(key);
+            for (size_t messageLength: {0, 1, 55, 64, 129, 300}) {
+                const std::vector< uint8_t > part(message.begin(), message.begin() + messageLength);
+                const auto expected = hmac(key, part);
+                context.Update(part);
+                EXPECT_EQ(expected, context.Final()) << keyLength << ", " << messageLength;
+                for (size_t i = 0; i < messageLength; i += 7) {
+                    context.Update(part.data() + i, std::min((size_t)7, messageLength - i));
+                }
+                std::vector< uint8_t > code(Hash::HmacContext< HashContext >::codeSize);
+                context.Final(code.data());
+                EXPECT_EQ(expected, code) << keyLength << ", " << messageLength;
+            }
+        }
+    }
+
+}
+
+TEST(HmacContextTests, TestVectors) {
+    // These test vectors were taken from RFC 2202 (test case 2) and
+    // RFC 4231 (test cases 2 and 6).
+    Hash::HmacMd5Context md5("Jefe", 4);
+    md5.Update("what do ya want for nothing?", 28);
+    EXPECT_EQ("750c783e6ab0b503eaa86e310a5db738", Hash::EncodeHex(md5.Final()));
+    Hash::HmacSha1Context sha1("Jefe", 4);
+    sha1.Update("what do ya want for nothing?", 28);
+    EXPECT_EQ("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79", Hash::EncodeHex(sha1.Final()));
+    Hash::HmacSha256Context sha256("Jefe", 4);
+    sha256.Update("what do ya want for nothing?", 28);
+    EXPECT_EQ(
+        "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+        Hash::EncodeHex(sha256.Final())
+    );
+    const std::vector< uint8_t > longKey(131, 0xAA);
+    Hash::HmacSha512Context sha512(longKey);
+    const std::string message = "Test Using Larger Than Block-Size Key - Hash Key First";
+    sha512.Update(message.data(), message.length());
+    EXPECT_EQ(
+        "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+        "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598",
+        Hash::EncodeHex(sha512.Final())
+    );
+}
+
+TEST(HmacContextTests, MatchesGeneralForm) {
+    CheckAgainstGeneralForm< Hash::Md5Context >(Hash::Md5);
+    CheckAgainstGeneralForm< Hash::Sha1Context >(Hash::Sha1);
+    CheckAgainstGeneralForm< Hash::Sha224Context >(Hash::Sha224);
+    CheckAgainstGeneralForm< Hash::Sha256Context >(Hash::Sha256);
+    CheckAgainstGeneralForm< Hash::Sha384Context >(Hash::Sha384);
+    CheckAgainstGeneralForm< Hash::Sha512Context >(Hash::Sha512);
+    CheckAgainstGeneralForm< Hash::Sha512t224Context >(Hash::Sha512t224);
+    CheckAgainstGeneralForm< Hash::Sha512t256Context >(Hash::Sha512t256);
+}
+
+TEST(HmacContextTests, ResetDiscardsMessage) {
+    Hash::HmacSha256Context context("key", 3);
+    context.Update("garbage", 7);
+    context.Reset();
+    context.Update("message", 7);
+    const auto code = context.Final();
+    context.Update("message", 7);
+    EXPECT_EQ(code, context.Final());
+    auto copy = context;
+    copy.Update("message", 7);
+    EXPECT_EQ(code, copy.Final());
+}
+
+TEST(HmacContextTests, ComputeLeavesMessageInProgress) {
+    Hash::HmacSha256Context context("key", 3);
+    context.Update("mess", 4);
+    std::vector< uint8_t > code(Hash::HmacSha256Context::codeSize);
+    context.Compute("other message", 13, code.data());
+    EXPECT_EQ(Hash::ComputeHmac< Hash::Sha256Context >({'k', 'e', 'y'}, {'o', 't', 'h', 'e', 'r', ' ', 'm', 'e', 's', 's', 'a', 'g', 'e'}), code);
+    context.Update("age", 3);
+    EXPECT_EQ(Hash::ComputeHmac< Hash::Sha256Context >({'k', 'e', 'y'}, {'m', 'e', 's', 's', 'a', 'g', 'e'}), context.Final());
+}
+
+TEST(HmacContextTests, CopiesOutliveOriginal) {
+    const auto expected = Hash::ComputeHmac< Hash::Sha1Context >({'k', 'e', 'y'}, {'m'});
+    std::vector< Hash::HmacSha1Context > copies;
+    {
+        Hash::HmacSha1Context original("key", 3);
+        copies.push_back(original);
+        copies.push_back(std::move(original));
+    }
+    for (auto& copy: copies) {
+        copy.Update("m", 1);
+        EXPECT_EQ(expected, copy.Final());
+    }
+}
@@ -0,0 +1,291 @@
+/**
+ * @file HmacKeyCacheTests.cpp
+ *
+ * This module contains the unit tests of the process-wide cache of
+ * prepared HMAC keys.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <functional>
+#include <gtest/gtest.h>
+#include <Hash/Hmac.hpp>
+#include <Hash/HmacKeyCache.hpp>
+#include <Hash/Md5.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <Hash/Templates.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This function returns an HMAC function which computes HMAC codes
+     * with the given hash function without the cache, by wrapping it
+     * so that it isn't recognized as one of the library's own.
+     *
+     * @param[in] hashFunction
+     *     This is the hash function to use.
+     *
+     * @param[in] blockSize
+     *     This is the block size of the hash function, in bytes.
+     *
+     * @return
+     *     An HMAC function which doesn't use the cache is returned.
+     */
+    std::function<
+        std::vector< uint8_t >(
+            const std::vector< uint8_t >&,
+            const std::vector< uint8_t >&
+        )
+    > MakeUncachedHmac(
+        Hash::HashFunction hashFunction,
+        size_t blockSize
+    ) {
+        return Hash::MakeHmacBytesToBytesFunction(
+            [hashFunction](const std::vector< uint8_t >& message) {
+                return hashFunction(message);
+            },
+            blockSize
+        );
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct HmacKeyCacheTests
+    : public ::testing::Test
+{
+    // TestFixture
+
+    virtual void TearDown() override {
+        Hash::ConfigureHmacKeyCache(Hash::HMAC_KEY_CACHE_DEFAULT_CAPACITY);
+    }
+};
+
+TEST_F(HmacKeyCacheTests, MatchesUncachedHmac) {
+    Hash::ConfigureHmacKeyCache(100);
+    const auto before = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(0, before.size);
+    const auto hmac = Hash::MakeHmacBytesToBytesFunction(Hash::Sha256, Hash::SHA256_BLOCK_SIZE);
+    const auto uncachedHmac = MakeUncachedHmac(Hash::Sha256, Hash::SHA256_BLOCK_SIZE);
+    const std::vector< uint8_t > message{'H', 'i', ' ', 'T', 'h', 'e', 'r', 'e'};
+    for (const auto keyLength: {0, 1, 20, 63, 64, 65, 131}) {
+        const std::vector< uint8_t > key(keyLength, 0xAA);
+        for (size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(uncachedHmac(key, message), hmac(key, message)) << keyLength;
+        }
+    }
+    const auto after = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(7, after.hits - before.hits);
+    EXPECT_EQ(14, after.misses - before.misses);
+    EXPECT_EQ(7, after.size);
+}
+
+TEST_F(HmacKeyCacheTests, EveryLibraryHashAndFactoryUsesCache) {
+    struct TestVector {
+        Hash::HashFunction hashFunction;
+        size_t blockSize;
+    };
+    const std::vector< TestVector > testVectors{
+        {Hash::Md5, Hash::MD5_BLOCK_SIZE},
+        {Hash::Sha1, Hash::SHA1_BLOCK_SIZE},
+        {Hash::Sha224, Hash::SHA224_BLOCK_SIZE},
+        {Hash::Sha256, Hash::SHA256_BLOCK_SIZE},
+        {Hash::Sha384, Hash::SHA512_BLOCK_SIZE},
+        {Hash::Sha512, Hash::SHA512_BLOCK_SIZE},
+        {Hash::Sha512t224, Hash::SHA512_BLOCK_SIZE},
+        {Hash::Sha512t256, Hash::SHA512_BLOCK_SIZE},
+    };
+    Hash::ConfigureHmacKeyCache(100);
+    const std::string key(200, 'k');
+    const std::string message = "The quick brown fox jumps over the lazy dog";
+    const std::vector< uint8_t > keyBytes(key.begin(), key.end());
+    const std::vector< uint8_t > messageBytes(message.begin(), message.end());
+    for (const auto& testVector: testVectors) {
+        const auto expected = MakeUncachedHmac(testVector.hashFunction, testVector.blockSize)(keyBytes, messageBytes);
+        const auto before = Hash::GetHmacKeyCacheStatistics();
+        for (size_t i = 0; i < 2; ++i) {
+            EXPECT_EQ(
+                expected,
+                Hash::MakeHmacBytesToBytesFunction(testVector.hashFunction, testVector.blockSize)(keyBytes, messageBytes)
+            );
+        }
+        const auto after = Hash::GetHmacKeyCacheStatistics();
+        EXPECT_EQ(2, after.misses - before.misses);
+        EXPECT_EQ(0, after.hits - before.hits);
+    }
+    const auto before = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(
+        Hash::MakeHmacBytesToBytesFunction(Hash::Sha1, Hash::SHA1_BLOCK_SIZE)(keyBytes, messageBytes),
+        Hash::MakeHmacStringToBytesFunction(Hash::StringToBytes< Hash::Sha1 >, Hash::SHA1_BLOCK_SIZE)(key, message)
+    );
+    const auto expectedHex = Hash::MakeHmacBytesToStringFunctionFromRawHash(Hash::Sha1, Hash::SHA1_BLOCK_SIZE)(keyBytes, messageBytes);
+    EXPECT_EQ(
+        expectedHex,
+        Hash::MakeHmacBytesToStringFunction(Hash::BytesToString< Hash::Sha1 >, Hash::SHA1_BLOCK_SIZE)(keyBytes, messageBytes)
+    );
+    EXPECT_EQ(
+        expectedHex,
+        Hash::MakeHmacStringToStringFunction(Hash::StringToString< Hash::Sha1 >, Hash::SHA1_BLOCK_SIZE)(key, message)
+    );
+    EXPECT_EQ(
+        expectedHex,
+        Hash::MakeHmacStringToStringFunctionFromRawHash(Hash::StringToBytes< Hash::Sha1 >, Hash::SHA1_BLOCK_SIZE)(key, message)
+    );
+    const auto after = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(6, after.hits - before.hits);
+    EXPECT_EQ(0, after.misses - before.misses);
+    EXPECT_EQ(8, after.size);
+}
+
+TEST_F(HmacKeyCacheTests, UnrecognizedHashOrBlockSizeBypassesCache) {
+    Hash::ConfigureHmacKeyCache(100);
+    const auto before = Hash::GetHmacKeyCacheStatistics();
+    const std::vector< uint8_t > key{'k', 'e', 'y'};
+    const std::vector< uint8_t > message{'m'};
+    (void)MakeUncachedHmac(Hash::Sha256, Hash::SHA256_BLOCK_SIZE)(key, message);
+    (void)Hash::MakeHmacBytesToBytesFunction(Hash::Sha256, 32)(key, message);
+    const auto after = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(before.hits, after.hits);
+    EXPECT_EQ(before.misses, after.misses);
+    EXPECT_EQ(0, after.size);
+}
+
+TEST_F(HmacKeyCacheTests, DropsLeastRecentlyUsedKeys) {
+    Hash::ConfigureHmacKeyCache(2, 1);
+    const auto hmac = Hash::MakeHmacBytesToBytesFunction(Hash::Sha1, Hash::SHA1_BLOCK_SIZE);
+    const std::vector< uint8_t > a{'a'};
+    const std::vector< uint8_t > b{'b'};
+    const std::vector< uint8_t > c{'c'};
+    const std::vector< uint8_t > message{'m'};
+    const auto before = Hash::GetHmacKeyCacheStatistics();
+    (void)hmac(a, message);
+    (void)hmac(a, message);
+    (void)hmac(b, message);
+    (void)hmac(b, message);
+    (void)hmac(a, message);
+    (void)hmac(c, message);
+    (void)hmac(c, message);
+    auto statistics = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(1, statistics.hits - before.hits);
+    EXPECT_EQ(6, statistics.misses - before.misses);
+    EXPECT_EQ(2, statistics.size);
+    (void)hmac(a, message);
+    (void)hmac(b, message);
+    statistics = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(2, statistics.hits - before.hits);
+    EXPECT_EQ(7, statistics.misses - before.misses);
+    EXPECT_EQ(2, statistics.size);
+    Hash::ClearHmacKeyCache();
+    statistics = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(2, statistics.hits - before.hits);
+    EXPECT_EQ(7, statistics.misses - before.misses);
+    EXPECT_EQ(0, statistics.size);
+}
+
+TEST_F(HmacKeyCacheTests, KeyIsKeptOnlyWhenSeenTwice) {
+    Hash::ConfigureHmacKeyCache(100);
+    const auto hmac = Hash::MakeHmacBytesToBytesFunction(Hash::Sha1, Hash::SHA1_BLOCK_SIZE);
+    const auto uncachedHmac = MakeUncachedHmac(Hash::Sha1, Hash::SHA1_BLOCK_SIZE);
+    const std::vector< uint8_t > key{'o', 'n', 'c', 'e'};
+    const std::vector< uint8_t > message{'m'};
+    const auto before = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(uncachedHmac(key, message), hmac(key, message));
+    auto statistics = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(0, statistics.hits - before.hits);
+    EXPECT_EQ(1, statistics.misses - before.misses);
+    EXPECT_EQ(0, statistics.size);
+    EXPECT_EQ(uncachedHmac(key, message), hmac(key, message));
+    statistics = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(0, statistics.hits - before.hits);
+    EXPECT_EQ(2, statistics.misses - before.misses);
+    EXPECT_EQ(1, statistics.size);
+    Hash::ClearHmacKeyCache();
+    EXPECT_EQ(uncachedHmac(key, message), hmac(key, message));
+    statistics = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(3, statistics.misses - before.misses);
+    EXPECT_EQ(0, statistics.size);
+}
+
+TEST_F(HmacKeyCacheTests, NeverKeepsMoreKeysThanCapacity) {
+    const auto hmac = Hash::MakeHmacBytesToBytesFunction(Hash::Sha1, Hash::SHA1_BLOCK_SIZE);
+    const std::vector< uint8_t > message{'m'};
+    const struct {
+        size_t capacity;
+        size_t numShards;
+    } configurations[] = {
+        {1, Hash::HMAC_KEY_CACHE_DEFAULT_SHARDS},
+        {5, 4},
+        {7, 64},
+        {17, 16},
+    };
+    for (const auto& configuration: configurations) {
+        Hash::ConfigureHmacKeyCache(configuration.capacity, configuration.numShards);
+        for (size_t i = 0; i < 1000; ++i) {
+            const std::vector< uint8_t > key{'k', (uint8_t)i, (uint8_t)(i >> 8)};
+            (void)hmac(key, message);
+            (void)hmac(key, message);
+        }
+        EXPECT_EQ(
+            configuration.capacity,
+            Hash::GetHmacKeyCacheStatistics().size
+        ) << configuration.capacity << ", " << configuration.numShards;
+    }
+}
+
+TEST_F(HmacKeyCacheTests, ZeroCapacityTurnsCacheOff) {
+    Hash::ConfigureHmacKeyCache(0);
+    const auto hmac = Hash::MakeHmacBytesToBytesFunction(Hash::Sha256, Hash::SHA256_BLOCK_SIZE);
+    const auto uncachedHmac = MakeUncachedHmac(Hash::Sha256, Hash::SHA256_BLOCK_SIZE);
+    const std::vector< uint8_t > key(100, 0x0B);
+    const std::vector< uint8_t > message{'m'};
+    const auto before = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(uncachedHmac(key, message), hmac(key, message));
+    EXPECT_EQ(uncachedHmac(key, message), hmac(key, message));
+    const auto after = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(before.hits, after.hits);
+    EXPECT_EQ(before.misses, after.misses);
+    EXPECT_EQ(0, after.size);
+}
+
+TEST_F(HmacKeyCacheTests, ConcurrentUse) {
+    Hash::ConfigureHmacKeyCache(8, 4);
+    const auto hmac = Hash::MakeHmacBytesToBytesFunction(Hash::Sha256, Hash::SHA256_BLOCK_SIZE);
+    const auto uncachedHmac = MakeUncachedHmac(Hash::Sha256, Hash::SHA256_BLOCK_SIZE);
+    std::vector< std::vector< uint8_t > > keys;
+    for (size_t i = 0; i < 16; ++i) {
+        keys.emplace_back(i * 9, (uint8_t)i);
+    }
+    const std::vector< uint8_t > message{'m', 'e', 's', 's', 'a', 'g', 'e'};
+    std::vector< std::vector< uint8_t > > expected;
+    for (const auto& key: keys) {
+        expected.push_back(uncachedHmac(key, message));
+    }
+    const auto before = Hash::GetHmacKeyCacheStatistics();
+    std::vector< std::thread > threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]{
+            for (size_t i = 0; i < 500; ++i) {
+                const auto k = (i * (t + 1)) % keys.size();
+                EXPECT_EQ(expected[k], hmac(keys[k], message));
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    const auto after = Hash::GetHmacKeyCacheStatistics();
+    EXPECT_EQ(
+        2000,
+        (after.hits - before.hits) + (after.misses - before.misses)
+    );
+    EXPECT_LE(after.size, 8);
+}
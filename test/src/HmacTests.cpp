@@ -8,12 +8,14 @@
 
 #include <gtest/gtest.h>
 #include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
 #include <Hash/Templates.hpp>
 #include <Hash/Hmac.hpp>
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 TEST(HmacTests, HmacCodeTestVectors) {
@@ -49,3 +51,45 @@ TEST(HmacTests, HmacCodeByteVector) {
         hmac("", "")
     );
 }
+
+TEST(HmacTests, HmacCodeFromRawHashMatchesHexHash) {
+    const auto hmacHex = Hash::MakeHmacStringToStringFunction(Hash::StringToString< Hash::Sha1 >, 64);
+    const auto hmacRaw = Hash::MakeHmacStringToStringFunctionFromRawHash(Hash::StringToBytes< Hash::Sha1 >, 64);
+    const auto hmacBytesHex = Hash::MakeHmacBytesToStringFunction(Hash::BytesToString< Hash::Sha1 >, 64);
+    const auto hmacBytesRaw = Hash::MakeHmacBytesToStringFunctionFromRawHash(Hash::Sha1, 64);
+    for (size_t keyLength: {0, 3, 63, 64, 65, 200}) {
+        std::string key;
+        for (size_t i = 0; i < keyLength; ++i) {
+            key.push_back((char)(i * 7 + 200));
+        }
+        const std::string message = "The quick brown fox jumps over the lazy dog";
+        const std::vector< uint8_t > keyBytes(key.begin(), key.end());
+        const std::vector< uint8_t > messageBytes(message.begin(), message.end());
+        const auto expected = hmacHex(key, message);
+        EXPECT_EQ(expected, hmacRaw(key, message)) << keyLength;
+        EXPECT_EQ(expected, hmacBytesHex(keyBytes, messageBytes)) << keyLength;
+        EXPECT_EQ(expected, hmacBytesRaw(keyBytes, messageBytes)) << keyLength;
+    }
+}
+
+TEST(HmacTests, HmacSha256FromRawHash) {
+    // This test vector was taken from RFC 4231 (test case 2).
+    const auto hmac = Hash::MakeHmacStringToStringFunctionFromRawHash(Hash::StringToBytes< Hash::Sha256 >, 64);
+    EXPECT_EQ(
+        "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+        hmac("Jefe", "what do ya want for nothing?")
+    );
+}
+
+TEST(HmacTests, HashOutputWhichIsNotHexThrows) {
+    const auto hmacOddLength = Hash::MakeHmacStringToStringFunction(
+        [](const std::string&) { return std::string("abc"); },
+        64
+    );
+    EXPECT_THROW(hmacOddLength("key", "message"), std::invalid_argument);
+    const auto hmacNotHex = Hash::MakeHmacBytesToStringFunction(
+        [](const std::vector< uint8_t >&) { return std::string("xy"); },
+        64
+    );
+    EXPECT_THROW(hmacNotHex({'k'}, {'m'}), std::invalid_argument);
+}
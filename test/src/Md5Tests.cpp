@@ -9,9 +9,12 @@
 #include <gtest/gtest.h>
 #include <Hash/Md5.hpp>
 #include <Hash/Templates.hpp>
+#include <src/Md5Kernels.hpp>
+#include <src/MultiBuffer.hpp>
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <string.h>
 #include <sstream>
 #include <vector>
 
@@ -35,3 +38,116 @@ TEST(Md5Tests, HashTestVectors) {
         );
     }
 }
+
+TEST(Md5Tests, ContextMatchesOneShotFunctionForAnyPieceSizes) {
+    std::vector< uint8_t > message(1000);
+    for (size_t i = 0; i < message.size(); ++i) {
+        message[i] = (uint8_t)(i * 7 + 3);
+    }
+    Hash::Md5Context context;
+    for (size_t pieceSize: {1, 3, 55, 56, 64, 100, 1000}) {
+        for (size_t offset = 0; offset < message.size(); offset += pieceSize) {
+            context.Update(
+                message.data() + offset,
+                std::min(pieceSize, message.size() - offset)
+            );
+        }
+        EXPECT_EQ(Hash::Md5(message), context.Final()) << "Piece size: " << pieceSize;
+    }
+}
+
+TEST(Md5Tests, BatchMatchesOneShotFunction) {
+    std::vector< std::vector< uint8_t > > messages;
+    for (size_t length = 0; length < 300; length += 3) {
+        std::vector< uint8_t > message(length);
+        for (size_t i = 0; i < length; ++i) {
+            message[i] = (uint8_t)(i * length + 1);
+        }
+        messages.push_back(std::move(message));
+    }
+    const auto digests = Hash::Md5Batch(messages);
+    ASSERT_EQ(messages.size() * 16, digests.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(
+            Hash::Md5(messages[i]),
+            std::vector< uint8_t >(
+                digests.begin() + i * 16,
+                digests.begin() + (i + 1) * 16
+            )
+        ) << "Message #" << i;
+    }
+}
+
+TEST(Md5Tests, MultiBufferKernelsInLanes) {
+    // The batch function only uses the fastest multi-buffer kernel the CPU
+    // supports, so drive each kernel directly here.
+#if HASH_TARGET_X86
+    const uint32_t initialHashValues[4] = {
+        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476
+    };
+    std::vector< std::vector< uint8_t > > messages;
+    std::vector< const uint8_t* > pointers;
+    std::vector< size_t > lengths;
+    for (size_t length = 0; length < 300; length += 7) {
+        std::vector< uint8_t > message(length);
+        for (size_t i = 0; i < length; ++i) {
+            message[i] = (uint8_t)(i * length);
+        }
+        messages.push_back(std::move(message));
+    }
+    for (const auto& message: messages) {
+        pointers.push_back(message.data());
+        lengths.push_back(message.size());
+    }
+    const auto& features = Hash::Internal::GetCpuFeatures();
+    for (size_t kernel = 0; kernel < 2; ++kernel) {
+        std::vector< uint8_t > digests(messages.size() * 16);
+        if (kernel == 0) {
+            if (!features.avx2) {
+                continue;
+            }
+            Hash::Internal::HashInLanes< uint32_t, 4, 8, 64, 8, false >(
+                pointers.data(),
+                lengths.data(),
+                messages.size(),
+                initialHashValues,
+                digests.data(),
+                16,
+                Hash::Internal::Md5CompressAvx2x8
+            );
+        } else {
+            if (!features.avx512) {
+                continue;
+            }
+            Hash::Internal::HashInLanes< uint32_t, 4, 16, 64, 8, false >(
+                pointers.data(),
+                lengths.data(),
+                messages.size(),
+                initialHashValues,
+                digests.data(),
+                16,
+                Hash::Internal::Md5CompressAvx512x16
+            );
+        }
+        for (size_t i = 0; i < messages.size(); ++i) {
+            EXPECT_EQ(
+                Hash::Md5(messages[i]),
+                std::vector< uint8_t >(
+                    digests.begin() + i * 16,
+                    digests.begin() + (i + 1) * 16
+                )
+            ) << "Kernel #" << kernel << ", message #" << i;
+        }
+    }
+#endif
+}
+
+TEST(Md5Tests, FixedSizeDigestMatchesVectorFunction) {
+    const std::string input = "The quick brown fox jumps over the lazy dog";
+    const std::vector< uint8_t > data(input.begin(), input.end());
+    const auto digest = Hash::ComputeMd5(input.data(), input.length());
+    EXPECT_EQ(Hash::Md5(data), std::vector< uint8_t >(digest.begin(), digest.end()));
+    uint8_t buffer[Hash::MD5_DIGEST_LENGTH / 8];
+    Hash::ComputeMd5(input.data(), input.length(), buffer);
+    EXPECT_EQ(0, memcmp(digest.data(), buffer, sizeof(buffer)));
+}
@@ -0,0 +1,305 @@
+/**
+ * @file OtpStoreTests.cpp
+ *
+ * This module contains the unit tests of the Hash::OtpStore class.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Hash/OtpStore.hpp>
+#include <Hash/OtpVerifier.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the path of the store file used in the tests.
+     */
+    const std::string storePath = "OtpStoreTests.store";
+
+    /**
+     * This function reads the whole contents of the given file.
+     *
+     * @param[in] path
+     *     This is the path of the file to read.
+     *
+     * @return
+     *     The contents of the file are returned.
+     */
+    std::vector< uint8_t > ReadFile(const std::string& path) {
+        std::vector< uint8_t > contents;
+        const auto file = fopen(path.c_str(), "rb");
+        if (file != NULL) {
+            uint8_t buffer[4096];
+            size_t amount;
+            while ((amount = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                contents.insert(contents.end(), buffer, buffer + amount);
+            }
+            (void)fclose(file);
+        }
+        return contents;
+    }
+
+    /**
+     * This function replaces the contents of the given file.
+     *
+     * @param[in] path
+     *     This is the path of the file to write.
+     *
+     * @param[in] contents
+     *     These are the new contents of the file.
+     */
+    void WriteFile(const std::string& path, const std::vector< uint8_t >& contents) {
+        const auto file = fopen(path.c_str(), "wb");
+        ASSERT_FALSE(file == NULL);
+        (void)fwrite(contents.data(), 1, contents.size(), file);
+        (void)fclose(file);
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct OtpStoreTests
+    : public ::testing::Test
+{
+    // TestFixture
+
+    virtual void TearDown() override {
+        (void)remove(storePath.c_str());
+    }
+};
+
+TEST_F(OtpStoreTests, TotpCodeTestVectors) {
+    // These test vectors were taken from [RFC
+    // 6238](https://tools.ietf.org/html/rfc6238) Appendix B.
+    struct TestVector {
+        Hash::OtpStoreAlgorithm algorithm;
+        std::string secret;
+        std::vector< int > totps;
+    };
+    const std::vector< uint64_t > times{59, 1111111109, 1111111111, 1234567890, 2000000000, 20000000000};
+    const std::vector< TestVector > testVectors{
+        {
+            Hash::OtpStoreAlgorithm::Sha1,
+            "12345678901234567890",
+            {94287082, 7081804, 14050471, 89005924, 69279037, 65353130},
+        },
+        {
+            Hash::OtpStoreAlgorithm::Sha256,
+            "12345678901234567890123456789012",
+            {46119246, 68084774, 67062674, 91819424, 90698825, 77737706},
+        },
+        {
+            Hash::OtpStoreAlgorithm::Sha512,
+            "1234567890123456789012345678901234567890123456789012345678901234",
+            {90693936, 25091201, 99943326, 93441116, 38618901, 47863826},
+        },
+    };
+    for (const auto& testVector: testVectors) {
+        ASSERT_TRUE(
+            Hash::OtpStore::Write(
+                storePath,
+                testVector.algorithm,
+                8,
+                {"other secret", testVector.secret}
+            )
+        );
+        Hash::OtpStore store;
+        ASSERT_TRUE(store.Open(storePath));
+        EXPECT_EQ(2, store.Size());
+        EXPECT_EQ(testVector.algorithm, store.GetAlgorithm());
+        EXPECT_EQ(8, store.GetDigits());
+        for (size_t i = 0; i < times.size(); ++i) {
+            EXPECT_EQ(testVector.totps[i], store.Totp(1, times[i], 0, 30));
+        }
+    }
+}
+
+TEST_F(OtpStoreTests, MatchesVerifierForManySecrets) {
+    std::vector< std::string > secrets;
+    for (size_t i = 0; i < 2500; ++i) {
+        secrets.push_back(std::string(i % 150, (char)('a' + i % 26)));
+    }
+    ASSERT_TRUE(Hash::OtpStore::Write(storePath, Hash::OtpStoreAlgorithm::Sha1, 6, secrets));
+    Hash::OtpStore store;
+    ASSERT_TRUE(store.Open(storePath));
+    ASSERT_EQ(secrets.size(), store.Size());
+    for (size_t i = 0; i < secrets.size(); i += 97) {
+        Hash::OtpSha1Verifier verifier(secrets[i], 6);
+        for (uint64_t count = 0; count < 3; ++count) {
+            EXPECT_EQ(verifier.Hotp(count), store.Hotp(i, count)) << i;
+        }
+    }
+}
+
+TEST_F(OtpStoreTests, VerifyWindows) {
+    ASSERT_TRUE(
+        Hash::OtpStore::Write(
+            storePath,
+            Hash::OtpStoreAlgorithm::Sha1,
+            6,
+            {"12345678901234567890"}
+        )
+    );
+    Hash::OtpStore store;
+    ASSERT_TRUE(store.Open(storePath));
+    uint64_t nextCount = 0;
+    EXPECT_TRUE(store.VerifyHotp(0, 969429, 0, 5, nextCount));
+    EXPECT_EQ(4, nextCount);
+    EXPECT_FALSE(store.VerifyHotp(0, 520489, 0, 8, nextCount));
+    const uint64_t time = 1111111111;
+    int64_t drift = 0;
+    EXPECT_TRUE(store.VerifyTotp(0, store.Totp(0, time - 60, 0, 30), time, 0, 30, 2, drift));
+    EXPECT_EQ(-2, drift);
+    EXPECT_FALSE(store.VerifyTotp(0, store.Totp(0, time + 90, 0, 30), time, 0, 30, 2, drift));
+}
+
+TEST_F(OtpStoreTests, IndexOutOfRangeFails) {
+    ASSERT_TRUE(Hash::OtpStore::Write(storePath, Hash::OtpStoreAlgorithm::Sha1, 6, {"first", "second"}));
+    Hash::OtpStore store;
+    ASSERT_TRUE(store.Open(storePath));
+    EXPECT_NE(-1, store.Hotp(1, 0));
+    EXPECT_EQ(-1, store.Hotp(2, 0));
+    EXPECT_EQ(-1, store.Totp((size_t)-1, 59, 0, 30));
+    uint64_t nextCount = 0;
+    EXPECT_FALSE(store.VerifyHotp(2, -1, 0, 5, nextCount));
+    int64_t drift = 0;
+    EXPECT_FALSE(store.VerifyTotp(2, -1, 59, 0, 30, 2, drift));
+}
+
+TEST_F(OtpStoreTests, ClosedStoreFails) {
+    Hash::OtpStore neverOpened;
+    EXPECT_EQ(-1, neverOpened.Hotp(0, 0));
+    ASSERT_TRUE(Hash::OtpStore::Write(storePath, Hash::OtpStoreAlgorithm::Sha1, 6, {"secret"}));
+    Hash::OtpStore store;
+    ASSERT_TRUE(store.Open(storePath));
+    const auto password = store.Hotp(0, 0);
+    store.Close();
+    EXPECT_EQ(-1, store.Hotp(0, 0));
+    EXPECT_EQ(-1, store.Totp(0, 59, 0, 30));
+    uint64_t nextCount = 0;
+    EXPECT_FALSE(store.VerifyHotp(0, password, 0, 5, nextCount));
+    int64_t drift = 0;
+    EXPECT_FALSE(store.VerifyTotp(0, password, 59, 0, 30, 2, drift));
+}
+
+TEST_F(OtpStoreTests, MovedFromStoreIsEmpty) {
+    ASSERT_TRUE(Hash::OtpStore::Write(storePath, Hash::OtpStoreAlgorithm::Sha256, 8, {"secret"}));
+    Hash::OtpStore store;
+    ASSERT_TRUE(store.Open(storePath));
+    const auto password = store.Hotp(0, 0);
+    Hash::OtpStore movedTo(std::move(store));
+    EXPECT_EQ(password, movedTo.Hotp(0, 0));
+    EXPECT_EQ(0, store.Size());
+    EXPECT_EQ(0, store.GetDigits());
+    EXPECT_EQ(-1, store.Hotp(0, 0));
+    EXPECT_EQ(-1, store.Totp(0, 59, 0, 30));
+    uint64_t nextCount = 0;
+    EXPECT_FALSE(store.VerifyHotp(0, password, 0, 5, nextCount));
+    int64_t drift = 0;
+    EXPECT_FALSE(store.VerifyTotp(0, password, 59, 0, 30, 2, drift));
+    Hash::OtpStore assigned;
+    assigned = std::move(movedTo);
+    EXPECT_EQ(password, assigned.Hotp(0, 0));
+    EXPECT_EQ(0, movedTo.Size());
+    EXPECT_EQ(-1, movedTo.Hotp(0, 0));
+    movedTo.Close();
+    ASSERT_TRUE(store.Open(storePath));
+    EXPECT_EQ(1, store.Size());
+    EXPECT_EQ(Hash::OtpStoreAlgorithm::Sha256, store.GetAlgorithm());
+    EXPECT_EQ(password, store.Hotp(0, 0));
+}
+
+TEST_F(OtpStoreTests, RewritingLeavesOpenStoreIntact) {
+    const std::vector< std::string > secrets{"first", "second", "third"};
+    ASSERT_TRUE(Hash::OtpStore::Write(storePath, Hash::OtpStoreAlgorithm::Sha1, 6, secrets));
+    Hash::OtpStore oldStore;
+    ASSERT_TRUE(oldStore.Open(storePath));
+    std::vector< int > oldPasswords;
+    for (size_t i = 0; i < secrets.size(); ++i) {
+        oldPasswords.push_back(oldStore.Hotp(i, 0));
+    }
+    ASSERT_TRUE(Hash::OtpStore::Write(storePath, Hash::OtpStoreAlgorithm::Sha1, 6, {"new"}));
+
+    // The store which was already open still has the old file, while
+    // opening the store again gives the new one.
+    EXPECT_EQ(secrets.size(), oldStore.Size());
+    for (size_t i = 0; i < secrets.size(); ++i) {
+        EXPECT_EQ(oldPasswords[i], oldStore.Hotp(i, 0)) << i;
+    }
+    Hash::OtpStore newStore;
+    ASSERT_TRUE(newStore.Open(storePath));
+    EXPECT_EQ(1, newStore.Size());
+    EXPECT_EQ(Hash::OtpSha1Verifier("new", 6).Hotp(0), newStore.Hotp(0, 0));
+}
+
+TEST_F(OtpStoreTests, FailedWriteLeavesOldFile) {
+    EXPECT_FALSE(
+        Hash::OtpStore::Write(
+            "no such directory/" + storePath,
+            Hash::OtpStoreAlgorithm::Sha1,
+            6,
+            {"secret"}
+        )
+    );
+    ASSERT_TRUE(Hash::OtpStore::Write(storePath, Hash::OtpStoreAlgorithm::Sha1, 6, {"secret"}));
+    EXPECT_FALSE(
+        Hash::OtpStore::Write(
+            storePath,
+            (Hash::OtpStoreAlgorithm)9,
+            6,
+            {"other"}
+        )
+    );
+    Hash::OtpStore store;
+    ASSERT_TRUE(store.Open(storePath));
+    EXPECT_EQ(Hash::OtpSha1Verifier("secret", 6).Hotp(0), store.Hotp(0, 0));
+}
+
+TEST_F(OtpStoreTests, RejectsInvalidFiles) {
+    Hash::OtpStore store;
+    EXPECT_FALSE(store.Open(storePath));
+    EXPECT_EQ(0, store.Size());
+    ASSERT_TRUE(
+        Hash::OtpStore::Write(
+            storePath,
+            Hash::OtpStoreAlgorithm::Sha256,
+            6,
+            {"a", "b", "c"}
+        )
+    );
+    const auto contents = ReadFile(storePath);
+    ASSERT_TRUE(store.Open(storePath));
+    EXPECT_EQ(3, store.Size());
+    store.Close();
+    EXPECT_EQ(0, store.Size());
+    auto corrupted = contents;
+    corrupted[0] = 'X';
+    WriteFile(storePath, corrupted);
+    EXPECT_FALSE(store.Open(storePath));
+    corrupted = contents;
+    corrupted[8] = 2;
+    WriteFile(storePath, corrupted);
+    EXPECT_FALSE(store.Open(storePath));
+    corrupted = contents;
+    corrupted[12] = 9;
+    WriteFile(storePath, corrupted);
+    EXPECT_FALSE(store.Open(storePath));
+    corrupted = contents;
+    corrupted.pop_back();
+    WriteFile(storePath, corrupted);
+    EXPECT_FALSE(store.Open(storePath));
+    EXPECT_EQ(0, store.Size());
+    WriteFile(storePath, contents);
+    EXPECT_TRUE(store.Open(storePath));
+    EXPECT_EQ(3, store.Size());
+}
@@ -0,0 +1,136 @@
+/**
+ * @file OtpVerifierTests.cpp
+ *
+ * This module contains the unit tests of the Hash::OtpVerifier class
+ * template.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <gtest/gtest.h>
+#include <Hash/Hotp.hpp>
+#include <Hash/OtpVerifier.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <Hash/Totp.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(OtpVerifierTests, HotpCodeTestVectors) {
+    // These test vectors were taken from [RFC
+    // 4226](https://tools.ietf.org/html/rfc4226) Appendix D.
+    Hash::OtpSha1Verifier verifier("12345678901234567890", 6);
+    const std::vector< int > hotps{
+        755224, 287082, 359152, 969429, 338314,
+        254676, 287922, 162583, 399871, 520489,
+    };
+    for (size_t count = 0; count < hotps.size(); ++count) {
+        EXPECT_EQ(hotps[count], verifier.Hotp(count));
+    }
+}
+
+TEST(OtpVerifierTests, TotpCodeTestVectors) {
+    // These test vectors were taken from [RFC
+    // 6238](https://tools.ietf.org/html/rfc6238) Appendix B.
+    Hash::OtpSha1Verifier sha1("12345678901234567890", 8);
+    Hash::OtpSha256Verifier sha256("12345678901234567890123456789012", 8);
+    Hash::OtpSha512Verifier sha512("1234567890123456789012345678901234567890123456789012345678901234", 8);
+    struct TestVector {
+        uint64_t time;
+        int sha1;
+        int sha256;
+        int sha512;
+    };
+    const std::vector< TestVector > testVectors{
+        {59, 94287082, 46119246, 90693936},
+        {1111111109, 7081804, 68084774, 25091201},
+        {1111111111, 14050471, 67062674, 99943326},
+        {1234567890, 89005924, 91819424, 93441116},
+        {2000000000, 69279037, 90698825, 38618901},
+        {20000000000, 65353130, 77737706, 47863826},
+    };
+    for (const auto& testVector: testVectors) {
+        EXPECT_EQ(testVector.sha1, sha1.Totp(testVector.time, 0, 30));
+        EXPECT_EQ(testVector.sha256, sha256.Totp(testVector.time, 0, 30));
+        EXPECT_EQ(testVector.sha512, sha512.Totp(testVector.time, 0, 30));
+    }
+}
+
+TEST(OtpVerifierTests, MatchesHotpForAllDigitCounts) {
+    const std::string secret = "12345678901234567890";
+    for (size_t digits = 1; digits <= 10; ++digits) {
+        Hash::OtpSha1Verifier verifier(secret, digits);
+        for (uint64_t count = 0; count < 20; ++count) {
+            EXPECT_EQ(
+                Hash::Hotp(Hash::Sha1, Hash::SHA1_BLOCK_SIZE, secret, count, digits),
+                verifier.Hotp(count)
+            ) << digits << " " << count;
+        }
+    }
+}
+
+TEST(OtpVerifierTests, VerifyHotpWithLookAhead) {
+    Hash::OtpSha1Verifier verifier("12345678901234567890", 6);
+    uint64_t nextCount = 0;
+    EXPECT_TRUE(verifier.VerifyHotp(969429, 0, 5, nextCount));
+    EXPECT_EQ(4, nextCount);
+    nextCount = 0;
+    EXPECT_TRUE(verifier.VerifyHotp(755224, 0, 0, nextCount));
+    EXPECT_EQ(1, nextCount);
+    nextCount = 42;
+    EXPECT_FALSE(verifier.VerifyHotp(520489, 0, 8, nextCount));
+    EXPECT_EQ(42, nextCount);
+    EXPECT_TRUE(verifier.VerifyHotp(520489, 0, 9, nextCount));
+    EXPECT_EQ(10, nextCount);
+    EXPECT_FALSE(verifier.VerifyHotp(755224, 1, 9, nextCount));
+}
+
+TEST(OtpVerifierTests, VerifyTotpWithDriftWindow) {
+    Hash::OtpSha1Verifier verifier("12345678901234567890", 8);
+    const uint64_t time = 1111111111;
+    int64_t drift = 99;
+    EXPECT_TRUE(verifier.VerifyTotp(verifier.Totp(time, 0, 30), time, 0, 30, 0, drift));
+    EXPECT_EQ(0, drift);
+    EXPECT_TRUE(verifier.VerifyTotp(verifier.Totp(time - 60, 0, 30), time, 0, 30, 2, drift));
+    EXPECT_EQ(-2, drift);
+    EXPECT_TRUE(verifier.VerifyTotp(verifier.Totp(time + 30, 0, 30), time, 0, 30, 2, drift));
+    EXPECT_EQ(1, drift);
+    drift = 99;
+    EXPECT_FALSE(verifier.VerifyTotp(verifier.Totp(time + 90, 0, 30), time, 0, 30, 2, drift));
+    EXPECT_EQ(99, drift);
+}
+
+TEST(OtpVerifierTests, VerifyTotpWindowStopsAtFirstStep) {
+    Hash::OtpSha1Verifier verifier("12345678901234567890", 6);
+    int64_t drift = 99;
+    EXPECT_TRUE(verifier.VerifyTotp(verifier.Totp(0, 0, 30), 45, 0, 30, 5, drift));
+    EXPECT_EQ(-1, drift);
+}
+
+TEST(OtpVerifierTests, SharedByThreads) {
+    const Hash::OtpSha1Verifier verifier("12345678901234567890", 6);
+    const std::vector< int > hotps{
+        755224, 287082, 359152, 969429, 338314,
+        254676, 287922, 162583, 399871, 520489,
+    };
+    std::vector< std::thread > threads;
+    std::vector< size_t > mismatches(4);
+    for (size_t i = 0; i < mismatches.size(); ++i) {
+        threads.emplace_back([&, i]{
+            for (size_t round = 0; round < 100; ++round) {
+                for (size_t count = 0; count < hotps.size(); ++count) {
+                    if (verifier.Hotp(count) != hotps[count]) {
+                        ++mismatches[i];
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    EXPECT_EQ(std::vector< size_t >(mismatches.size(), 0), mismatches);
+}
@@ -6,18 +6,62 @@
  * © 2018 by Richard Walters
  */
 
+#include <atomic>
+#include <chrono>
 #include <gtest/gtest.h>
+#include <Hash/Hex.hpp>
+#include <Hash/Md5.hpp>
 #include <Hash/Sha1.hpp>
 #include <Hash/Sha2.hpp>
 #include <Hash/Templates.hpp>
 #include <Hash/Hmac.hpp>
+#include <Hash/HmacKeyCache.hpp>
 #include <Hash/Pbkdf2.hpp>
+#include <src/Pbkdf2Hmac.hpp>
+#include <src/Sha2Kernels.hpp>
 #include <stddef.h>
+#include <stdexcept>
 #include <stdint.h>
 #include <string>
 #include <sstream>
 #include <vector>
 
+namespace {
+
+    /**
+     * This function returns an HMAC function which calls the given hash
+     * function through a function object the library doesn't recognize,
+     * so that Pbkdf2 calls it for every iteration, as it would for any
+     * other pseudorandom function.
+     *
+     * @param[in] hashFunction
+     *     This is the hash function to use.
+     *
+     * @param[in] blockSize
+     *     This is the block size of the hash function, in bytes.
+     *
+     * @return
+     *     The HMAC function is returned.
+     */
+    std::function<
+        std::vector< uint8_t >(
+            const std::vector< uint8_t >&,
+            const std::vector< uint8_t >&
+        )
+    > MakeGeneralHmac(
+        Hash::HashFunction hashFunction,
+        size_t blockSize
+    ) {
+        return Hash::MakeHmacBytesToBytesFunction(
+            [hashFunction](const std::vector< uint8_t >& message) {
+                return hashFunction(message);
+            },
+            blockSize
+        );
+    }
+
+}
+
 TEST(Pbkdf2Tests, Pbkdf2TestVectors) {
     // These test vectors were taken from:
     // https://en.wikipedia.org/wiki/PBKDF2
@@ -276,3 +320,441 @@ TEST(Pbkdf2Tests, Pbkdf2TestVectors) {
         ) << "Iteration #" << iteration;
     }
 }
+
+TEST(Pbkdf2Tests, Pbkdf2HmacTestVectors) {
+    // These test vectors were taken from RFC 6070 and from
+    // https://stackoverflow.com/questions/5130513/pbkdf2-hmac-sha2-test-vectors
+    const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    EXPECT_EQ(
+        "4b007901b765489abead49d926f721d065a429c1",
+        Hash::EncodeHex(Hash::Pbkdf2HmacSha1(password, salt, 4096, 20))
+    );
+    EXPECT_EQ(
+        "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a",
+        Hash::EncodeHex(Hash::Pbkdf2HmacSha256(password, salt, 4096, 32))
+    );
+    EXPECT_EQ(
+        "d197b1b33db0143e018b12f3d1d1479e6cdebdcc97c5c0f87f6902e072f457b5"
+        "143f30602641b3d55cd335988cb36b84376060ecd532e039b742a239434af2d5",
+        Hash::EncodeHex(Hash::Pbkdf2HmacSha512(password, salt, 4096, 64))
+    );
+}
+
+TEST(Pbkdf2Tests, Pbkdf2HmacMatchesGeneralForm) {
+    struct Variant {
+        std::vector< uint8_t > (*hash)(const std::vector< uint8_t >&);
+        size_t blockSize;
+        size_t hLen;
+        std::vector< uint8_t > (*pbkdf2)(
+            const std::vector< uint8_t >&,
+            const std::vector< uint8_t >&,
+            size_t,
+            size_t,
+            Hash::Pbkdf2Executor
+        );
+    };
+    const std::vector< Variant > variants{
+        {Hash::Sha1, Hash::SHA1_BLOCK_SIZE, Hash::SHA1_DIGEST_LENGTH, Hash::Pbkdf2HmacSha1},
+        {Hash::Sha256, Hash::SHA256_BLOCK_SIZE, Hash::SHA256_DIGEST_LENGTH, Hash::Pbkdf2HmacSha256},
+        {Hash::Sha512, Hash::SHA512_BLOCK_SIZE, Hash::SHA512_DIGEST_LENGTH, Hash::Pbkdf2HmacSha512},
+    };
+    for (const auto& variant: variants) {
+        const auto prf = MakeGeneralHmac(variant.hash, variant.blockSize);
+        for (size_t passwordLength: {0, 5, 64, 128, 129, 300}) {
+            std::vector< uint8_t > password(passwordLength);
+            for (size_t i = 0; i < passwordLength; ++i) {
+                password[i] = (uint8_t)(i * 3 + 1);
+            }
+            for (size_t saltLength: {0, 16, 60, 124, 200}) {
+                std::vector< uint8_t > salt(saltLength);
+                for (size_t i = 0; i < saltLength; ++i) {
+                    salt[i] = (uint8_t)(i * 5 + 2);
+                }
+                for (size_t c: {1, 2, 17}) {
+                    const size_t dkLen = variant.hLen / 8 * 2 + 3;
+                    EXPECT_EQ(
+                        Hash::Pbkdf2(prf, variant.hLen, password, salt, c, dkLen),
+                        variant.pbkdf2(password, salt, c, dkLen, nullptr)
+                    ) << variant.hLen << ", " << passwordLength << ", " << saltLength << ", " << c;
+                }
+            }
+        }
+    }
+}
+
+TEST(Pbkdf2Tests, ParallelMatchesSerial) {
+    const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    const auto prf = Hash::MakeHmacBytesToBytesFunction(Hash::Sha1, Hash::SHA1_BLOCK_SIZE);
+    for (size_t dkLen: {1, 20, 21, 64, 100}) {
+        EXPECT_EQ(
+            Hash::Pbkdf2(prf, Hash::SHA1_DIGEST_LENGTH, password, salt, 100, dkLen),
+            Hash::Pbkdf2Parallel(prf, Hash::SHA1_DIGEST_LENGTH, password, salt, 100, dkLen)
+        ) << dkLen;
+        EXPECT_EQ(
+            Hash::Pbkdf2HmacSha1(password, salt, 100, dkLen),
+            Hash::Pbkdf2HmacSha1(password, salt, 100, dkLen, Hash::Pbkdf2ThreadExecutor)
+        ) << dkLen;
+        EXPECT_EQ(
+            Hash::Pbkdf2HmacSha256(password, salt, 100, dkLen),
+            Hash::Pbkdf2HmacSha256(password, salt, 100, dkLen, Hash::Pbkdf2ThreadExecutor)
+        ) << dkLen;
+        EXPECT_EQ(
+            Hash::Pbkdf2HmacSha512(password, salt, 100, dkLen),
+            Hash::Pbkdf2HmacSha512(password, salt, 100, dkLen, Hash::Pbkdf2ThreadExecutor)
+        ) << dkLen;
+    }
+}
+
+TEST(Pbkdf2Tests, ParallelUsesGivenExecutor) {
+    const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    std::vector< size_t > counts;
+    const auto executor = [&counts](
+        size_t count,
+        std::function< void(size_t index) > task
+    ) {
+        counts.push_back(count);
+        for (size_t index = count; index > 0; --index) {
+            task(index - 1);
+        }
+    };
+    EXPECT_EQ(
+        Hash::Pbkdf2HmacSha256(password, salt, 10, 80),
+        Hash::Pbkdf2HmacSha256(password, salt, 10, 80, executor)
+    );
+    EXPECT_EQ(std::vector< size_t >{3}, counts);
+    counts.clear();
+    (void)Hash::Pbkdf2HmacSha256(password, salt, 10, 32, executor);
+    EXPECT_TRUE(counts.empty());
+}
+
+TEST(Pbkdf2Tests, ThreadExecutorRunsEveryTaskOnce) {
+    for (size_t count: {0, 1, 2, 7, 100}) {
+        std::vector< std::atomic< size_t > > calls(count);
+        for (size_t round = 0; round < 3; ++round) {
+            Hash::Pbkdf2ThreadExecutor(
+                count,
+                [&calls](size_t index) {
+                    ++calls[index];
+                }
+            );
+        }
+        for (size_t index = 0; index < count; ++index) {
+            EXPECT_EQ(3, calls[index]) << count << ", " << index;
+        }
+    }
+}
+
+TEST(Pbkdf2Tests, ThreadExecutorRethrowsTaskException) {
+    std::atomic< size_t > calls(0);
+    EXPECT_THROW(
+        Hash::Pbkdf2ThreadExecutor(
+            16,
+            [&calls](size_t index) {
+                ++calls;
+                if (index == 3) {
+                    throw std::runtime_error("task failed");
+                }
+            }
+        ),
+        std::runtime_error
+    );
+    EXPECT_GE(calls, 1);
+    EXPECT_LE(calls, 16);
+
+    // The executor is still usable afterwards.
+    calls = 0;
+    Hash::Pbkdf2ThreadExecutor(
+        16,
+        [&calls](size_t) {
+            ++calls;
+        }
+    );
+    EXPECT_EQ(16, calls);
+}
+
+TEST(Pbkdf2Tests, ParallelSplitsLanesAmongExecutorTasks) {
+    const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    std::vector< size_t > counts;
+    const auto executor = [&counts](
+        size_t count,
+        std::function< void(size_t index) > task
+    ) {
+        counts.push_back(count);
+        for (size_t index = 0; index < count; ++index) {
+            task(index);
+        }
+    };
+
+    // Even when the blocks would all fit in the lanes of one multi-buffer
+    // kernel, each is given its own task, so that the executor may
+    // compute them concurrently.
+    EXPECT_EQ(
+        Hash::Pbkdf2HmacSha256(password, salt, 10, 64),
+        Hash::Pbkdf2HmacSha256(password, salt, 10, 64, executor)
+    );
+    EXPECT_EQ(
+        Hash::Pbkdf2HmacSha256(password, salt, 10, 128),
+        Hash::Pbkdf2HmacSha256(password, salt, 10, 128, executor)
+    );
+    EXPECT_EQ(
+        Hash::Pbkdf2HmacSha512(password, salt, 10, 128),
+        Hash::Pbkdf2HmacSha512(password, salt, 10, 128, executor)
+    );
+    EXPECT_EQ((std::vector< size_t >{2, 4, 2}), counts);
+}
+
+TEST(Pbkdf2Tests, Pbkdf2HmacLanesKernelsAgree) {
+    const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    const auto sha256 = Hash::Internal::KeyHmac< uint32_t, 8, 32, 64, 8 >(
+        password.data(),
+        password.size(),
+        Hash::Internal::Sha256InitialHashValues,
+        Hash::Internal::Sha256Compress
+    );
+    const auto sha512 = Hash::Internal::KeyHmac< uint64_t, 8, 64, 128, 16 >(
+        password.data(),
+        password.size(),
+        Hash::Internal::Sha512InitialHashValues,
+        Hash::Internal::Sha512Compress
+    );
+    const size_t numChains = 11;
+    std::vector< uint8_t > expected256;
+    std::vector< uint8_t > expected512;
+    std::vector< Hash::Internal::Pbkdf2Chain< uint32_t, 8 > > chains256(numChains);
+    std::vector< Hash::Internal::Pbkdf2Chain< uint64_t, 8 > > chains512(numChains);
+    std::vector< uint8_t > actual256(numChains * 32);
+    std::vector< uint8_t > actual512(numChains * 64);
+    for (size_t i = 0; i < numChains; ++i) {
+        const size_t c = 1 + i * 7 % 20;
+        const auto block256 = Hash::Pbkdf2HmacSha256(password, salt, c, 32 * (i + 1));
+        expected256.insert(expected256.end(), block256.end() - 32, block256.end());
+        chains256[i] = {&sha256, salt.data(), salt.size(), i + 1, c, actual256.data() + i * 32, 32};
+        const auto block512 = Hash::Pbkdf2HmacSha512(password, salt, c, 64 * (i + 1));
+        expected512.insert(expected512.end(), block512.end() - 64, block512.end());
+        chains512[i] = {&sha512, salt.data(), salt.size(), i + 1, c, actual512.data() + i * 64, 64};
+    }
+#if HASH_TARGET_X86
+    const auto& features = Hash::Internal::GetCpuFeatures();
+    if (features.avx2) {
+        Hash::Internal::Pbkdf2HmacChainsInLanes< uint32_t, 8, 32, 64, 8, 8 >(
+            chains256.data(),
+            numChains,
+            Hash::Internal::Sha256Compress,
+            Hash::Internal::Sha256CompressAvx2x8,
+            8
+        );
+        EXPECT_EQ(expected256, actual256);
+        Hash::Internal::Pbkdf2HmacChainsInLanes< uint64_t, 8, 64, 128, 16, 4 >(
+            chains512.data(),
+            numChains,
+            Hash::Internal::Sha512Compress,
+            Hash::Internal::Sha512CompressAvx2x4,
+            4
+        );
+        EXPECT_EQ(expected512, actual512);
+    }
+    if (features.avx512) {
+        actual512.assign(actual512.size(), 0);
+        Hash::Internal::Pbkdf2HmacChainsInLanes< uint64_t, 8, 64, 128, 16, 8 >(
+            chains512.data(),
+            numChains,
+            Hash::Internal::Sha512Compress,
+            Hash::Internal::Sha512CompressAvx512x8,
+            8
+        );
+        EXPECT_EQ(expected512, actual512);
+    }
+#endif
+}
+
+TEST(Pbkdf2Tests, Pbkdf2HmacBatchMatchesOneAtATime) {
+    struct Input {
+        std::vector< uint8_t > password;
+        std::vector< uint8_t > salt;
+        size_t c;
+        size_t dkLen;
+    };
+    std::vector< Input > inputs;
+    for (size_t i = 0; i < 19; ++i) {
+        Input input;
+        input.password.assign(i * 11 % 150, (uint8_t)i);
+        input.salt.assign(i * 13 % 140, (uint8_t)(i + 100));
+        input.c = 1 + i * 37 % 60;
+        input.dkLen = 1 + i * 29 % 150;
+        inputs.push_back(input);
+    }
+    using OneAtATime = std::vector< uint8_t >(*)(
+        const std::vector< uint8_t >&,
+        const std::vector< uint8_t >&,
+        size_t,
+        size_t,
+        Hash::Pbkdf2Executor
+    );
+    using Batch = void(*)(const Hash::Pbkdf2Job*, size_t);
+    const std::vector< std::pair< OneAtATime, Batch > > variants{
+        {Hash::Pbkdf2HmacSha1, Hash::Pbkdf2HmacBatch< Hash::Sha1Context >},
+        {Hash::Pbkdf2HmacSha256, Hash::Pbkdf2HmacBatch< Hash::Sha256Context >},
+        {Hash::Pbkdf2HmacSha512, Hash::Pbkdf2HmacBatch< Hash::Sha512Context >},
+        {Hash::Pbkdf2Hmac< Hash::Sha384Context >, Hash::Pbkdf2HmacBatch< Hash::Sha384Context >},
+    };
+    for (const auto& variant: variants) {
+        std::vector< std::vector< uint8_t > > dks(inputs.size());
+        std::vector< Hash::Pbkdf2Job > jobs;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            const auto& input = inputs[i];
+            dks[i].resize(input.dkLen);
+            jobs.push_back({
+                input.password.data(),
+                input.password.size(),
+                input.salt.data(),
+                input.salt.size(),
+                input.c,
+                dks[i].data(),
+                input.dkLen
+            });
+        }
+        variant.second(jobs.data(), jobs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            const auto& input = inputs[i];
+            EXPECT_EQ(
+                variant.first(input.password, input.salt, input.c, input.dkLen, nullptr),
+                dks[i]
+            ) << i;
+        }
+    }
+}
+
+TEST(Pbkdf2Tests, Pbkdf2CalibrateFitsIterationsToBudget) {
+    const std::chrono::milliseconds budget(5);
+    const std::vector< Hash::Pbkdf2Calibration > calibrations{
+        Hash::Pbkdf2Calibrate(
+            Hash::MakeHmacBytesToBytesFunction(
+                Hash::Sha256,
+                Hash::SHA256_BLOCK_SIZE
+            ),
+            Hash::SHA256_DIGEST_LENGTH,
+            budget
+        ),
+        Hash::Pbkdf2HmacCalibrate< Hash::Sha1Context >(budget),
+        Hash::Pbkdf2HmacCalibrate< Hash::Sha256Context >(budget),
+        Hash::Pbkdf2HmacCalibrate< Hash::Sha512Context >(budget),
+        Hash::Pbkdf2HmacCalibrate< Hash::Sha384Context >(budget),
+    };
+    const auto budgetNanoseconds = (double)std::chrono::nanoseconds(budget).count();
+    for (const auto& calibration: calibrations) {
+        EXPECT_GT(calibration.nanosecondsPerIteration, 0.0);
+        EXPECT_GE(calibration.c, 1);
+        EXPECT_LE(
+            (double)calibration.c * calibration.nanosecondsPerIteration,
+            budgetNanoseconds
+        );
+        EXPECT_GT(
+            (double)(calibration.c + 1) * calibration.nanosecondsPerIteration,
+            budgetNanoseconds
+        );
+    }
+}
+
+TEST(Pbkdf2Tests, Pbkdf2CalibrateGivesOneIterationForTinyBudget) {
+    const auto calibration = Hash::Pbkdf2HmacCalibrate< Hash::Sha512Context >(std::chrono::nanoseconds(1));
+    EXPECT_EQ(1, calibration.c);
+    EXPECT_GT(calibration.nanosecondsPerIteration, 1.0);
+}
+
+TEST(Pbkdf2Tests, Pbkdf2HmacTemplateMatchesPbkdf2) {
+    struct Variant {
+        std::vector< uint8_t > (*pbkdf2Hmac)(
+            const std::vector< uint8_t >&,
+            const std::vector< uint8_t >&,
+            size_t,
+            size_t,
+            Hash::Pbkdf2Executor
+        );
+        Hash::HashFunction hashFunction;
+        size_t blockSize;
+        size_t hLen;
+    };
+    const std::vector< Variant > variants{
+        {Hash::Pbkdf2Hmac< Hash::Md5Context >, Hash::Md5, Hash::MD5_BLOCK_SIZE, Hash::MD5_DIGEST_LENGTH},
+        {Hash::Pbkdf2Hmac< Hash::Sha1Context >, Hash::Sha1, Hash::SHA1_BLOCK_SIZE, Hash::SHA1_DIGEST_LENGTH},
+        {Hash::Pbkdf2Hmac< Hash::Sha224Context >, Hash::Sha224, Hash::SHA224_BLOCK_SIZE, Hash::SHA224_DIGEST_LENGTH},
+        {Hash::Pbkdf2Hmac< Hash::Sha256Context >, Hash::Sha256, Hash::SHA256_BLOCK_SIZE, Hash::SHA256_DIGEST_LENGTH},
+        {Hash::Pbkdf2Hmac< Hash::Sha384Context >, Hash::Sha384, Hash::SHA512_BLOCK_SIZE, Hash::SHA384_DIGEST_LENGTH},
+        {Hash::Pbkdf2Hmac< Hash::Sha512Context >, Hash::Sha512, Hash::SHA512_BLOCK_SIZE, Hash::SHA512_DIGEST_LENGTH},
+        {Hash::Pbkdf2Hmac< Hash::Sha512t256Context >, Hash::Sha512t256, Hash::SHA512_BLOCK_SIZE, Hash::SHA512T256_DIGEST_LENGTH},
+    };
+    const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+    const std::vector< uint8_t > longPassword(200, 'p');
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    const auto reverseExecutor = [](
+        size_t count,
+        std::function< void(size_t index) > task
+    ) {
+        for (size_t index = count; index > 0; --index) {
+            task(index - 1);
+        }
+    };
+    for (const auto& variant: variants) {
+        const auto prf = MakeGeneralHmac(variant.hashFunction, variant.blockSize);
+        for (const auto c: {1, 2, 10}) {
+            for (const auto dkLen: {1, 20, 100}) {
+                EXPECT_EQ(
+                    Hash::Pbkdf2(prf, variant.hLen, password, salt, c, dkLen),
+                    variant.pbkdf2Hmac(password, salt, c, dkLen, nullptr)
+                );
+                EXPECT_EQ(
+                    Hash::Pbkdf2(prf, variant.hLen, longPassword, salt, c, dkLen),
+                    variant.pbkdf2Hmac(longPassword, salt, c, dkLen, nullptr)
+                );
+                EXPECT_EQ(
+                    Hash::Pbkdf2(prf, variant.hLen, password, salt, c, dkLen),
+                    variant.pbkdf2Hmac(password, salt, c, dkLen, reverseExecutor)
+                );
+            }
+        }
+    }
+}
+
+TEST(Pbkdf2Tests, LibraryHmacPrfSkipsKeyCache) {
+    struct Variant {
+        Hash::HashFunction hashFunction;
+        size_t blockSize;
+        size_t hLen;
+    };
+    const std::vector< Variant > variants{
+        {Hash::Md5, Hash::MD5_BLOCK_SIZE, Hash::MD5_DIGEST_LENGTH},
+        {Hash::Sha1, Hash::SHA1_BLOCK_SIZE, Hash::SHA1_DIGEST_LENGTH},
+        {Hash::Sha224, Hash::SHA224_BLOCK_SIZE, Hash::SHA224_DIGEST_LENGTH},
+        {Hash::Sha256, Hash::SHA256_BLOCK_SIZE, Hash::SHA256_DIGEST_LENGTH},
+        {Hash::Sha384, Hash::SHA512_BLOCK_SIZE, Hash::SHA384_DIGEST_LENGTH},
+        {Hash::Sha512, Hash::SHA512_BLOCK_SIZE, Hash::SHA512_DIGEST_LENGTH},
+        {Hash::Sha512t224, Hash::SHA512_BLOCK_SIZE, Hash::SHA512T224_DIGEST_LENGTH},
+        {Hash::Sha512t256, Hash::SHA512_BLOCK_SIZE, Hash::SHA512T256_DIGEST_LENGTH},
+    };
+    const std::vector< uint8_t > password{'p', 'a', 's', 's', 'w', 'o', 'r', 'd'};
+    const std::vector< uint8_t > longPassword(200, 'p');
+    const std::vector< uint8_t > salt{'s', 'a', 'l', 't'};
+    for (const auto& variant: variants) {
+        const auto generalPrf = MakeGeneralHmac(variant.hashFunction, variant.blockSize);
+        const auto libraryPrf = Hash::MakeHmacBytesToBytesFunction(variant.hashFunction, variant.blockSize);
+        for (const auto& p: {password, longPassword}) {
+            for (const size_t c: {0, 1, 10}) {
+                const auto expected = Hash::Pbkdf2(generalPrf, variant.hLen, p, salt, c, 100);
+                const auto before = Hash::GetHmacKeyCacheStatistics();
+                EXPECT_EQ(expected, Hash::Pbkdf2(libraryPrf, variant.hLen, p, salt, c, 100));
+                EXPECT_EQ(
+                    expected,
+                    Hash::Pbkdf2Parallel(libraryPrf, variant.hLen, p, salt, c, 100, Hash::Pbkdf2ThreadExecutor)
+                );
+                const auto after = Hash::GetHmacKeyCacheStatistics();
+                EXPECT_EQ(before.hits, after.hits) << variant.hLen << ", " << c;
+                EXPECT_EQ(before.misses, after.misses) << variant.hLen << ", " << c;
+            }
+        }
+    }
+}
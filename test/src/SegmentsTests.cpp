@@ -0,0 +1,107 @@
+/**
+ * @file SegmentsTests.cpp
+ *
+ * This module contains the unit tests of the functions which compute
+ * message digests and HMAC codes of messages split into segments.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <Hash/Hmac.hpp>
+#include <Hash/Md5.hpp>
+#include <Hash/Segments.hpp>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * This function splits the given message into segments of the given
+     * lengths, repeating the lengths as needed, with the last segment
+     * holding whatever is left.
+     *
+     * @param[in] message
+     *     This is the message to split.
+     *
+     * @param[in] lengths
+     *     These are the lengths of the segments to make.
+     *
+     * @return
+     *     The segments of the message are returned.
+     */
+    std::vector< Hash::HashSegment > Split(
+        const std::vector< uint8_t >& message,
+        const std::vector< size_t >& lengths
+    ) {
+        std::vector< Hash::HashSegment > segments;
+        size_t offset = 0;
+        for (size_t i = 0; offset < message.size(); ++i) {
+            const auto length = std::min(lengths[i % lengths.size()], message.size() - offset);
+            segments.push_back({message.data() + offset, length});
+            offset += length;
+        }
+        return segments;
+    }
+
+}
+
+TEST(SegmentsTests, DigestOfSegmentsMatchesWholeMessage) {
+    std::vector< uint8_t > message(1000);
+    for (size_t i = 0; i < message.size(); ++i) {
+        message[i] = (uint8_t)(i * 7);
+    }
+    const std::vector< std::vector< size_t > > splits{
+        {1000},
+        {1},
+        {0, 3, 0, 61, 64, 200},
+        {127, 129},
+    };
+    for (const auto& lengths: splits) {
+        const auto segments = Split(message, lengths);
+        EXPECT_EQ(Hash::Md5(message), Hash::ComputeDigestOfSegments< Hash::Md5Context >(segments));
+        EXPECT_EQ(Hash::Sha1(message), Hash::ComputeDigestOfSegments< Hash::Sha1Context >(segments));
+        EXPECT_EQ(Hash::Sha256(message), Hash::ComputeDigestOfSegments< Hash::Sha256Context >(segments));
+        EXPECT_EQ(Hash::Sha512(message), Hash::ComputeDigestOfSegments< Hash::Sha512Context >(segments));
+    }
+}
+
+TEST(SegmentsTests, EmptyMessage) {
+    const std::vector< Hash::HashSegment > segments{{nullptr, 0}};
+    EXPECT_EQ(Hash::Sha256({}), Hash::ComputeDigestOfSegments< Hash::Sha256Context >(segments));
+    EXPECT_EQ(
+        Hash::Sha256({}),
+        Hash::ComputeDigestOfSegments< Hash::Sha256Context >(std::vector< Hash::HashSegment >())
+    );
+}
+
+TEST(SegmentsTests, HmacOfSegmentsMatchesWholeMessage) {
+    const auto hmacSha256 = Hash::MakeHmacBytesToBytesFunction(Hash::Sha256, Hash::SHA256_BLOCK_SIZE);
+    const auto hmacSha384 = Hash::MakeHmacBytesToBytesFunction(Hash::Sha384, Hash::SHA512_BLOCK_SIZE);
+    const std::vector< uint8_t > header{'P', 'O', 'S', 'T', ' ', '/', '\n'};
+    const std::vector< uint8_t > body(3000, 'b');
+    std::vector< uint8_t > message;
+    message.reserve(header.size() + body.size());
+    message.insert(message.end(), header.begin(), header.end());
+    message.insert(message.end(), body.begin(), body.end());
+    const std::vector< Hash::HashSegment > segments{
+        {header.data(), header.size()},
+        {body.data(), 1000},
+        {body.data() + 1000, 2000},
+    };
+    for (const auto keyLength: {0, 16, 200}) {
+        const std::vector< uint8_t > key(keyLength, 'k');
+        EXPECT_EQ(
+            hmacSha256(key, message),
+            Hash::ComputeHmacOfSegments< Hash::Sha256Context >(key, segments)
+        );
+        EXPECT_EQ(
+            hmacSha384(key, message),
+            Hash::ComputeHmacOfSegments< Hash::Sha384Context >(key, segments)
+        );
+    }
+}
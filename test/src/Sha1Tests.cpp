@@ -9,9 +9,11 @@
 #include <gtest/gtest.h>
 #include <Hash/Templates.hpp>
 #include <Hash/Sha1.hpp>
+#include <src/Sha1Kernels.hpp>
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <string.h>
 #include <sstream>
 #include <vector>
 
@@ -62,3 +64,50 @@ TEST(Sha1Tests, HashToByteVector) {
         Hash::StringToBytes< Hash::Sha1 >("abc")
     );
 }
+
+TEST(Sha1Tests, ContextMatchesOneShotFunctionForAnyPieceSizes) {
+    std::vector< uint8_t > message(1000);
+    for (size_t i = 0; i < message.size(); ++i) {
+        message[i] = (uint8_t)(i * 7 + 3);
+    }
+    Hash::Sha1Context context;
+    for (size_t pieceSize: {1, 3, 55, 56, 64, 100, 1000}) {
+        for (size_t offset = 0; offset < message.size(); offset += pieceSize) {
+            context.Update(
+                message.data() + offset,
+                std::min(pieceSize, message.size() - offset)
+            );
+        }
+        EXPECT_EQ(Hash::Sha1(message), context.Final()) << "Piece size: " << pieceSize;
+    }
+}
+
+TEST(Sha1Tests, KernelsAgree) {
+    std::vector< uint8_t > blocks(64 * 5);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = (uint8_t)(i * 131 + 17);
+    }
+    uint32_t expected[5] = {
+        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0
+    };
+    uint32_t actual[5];
+    (void)memcpy(actual, expected, sizeof(actual));
+    Hash::Internal::Sha1CompressScalar(expected, blocks.data(), 5);
+#if HASH_TARGET_X86
+    const auto& features = Hash::Internal::GetCpuFeatures();
+    if (features.sha && features.ssse3 && features.sse41) {
+        Hash::Internal::Sha1CompressShaNi(actual, blocks.data(), 5);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(expected)));
+    }
+#endif
+}
+
+TEST(Sha1Tests, FixedSizeDigestMatchesVectorFunction) {
+    const std::string input = "The quick brown fox jumps over the lazy dog";
+    const std::vector< uint8_t > data(input.begin(), input.end());
+    const auto digest = Hash::ComputeSha1(input.data(), input.length());
+    EXPECT_EQ(Hash::Sha1(data), std::vector< uint8_t >(digest.begin(), digest.end()));
+    uint8_t buffer[Hash::SHA1_DIGEST_LENGTH / 8];
+    Hash::ComputeSha1(input.data(), input.length(), buffer);
+    EXPECT_EQ(0, memcmp(digest.data(), buffer, sizeof(buffer)));
+}
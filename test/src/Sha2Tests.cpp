@@ -9,9 +9,12 @@
 #include <gtest/gtest.h>
 #include <Hash/Templates.hpp>
 #include <Hash/Sha2.hpp>
+#include <src/MultiBuffer.hpp>
+#include <src/Sha2Kernels.hpp>
 #include <stddef.h>
 #include <stdint.h>
 #include <string>
+#include <string.h>
 #include <sstream>
 #include <vector>
 
@@ -156,3 +159,379 @@ TEST(Sha2Tests, Sha256HashToByteVector) {
         Hash::StringToBytes< Hash::Sha256 >("")
     );
 }
+
+TEST(Sha2Tests, ContextsMatchOneShotFunctionsForAnyPieceSizes) {
+    std::vector< uint8_t > message(1000);
+    for (size_t i = 0; i < message.size(); ++i) {
+        message[i] = (uint8_t)(i * 7 + 3);
+    }
+    Hash::Sha224Context sha224;
+    Hash::Sha256Context sha256;
+    Hash::Sha384Context sha384;
+    Hash::Sha512Context sha512;
+    Hash::Sha512t224Context sha512t224;
+    Hash::Sha512t256Context sha512t256;
+    for (size_t pieceSize: {1, 3, 55, 56, 64, 100, 127, 128, 129, 1000}) {
+        for (size_t offset = 0; offset < message.size(); offset += pieceSize) {
+            const auto length = std::min(pieceSize, message.size() - offset);
+            sha224.Update(message.data() + offset, length);
+            sha256.Update(message.data() + offset, length);
+            sha384.Update(message.data() + offset, length);
+            sha512.Update(message.data() + offset, length);
+            sha512t224.Update(message.data() + offset, length);
+            sha512t256.Update(message.data() + offset, length);
+        }
+        EXPECT_EQ(Hash::Sha224(message), sha224.Final()) << "Piece size: " << pieceSize;
+        EXPECT_EQ(Hash::Sha256(message), sha256.Final()) << "Piece size: " << pieceSize;
+        EXPECT_EQ(Hash::Sha384(message), sha384.Final()) << "Piece size: " << pieceSize;
+        EXPECT_EQ(Hash::Sha512(message), sha512.Final()) << "Piece size: " << pieceSize;
+        EXPECT_EQ(Hash::Sha512t224(message), sha512t224.Final()) << "Piece size: " << pieceSize;
+        EXPECT_EQ(Hash::Sha512t256(message), sha512t256.Final()) << "Piece size: " << pieceSize;
+    }
+}
+
+TEST(Sha2Tests, Sha256ContextMillionAs) {
+    // This is the "one million a's" test vector from Sha256TestVectors,
+    // given to the context in pieces rather than all at once.
+    Hash::Sha256Context context;
+    const std::vector< uint8_t > piece(1000, 'a');
+    for (size_t i = 0; i < 1000; ++i) {
+        context.Update(piece);
+    }
+    EXPECT_EQ(
+        Hash::StringToBytes< Hash::Sha256 >(std::string(1000000, 'a')),
+        context.Final()
+    );
+}
+
+TEST(Sha2Tests, ContextResetsAfterFinal) {
+    Hash::Sha512Context context;
+    context.Update("abc", 3);
+    (void)context.Final();
+    EXPECT_EQ(
+        Hash::StringToBytes< Hash::Sha512 >(""),
+        context.Final()
+    );
+}
+
+TEST(Sha2Tests, Sha256KernelsAgree) {
+    std::vector< uint8_t > blocks(64 * 5);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = (uint8_t)(i * 131 + 17);
+    }
+    uint32_t expected[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    uint32_t actual[8];
+    (void)memcpy(actual, expected, sizeof(actual));
+    Hash::Internal::Sha256CompressScalar(expected, blocks.data(), 5);
+#if HASH_TARGET_X86
+    const auto& features = Hash::Internal::GetCpuFeatures();
+    if (features.sha && features.ssse3 && features.sse41) {
+        Hash::Internal::Sha256CompressShaNi(actual, blocks.data(), 5);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(expected)));
+    }
+    if (features.avx2 && features.bmi2) {
+        // The AVX2 kernel works on pairs of blocks, so check both an even
+        // and an odd number of blocks.
+        for (size_t numBlocks = 4; numBlocks <= 5; ++numBlocks) {
+            uint32_t scalar[8] = {
+                0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+            };
+            (void)memcpy(actual, scalar, sizeof(actual));
+            Hash::Internal::Sha256CompressScalar(scalar, blocks.data(), numBlocks);
+            Hash::Internal::Sha256CompressAvx2(actual, blocks.data(), numBlocks);
+            EXPECT_EQ(0, memcmp(scalar, actual, sizeof(scalar))) << numBlocks << " blocks";
+        }
+    }
+#endif
+}
+
+TEST(Sha2Tests, Sha512KernelsAgree) {
+    std::vector< uint8_t > blocks(128 * 3);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        blocks[i] = (uint8_t)(i * 131 + 17);
+    }
+    uint64_t expected[8] = {
+        0x6a09e667f3bcc908, 0xbb67ae8584caa73b,
+        0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+        0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+        0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+    };
+    uint64_t actual[8];
+    (void)memcpy(actual, expected, sizeof(actual));
+    Hash::Internal::Sha512CompressScalar(expected, blocks.data(), 3);
+#if HASH_TARGET_X86
+    const auto& features = Hash::Internal::GetCpuFeatures();
+    if (features.avx2 && features.bmi2) {
+        Hash::Internal::Sha512CompressAvx2(actual, blocks.data(), 3);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(expected)));
+    }
+#endif
+}
+
+TEST(Sha2Tests, Sha256BatchTestVectors) {
+    // These are the same test vectors as Sha256TestVectors, repeated so
+    // that each one passes through every lane of a multi-buffer kernel,
+    // mixed with messages of every length up to a few blocks so that
+    // lanes finish and are refilled at different times.
+    struct TestVector {
+        std::string input;
+        std::string output;
+    };
+    const std::vector< TestVector > testVectors{
+        {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"The quick brown fox jumps over the lazy dog", "d7a8fbb307d7809469ca9abcb0082e4f8d5651e46d3cdb762d02d0bf37c9e592"},
+        {std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+    };
+    std::vector< std::vector< uint8_t > > messages;
+    std::vector< std::vector< uint8_t > > expectedDigests;
+    for (size_t i = 0; i < 17; ++i) {
+        for (const auto& testVector: testVectors) {
+            messages.emplace_back(testVector.input.begin(), testVector.input.end());
+            expectedDigests.push_back(
+                Hash::StringToBytes< Hash::Sha256 >(testVector.input)
+            );
+            EXPECT_EQ(
+                testVector.output,
+                Hash::StringToString< Hash::Sha256 >(testVector.input)
+            );
+        }
+    }
+    for (size_t length = 0; length < 200; ++length) {
+        std::vector< uint8_t > message(length);
+        for (size_t i = 0; i < length; ++i) {
+            message[i] = (uint8_t)(i + length);
+        }
+        expectedDigests.push_back(Hash::Sha256(message));
+        messages.push_back(std::move(message));
+    }
+    const auto digests = Hash::Sha256Batch(messages);
+    ASSERT_EQ(messages.size() * 32, digests.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(
+            expectedDigests[i],
+            std::vector< uint8_t >(
+                digests.begin() + i * 32,
+                digests.begin() + (i + 1) * 32
+            )
+        ) << "Message #" << i;
+    }
+}
+
+TEST(Sha2Tests, Sha256MultiBufferKernelInLanes) {
+    // The batch function only uses the multi-buffer kernel on CPUs
+    // without the SHA extensions, so drive it directly here.
+#if HASH_TARGET_X86
+    if (!Hash::Internal::GetCpuFeatures().avx2) {
+        return;
+    }
+    const uint32_t initialHashValues[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+    std::vector< std::vector< uint8_t > > messages;
+    std::vector< const uint8_t* > pointers;
+    std::vector< size_t > lengths;
+    for (size_t length = 0; length < 300; length += 7) {
+        std::vector< uint8_t > message(length);
+        for (size_t i = 0; i < length; ++i) {
+            message[i] = (uint8_t)(i * length);
+        }
+        messages.push_back(std::move(message));
+    }
+    for (const auto& message: messages) {
+        pointers.push_back(message.data());
+        lengths.push_back(message.size());
+    }
+    std::vector< uint8_t > digests(messages.size() * 32);
+    Hash::Internal::HashInLanes< uint32_t, 8, 8, 64, 8, true >(
+        pointers.data(),
+        lengths.data(),
+        messages.size(),
+        initialHashValues,
+        digests.data(),
+        32,
+        Hash::Internal::Sha256CompressAvx2x8
+    );
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(
+            Hash::Sha256(messages[i]),
+            std::vector< uint8_t >(
+                digests.begin() + i * 32,
+                digests.begin() + (i + 1) * 32
+            )
+        ) << "Message #" << i;
+    }
+#endif
+}
+
+TEST(Sha2Tests, Sha512FamilyBatchesMatchOneShotFunctions) {
+    std::vector< std::vector< uint8_t > > messages;
+    for (size_t length = 0; length < 600; length += 13) {
+        std::vector< uint8_t > message(length);
+        for (size_t i = 0; i < length; ++i) {
+            message[i] = (uint8_t)(i * length + 1);
+        }
+        messages.push_back(std::move(message));
+    }
+    struct Variant {
+        std::vector< uint8_t > (*batch)(const std::vector< std::vector< uint8_t > >&);
+        std::vector< uint8_t > (*hash)(const std::vector< uint8_t >&);
+        size_t digestSize;
+    };
+    const Variant variants[] = {
+        {Hash::Sha384Batch, Hash::Sha384, 48},
+        {Hash::Sha512Batch, Hash::Sha512, 64},
+        {Hash::Sha512t224Batch, Hash::Sha512t224, 28},
+        {Hash::Sha512t256Batch, Hash::Sha512t256, 32},
+    };
+    for (const auto& variant: variants) {
+        const auto digests = variant.batch(messages);
+        ASSERT_EQ(messages.size() * variant.digestSize, digests.size());
+        for (size_t i = 0; i < messages.size(); ++i) {
+            EXPECT_EQ(
+                variant.hash(messages[i]),
+                std::vector< uint8_t >(
+                    digests.begin() + i * variant.digestSize,
+                    digests.begin() + (i + 1) * variant.digestSize
+                )
+            ) << "Digest size " << variant.digestSize << ", message #" << i;
+        }
+    }
+}
+
+TEST(Sha2Tests, Sha512MultiBufferKernelsInLanes) {
+    // The batch functions only use the fastest multi-buffer kernel the CPU
+    // supports, so drive each kernel directly here.
+#if HASH_TARGET_X86
+    const uint64_t initialHashValues[8] = {
+        0x6a09e667f3bcc908, 0xbb67ae8584caa73b,
+        0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+        0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+        0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+    };
+    std::vector< std::vector< uint8_t > > messages;
+    std::vector< const uint8_t* > pointers;
+    std::vector< size_t > lengths;
+    for (size_t length = 0; length < 600; length += 11) {
+        std::vector< uint8_t > message(length);
+        for (size_t i = 0; i < length; ++i) {
+            message[i] = (uint8_t)(i * length);
+        }
+        messages.push_back(std::move(message));
+    }
+    for (const auto& message: messages) {
+        pointers.push_back(message.data());
+        lengths.push_back(message.size());
+    }
+    const auto& features = Hash::Internal::GetCpuFeatures();
+    for (size_t kernel = 0; kernel < 2; ++kernel) {
+        std::vector< uint8_t > digests(messages.size() * 64);
+        if (kernel == 0) {
+            if (!features.avx2) {
+                continue;
+            }
+            Hash::Internal::HashInLanes< uint64_t, 8, 4, 128, 16, true >(
+                pointers.data(),
+                lengths.data(),
+                messages.size(),
+                initialHashValues,
+                digests.data(),
+                64,
+                Hash::Internal::Sha512CompressAvx2x4
+            );
+        } else {
+            if (!features.avx512) {
+                continue;
+            }
+            Hash::Internal::HashInLanes< uint64_t, 8, 8, 128, 16, true >(
+                pointers.data(),
+                lengths.data(),
+                messages.size(),
+                initialHashValues,
+                digests.data(),
+                64,
+                Hash::Internal::Sha512CompressAvx512x8
+            );
+        }
+        for (size_t i = 0; i < messages.size(); ++i) {
+            EXPECT_EQ(
+                Hash::Sha512(messages[i]),
+                std::vector< uint8_t >(
+                    digests.begin() + i * 64,
+                    digests.begin() + (i + 1) * 64
+                )
+            ) << "Kernel #" << kernel << ", message #" << i;
+        }
+    }
+#endif
+}
+
+TEST(Sha2Tests, FixedSizeDigestsMatchVectorFunctions) {
+    const std::string input = "The quick brown fox jumps over the lazy dog";
+    const std::vector< uint8_t > data(input.begin(), input.end());
+    const auto sha224 = Hash::ComputeSha224(input.data(), input.length());
+    EXPECT_EQ(Hash::Sha224(data), std::vector< uint8_t >(sha224.begin(), sha224.end()));
+    const auto sha256 = Hash::ComputeSha256(input.data(), input.length());
+    EXPECT_EQ(Hash::Sha256(data), std::vector< uint8_t >(sha256.begin(), sha256.end()));
+    const auto sha384 = Hash::ComputeSha384(input.data(), input.length());
+    EXPECT_EQ(Hash::Sha384(data), std::vector< uint8_t >(sha384.begin(), sha384.end()));
+    const auto sha512 = Hash::ComputeSha512(input.data(), input.length());
+    EXPECT_EQ(Hash::Sha512(data), std::vector< uint8_t >(sha512.begin(), sha512.end()));
+    const auto sha512t224 = Hash::ComputeSha512t224(input.data(), input.length());
+    EXPECT_EQ(Hash::Sha512t224(data), std::vector< uint8_t >(sha512t224.begin(), sha512t224.end()));
+    const auto sha512t256 = Hash::ComputeSha512t256(input.data(), input.length());
+    EXPECT_EQ(Hash::Sha512t256(data), std::vector< uint8_t >(sha512t256.begin(), sha512t256.end()));
+    uint8_t buffer[Hash::SHA256_DIGEST_LENGTH / 8 + 1];
+    buffer[sizeof(buffer) - 1] = 0xAA;
+    Hash::Sha256Context context;
+    context.Update(input.data(), input.length());
+    context.Final(buffer);
+    EXPECT_EQ(0, memcmp(sha256.data(), buffer, sha256.size()));
+    EXPECT_EQ(0xAA, buffer[sizeof(buffer) - 1]);
+}
+
+namespace {
+
+    /**
+     * This is a hash function with no pointer and length form, used to
+     * test the general form of the string hashing function templates.
+     *
+     * @param[in] data
+     *     This is the data for which to compute the message digest.
+     *
+     * @return
+     *     The SHA-256 message digest of the given data is returned
+     *     as a vector of bytes.
+     */
+    std::vector< uint8_t > WrappedSha256(const std::vector< uint8_t >& data) {
+        return Hash::Sha256(data);
+    }
+
+}
+
+TEST(Sha2Tests, StringHashingInPlaceMatchesGeneralForm) {
+    const std::string input(1000, 'x');
+    EXPECT_EQ(
+        Hash::StringToString< WrappedSha256 >(input),
+        Hash::StringToString< Hash::Sha256 >(input)
+    );
+    EXPECT_EQ(
+        Hash::StringToBytes< WrappedSha256 >(input),
+        Hash::StringToBytes< Hash::Sha256 >(input)
+    );
+#if HASH_HAS_STRING_VIEW
+    const std::string_view view(input.data() + 10, 500);
+    EXPECT_EQ(
+        Hash::StringToString< Hash::Sha512 >(std::string(view)),
+        Hash::StringViewToString< Hash::Sha512 >(view)
+    );
+    EXPECT_EQ(
+        Hash::StringToBytes< Hash::Sha512t256 >(std::string(view)),
+        Hash::StringViewToBytes< Hash::Sha512t256 >(view)
+    );
+#endif
+}
@@ -0,0 +1,171 @@
+/**
+ * @file TotpTableTests.cpp
+ *
+ * This module contains the unit tests of the Hash::TotpTable class
+ * template.
+ *
+ * © 2019 by Richard Walters
+ */
+
+#include <chrono>
+#include <gtest/gtest.h>
+#include <Hash/Sha1.hpp>
+#include <Hash/Sha2.hpp>
+#include <Hash/Totp.hpp>
+#include <Hash/TotpTable.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * These are the shared secrets used in the tests.
+     */
+    const std::vector< std::string > secrets{
+        "12345678901234567890",
+        "abcdefghijklmnopqrst",
+        "a",
+        "",
+    };
+
+    /**
+     * This function returns the current UNIX time.
+     *
+     * @return
+     *     The current UNIX time is returned.
+     */
+    uint64_t Now() {
+        return (uint64_t)std::chrono::duration_cast< std::chrono::seconds >(
+            std::chrono::system_clock::now().time_since_epoch()
+        ).count();
+    }
+
+}
+
+TEST(TotpTableTests, RefreshedPasswordsMatchTotp) {
+    Hash::TotpSha1Table table(secrets, 0, 30, 8);
+    EXPECT_EQ(secrets.size(), table.Size());
+    const uint64_t time = 1111111109;
+    table.Refresh(time);
+    for (size_t i = 0; i < secrets.size(); ++i) {
+        for (const auto t: {time, time + 30}) {
+            EXPECT_EQ(
+                Hash::Totp(Hash::Sha1, Hash::SHA1_BLOCK_SIZE, secrets[i], t, 0, 30, 8),
+                table.Lookup(i, t)
+            ) << i << " " << t;
+        }
+    }
+    EXPECT_EQ(7081804, table.Lookup(0, time));
+}
+
+TEST(TotpTableTests, LookupOutsideTableComputesPassword) {
+    Hash::TotpSha256Table table(secrets, 0, 30, 6);
+    table.Refresh(1111111109);
+    for (size_t i = 0; i < secrets.size(); ++i) {
+        const std::vector< uint64_t > times{0, 59, 1111111109 + 120, 1111111109 - 120, 20000000000};
+        for (const auto t: times) {
+            int password;
+            EXPECT_FALSE(table.TryLookup(i, t, password));
+            EXPECT_EQ(
+                Hash::Totp(Hash::Sha256, Hash::SHA256_BLOCK_SIZE, secrets[i], t, 0, 30, 6),
+                table.Lookup(i, t)
+            ) << i << " " << t;
+        }
+    }
+}
+
+TEST(TotpTableTests, IndexOutOfRangeFails) {
+    Hash::TotpSha1Table table(secrets, 0, 30, 6);
+    const uint64_t time = 1111111109;
+    table.Refresh(time);
+    int password = 123456;
+    EXPECT_TRUE(table.TryLookup(secrets.size() - 1, time, password));
+    EXPECT_NE(-1, table.Lookup(secrets.size() - 1, time));
+    EXPECT_FALSE(table.TryLookup(secrets.size(), time, password));
+    EXPECT_FALSE(table.TryLookup((size_t)-1, time, password));
+    EXPECT_EQ(-1, table.Lookup(secrets.size(), time));
+    EXPECT_EQ(-1, table.Lookup((size_t)-1, time));
+    Hash::TotpSha1Table empty({}, 0, 30, 6);
+    empty.Refresh(time);
+    EXPECT_FALSE(empty.TryLookup(0, time, password));
+    EXPECT_EQ(-1, empty.Lookup(0, time));
+}
+
+TEST(TotpTableTests, AdvanceFollowsTimeSteps) {
+    Hash::TotpSha1Table table(secrets, 0, 30, 6);
+    const auto expectPasswords = [&](uint64_t step, bool present) {
+        for (size_t i = 0; i < secrets.size(); ++i) {
+            int password;
+            ASSERT_EQ(present, table.TryLookup(i, step * 30, password)) << i << " " << step;
+            if (present) {
+                EXPECT_EQ(
+                    Hash::Totp(Hash::Sha1, Hash::SHA1_BLOCK_SIZE, secrets[i], step * 30, 0, 30, 6),
+                    password
+                ) << i << " " << step;
+            }
+        }
+    };
+
+    // The first time, the previous, current, and next steps are computed,
+    // and the next wake is the lead time before the next step begins.
+    EXPECT_EQ(101 * 30 - 2, table.Advance(100 * 30 + 5, 2));
+    expectPasswords(98, false);
+    expectPasswords(99, true);
+    expectPasswords(100, true);
+    expectPasswords(101, true);
+    expectPasswords(102, false);
+
+    // Waking early changes nothing.
+    EXPECT_EQ(101 * 30 - 2, table.Advance(100 * 30 + 10, 2));
+    expectPasswords(102, false);
+
+    // Within the lead time of the next step, the step after it is computed.
+    EXPECT_EQ(102 * 30 - 2, table.Advance(101 * 30 - 2, 2));
+    expectPasswords(101, true);
+    expectPasswords(102, true);
+    EXPECT_EQ(102 * 30 - 2, table.Advance(101 * 30 - 1, 2));
+    EXPECT_EQ(103 * 30 - 2, table.Advance(102 * 30 - 2, 2));
+    expectPasswords(103, true);
+
+    // A lead of a whole step or more is limited to one second less.
+    EXPECT_EQ(103 * 30 - 29, table.Advance(102 * 30 - 1, 100));
+}
+
+TEST(TotpTableTests, AdvanceRecomputesAfterClockJump) {
+    Hash::TotpSha256Table table(secrets, 0, 30, 8);
+    (void)table.Advance(1000 * 30 + 1);
+    for (const uint64_t step: {5000, 40}) {
+        (void)table.Advance(step * 30 + 1);
+        for (size_t i = 0; i < secrets.size(); ++i) {
+            for (uint64_t u = step - 1; u <= step + 1; ++u) {
+                int password;
+                ASSERT_TRUE(table.TryLookup(i, u * 30, password)) << i << " " << u;
+                EXPECT_EQ(
+                    Hash::Totp(Hash::Sha256, Hash::SHA256_BLOCK_SIZE, secrets[i], u * 30, 0, 30, 8),
+                    password
+                ) << i << " " << u;
+            }
+        }
+    }
+}
+
+TEST(TotpTableTests, StartFillsTableBeforeReturning) {
+    Hash::TotpSha512Table table(secrets, 0, 30, 6);
+    table.Start();
+    table.Start();
+    const auto time = Now();
+    for (size_t i = 0; i < secrets.size(); ++i) {
+        int password;
+        EXPECT_TRUE(table.TryLookup(i, time + 30, password)) << i;
+        EXPECT_EQ(
+            Hash::Totp(Hash::Sha512, Hash::SHA512_BLOCK_SIZE, secrets[i], time + 30, 0, 30, 6),
+            password
+        ) << i;
+    }
+    table.Stop();
+    table.Stop();
+    int password;
+    EXPECT_TRUE(table.TryLookup(0, time, password));
+}